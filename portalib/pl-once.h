@@ -0,0 +1,47 @@
+/** \file
+ *
+ *  \brief One-time initialisation.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of Portalib.
+ *
+ *  Portalib is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  See COPYING.LGPL and COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  pl_once() calls an initialisation function exactly once, however many
+ *  threads call it.  With POSIX threads, this is pthread_once().  Without,
+ *  there is only one thread, so a flag is enough.
+ *
+ *  Usage:
+ *
+ *      static pl_once_t init_once = PL_ONCE_INIT;
+ *      pl_once(&init_once, init);
+ */
+
+#ifndef PORTALIB_PL_ONCE_H_
+#define PORTALIB_PL_ONCE_H_
+
+#ifdef HAVE_PTHREADS
+
+#include <pthread.h>
+
+typedef pthread_once_t pl_once_t;
+#define PL_ONCE_INIT PTHREAD_ONCE_INIT
+#define pl_once(o, f) ((void)pthread_once((o), (f)))
+
+#else
+
+typedef _Bool pl_once_t;
+#define PL_ONCE_INIT (0)
+#define pl_once(o, f) do { if (!*(o)) { (f)(); *(o) = 1; } } while (0)
+
+#endif
+
+#endif
@@ -2,7 +2,7 @@
  *
  *  \brief Audio output modules & interfaces.
  *
- *  \copyright Copyright 2003-2016 Ciaran Anscomb
+ *  \copyright Copyright 2003-2024 Ciaran Anscomb
  *
  *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
  *
@@ -18,10 +18,29 @@
 
 #include "top-config.h"
 
+// The audio ring needs atomic access to its indices: C11 atomics where
+// available, otherwise the equivalent GCC builtins.  Without either, the ring
+// is disabled, and modules that need it fail to initialise.
+#if !defined(__STDC_NO_ATOMICS__)
+#define AO_RING
+#include <stdatomic.h>
+#elif defined(__GNUC__)
+#define AO_RING
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "c-strcase.h"
+#include "pl-endian.h"
+#include "xalloc.h"
 
-#include "module.h"
 #include "ao.h"
+#include "host_clock.h"
+#include "logging.h"
+#include "module.h"
 
 extern struct module ao_macosx_module;
 extern struct module ao_sun_module;
@@ -32,6 +51,7 @@ extern struct module ao_sdl_module;
 extern struct module ao_alsa_module;
 extern struct module ao_jack_module;
 extern struct module ao_null_module;
+extern struct module ao_file_module;
 
 static struct module * const default_ao_module_list[] = {
 #ifdef HAVE_MACOSX_AUDIO
@@ -67,3 +87,336 @@ static struct module * const default_ao_module_list[] = {
 };
 
 struct module * const *ao_module_list = default_ao_module_list;
+
+// The file module writes to a named file, so it is never tried as a fallback
+// and is left out of the default list.  It is used only when selected by name.
+
+static struct module * const file_ao_module_list[] = {
+	&ao_file_module,
+	NULL
+};
+
+struct module *ao_module_select_by_arg(struct module * const *list, const char *name) {
+	if (name && strcmp(name, ao_file_module.name) == 0)
+		return &ao_file_module;
+	if (name && c_strcasecmp(name, "help") == 0) {
+		if (list && list[0])
+			module_print_list(list);
+		module_print_list(file_ao_module_list);
+		exit(EXIT_SUCCESS);
+	}
+	return module_select_by_arg(list, name);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Pacing and audio ring
+
+#define AO_RING_MAX_CHANNELS (2)
+
+// Maximum deviation from 1:1 introduced by rate control.  0.5% is well below
+// the threshold at which a pitch change would be audible.
+#define DRC_MAX_DEVIATION (0.005f)
+
+// Weight given to each new measurement of the fill level.  The level seen by
+// the producer jumps about by a buffer or device period, so is smoothed.
+#define DRC_SMOOTHING (1.0f / 16.0f)
+
+// If emulation falls this far behind the system clock, don't try to catch up
+#define PACE_RESYNC_US (1000000)
+
+void ao_clock_reset(struct ao_clock *clock) {
+	clock->valid = 0;
+}
+
+void ao_clock_wait(struct ao_clock *clock, unsigned rate, unsigned nframes) {
+	uint64_t now = host_clock_us();
+	if (!clock->valid) {
+		clock->valid = 1;
+		clock->base_us = now;
+		clock->nframes = 0;
+	}
+	clock->nframes += nframes;
+	uint64_t due = clock->base_us + (clock->nframes * 1000000) / rate;
+	if (now > due + PACE_RESYNC_US) {
+		clock->valid = 0;
+		return;
+	}
+#ifndef HAVE_WASM
+	// WebAssembly build is paced by the browser
+	if (due > now + 1000) {
+		host_clock_sleep_us(due - now);
+	}
+#endif
+}
+
+#ifdef AO_RING
+
+// Ring indices are shared between the emulator thread and an audio callback
+
+#ifndef __STDC_NO_ATOMICS__
+typedef atomic_uint ring_uint;
+typedef atomic_bool ring_bool;
+#define RING_INIT(p, v) atomic_init((p), (v))
+#define RING_LOAD(p) atomic_load_explicit((p), memory_order_acquire)
+#define RING_LOAD_RELAXED(p) atomic_load_explicit((p), memory_order_relaxed)
+#define RING_STORE(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#define RING_EXCHANGE(p, v) atomic_exchange((p), (v))
+#else
+typedef unsigned ring_uint;
+typedef _Bool ring_bool;
+#define RING_INIT(p, v) (*(p) = (v))
+#define RING_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RING_EXCHANGE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#endif
+
+struct ao_ring {
+	unsigned nchannels;
+	unsigned rate;
+	unsigned target;
+	unsigned capacity;  // frames, power of 2
+	float *data;
+
+	// Ring indices, in frames.  Only the producer advances 'head', and
+	// only the consumer advances 'tail'.
+	ring_uint head;
+	ring_uint tail;
+
+	// Set by the consumer when it runs dry; the producer then refills to
+	// the target and restarts its clock.
+	ring_bool underrun;
+
+	// Producer state
+	struct {
+		float last[AO_RING_MAX_CHANNELS];
+		float phase;
+		float fill;
+		struct ao_clock clock;
+	} producer;
+
+	// Consumer state
+	struct {
+		float last[AO_RING_MAX_CHANNELS];
+	} consumer;
+};
+
+struct ao_ring *ao_ring_new(unsigned nchannels, unsigned rate, unsigned target_nframes) {
+	if (nchannels < 1 || nchannels > AO_RING_MAX_CHANNELS || rate == 0)
+		return NULL;
+	if (target_nframes < 1)
+		target_nframes = 1;
+
+	struct ao_ring *ring = xmalloc(sizeof(*ring));
+	*ring = (struct ao_ring){0};
+	ring->nchannels = nchannels;
+	ring->rate = rate;
+	ring->target = target_nframes;
+
+	// Room for twice the target, plus the maximum the producer can be
+	// ahead by after refilling from an underrun
+	unsigned capacity = 256;
+	while (capacity < target_nframes * 4)
+		capacity <<= 1;
+	ring->capacity = capacity;
+	ring->data = xmalloc(capacity * nchannels * sizeof(float));
+	memset(ring->data, 0, capacity * nchannels * sizeof(float));
+
+	RING_INIT(&ring->head, 0);
+	RING_INIT(&ring->tail, 0);
+	RING_INIT(&ring->underrun, 1);
+
+	LOG_DEBUG(1, "\tring target %u frames (%.1fms), capacity %u frames\n", target_nframes, (float)(target_nframes * 1000) / rate, capacity);
+	return ring;
+}
+
+void ao_ring_free(struct ao_ring *ring) {
+	if (!ring)
+		return;
+	free(ring->data);
+	free(ring);
+}
+
+void ao_ring_write(struct ao_ring *ring, float const *buf, unsigned nframes, _Bool ratelimit) {
+	if (!ratelimit) {
+		ao_clock_reset(&ring->producer.clock);
+		return;
+	}
+
+	unsigned nchannels = ring->nchannels;
+	unsigned mask = ring->capacity - 1;
+	float *data = ring->data;
+	float *last = ring->producer.last;
+
+	unsigned head = RING_LOAD_RELAXED(&ring->head);
+	unsigned fill = head - RING_LOAD(&ring->tail);
+
+	// After an underrun (including at startup), top up to the target with
+	// copies of the last frame and restart the clock, rather than leaving
+	// rate control to slowly make up the difference.
+	if (RING_EXCHANGE(&ring->underrun, 0)) {
+		for (; fill < ring->target; fill++, head++) {
+			float *out = data + (head & mask) * nchannels;
+			for (unsigned c = 0; c < nchannels; c++)
+				out[c] = last[c];
+		}
+		ring->producer.fill = ring->target;
+		ao_clock_reset(&ring->producer.clock);
+	}
+
+	ao_clock_wait(&ring->producer.clock, ring->rate, nframes);
+
+	// Measure again after waiting
+	fill = head - RING_LOAD(&ring->tail);
+	unsigned space = ring->capacity - fill;
+
+	// Rate control.  Step through the input slightly faster when the ring
+	// is fuller than the target, slightly slower when it's emptier.
+	ring->producer.fill += ((float)fill - ring->producer.fill) * DRC_SMOOTHING;
+	float error = (ring->producer.fill - ring->target) / ring->target;
+	if (error > 1.0f)
+		error = 1.0f;
+	else if (error < -1.0f)
+		error = -1.0f;
+	float step = 1.0f + DRC_MAX_DEVIATION * error;
+
+	// Linear interpolation between the last frame and each new one
+	float phase = ring->producer.phase;
+	for (unsigned i = 0; i < nframes; i++, buf += nchannels) {
+		for (; phase < 1.0f; phase += step) {
+			if (space == 0)
+				continue;
+			float *out = data + (head & mask) * nchannels;
+			for (unsigned c = 0; c < nchannels; c++)
+				out[c] = last[c] + (buf[c] - last[c]) * phase;
+			head++;
+			space--;
+		}
+		phase -= 1.0f;
+		for (unsigned c = 0; c < nchannels; c++)
+			last[c] = buf[c];
+	}
+	ring->producer.phase = phase;
+
+	RING_STORE(&ring->head, head);
+}
+
+// Convert a run of samples, returning the next output position
+
+static void *convert_samples(void *dst, enum sound_fmt fmt, float const *src, unsigned nsamples) {
+	switch (fmt) {
+	case SOUND_FMT_U8: {
+		uint8_t *out = dst;
+		for (unsigned i = 0; i < nsamples; i++)
+			*(out++) = sound_clip(src[i]) * 0x7f + 0x80;
+		return out;
+	}
+	case SOUND_FMT_S8: {
+		int8_t *out = dst;
+		for (unsigned i = 0; i < nsamples; i++)
+			*(out++) = sound_clip(src[i]) * 0x7f;
+		return out;
+	}
+#if __BYTE_ORDER == __BIG_ENDIAN
+	case SOUND_FMT_S16_BE:
+#else
+	case SOUND_FMT_S16_LE:
+#endif
+	case SOUND_FMT_S16_HE: {
+		int16_t *out = dst;
+		for (unsigned i = 0; i < nsamples; i++)
+			*(out++) = sound_clip(src[i]) * 0x7fff;
+		return out;
+	}
+#if __BYTE_ORDER == __BIG_ENDIAN
+	case SOUND_FMT_S16_LE:
+#else
+	case SOUND_FMT_S16_BE:
+#endif
+	case SOUND_FMT_S16_SE: {
+		uint8_t *out = dst;
+		for (unsigned i = 0; i < nsamples; i++) {
+			int16_t v = sound_clip(src[i]) * 0x7fff;
+			*(out++) = *((uint8_t *)&v+1);
+			*(out++) = *(uint8_t *)&v;
+		}
+		return out;
+	}
+	case SOUND_FMT_FLOAT: {
+		float *out = dst;
+		memcpy(out, src, nsamples * sizeof(float));
+		return out + nsamples;
+	}
+	default:
+		break;
+	}
+	return dst;
+}
+
+unsigned ao_ring_read(struct ao_ring *ring, void *dst, enum sound_fmt fmt, unsigned nframes) {
+	unsigned nchannels = ring->nchannels;
+	unsigned mask = ring->capacity - 1;
+	float *last = ring->consumer.last;
+
+	unsigned tail = RING_LOAD_RELAXED(&ring->tail);
+	unsigned avail = RING_LOAD(&ring->head) - tail;
+	unsigned n = (avail < nframes) ? avail : nframes;
+
+	// Up to two runs, as the data may wrap
+	unsigned ntaken = 0;
+	while (ntaken < n) {
+		unsigned offset = (tail + ntaken) & mask;
+		unsigned count = ring->capacity - offset;
+		if (count > n - ntaken)
+			count = n - ntaken;
+		float const *src = ring->data + offset * nchannels;
+		dst = convert_samples(dst, fmt, src, count * nchannels);
+		ntaken += count;
+		src += (count - 1) * nchannels;
+		for (unsigned c = 0; c < nchannels; c++)
+			last[c] = src[c];
+	}
+	RING_STORE(&ring->tail, tail + n);
+
+	if (n < nframes) {
+		// Ran dry: hold the last frame
+		for (unsigned i = n; i < nframes; i++)
+			dst = convert_samples(dst, fmt, last, nchannels);
+		RING_STORE(&ring->underrun, 1);
+	}
+	return n;
+}
+
+#else
+
+// No atomic operations: the ring is unavailable
+
+struct ao_ring *ao_ring_new(unsigned nchannels, unsigned rate, unsigned target_nframes) {
+	(void)nchannels;
+	(void)rate;
+	(void)target_nframes;
+	LOG_WARN("Audio ring not supported in this build\n");
+	return NULL;
+}
+
+void ao_ring_free(struct ao_ring *ring) {
+	(void)ring;
+}
+
+void ao_ring_write(struct ao_ring *ring, float const *buf, unsigned nframes, _Bool ratelimit) {
+	(void)ring;
+	(void)buf;
+	(void)nframes;
+	(void)ratelimit;
+}
+
+unsigned ao_ring_read(struct ao_ring *ring, void *dst, enum sound_fmt fmt, unsigned nframes) {
+	(void)ring;
+	(void)dst;
+	(void)fmt;
+	(void)nframes;
+	return 0;
+}
+
+#endif
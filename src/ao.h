@@ -2,7 +2,7 @@
  *
  *  \brief Audio output modules & interfaces.
  *
- *  \copyright Copyright 2003-2016 Ciaran Anscomb
+ *  \copyright Copyright 2003-2024 Ciaran Anscomb
  *
  *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
  *
@@ -14,6 +14,16 @@
  *  See COPYING.GPL for redistribution conditions.
  *
  *  \endlicenseblock
+ *
+ *  Audio modules whose device pulls data from its own thread can use the ring
+ *  buffer provided here instead of blocking the emulation.  The sound
+ *  interface writes mixed float frames into the ring, and the device callback
+ *  (or a writer thread) reads them out in its own format.
+ *
+ *  The emulation is paced against the system clock rather than the device,
+ *  and the small difference between the two clocks is absorbed by
+ *  resampling: the producer stretches or squeezes each buffer very slightly
+ *  to keep the ring's fill level centred on a target.
  */
 
 #ifndef XROAR_AO_H_
@@ -22,6 +32,7 @@
 #include <stdint.h>
 
 #include "delegate.h"
+#include "sound.h"
 
 struct module;
 struct sound_interface;
@@ -33,4 +44,47 @@ struct ao_interface {
 
 extern struct module * const *ao_module_list;
 
+// As module_select_by_arg(), but also recognises the file module, which is
+// not in the module list.
+
+struct module *ao_module_select_by_arg(struct module * const *list, const char *name);
+
+// Pace output against the system clock.  ao_clock_wait() sleeps until
+// 'nframes' more frames at 'rate' are due since the clock was (re)started.
+// If output falls far behind, the clock restarts rather than trying to catch
+// up.
+
+struct ao_clock {
+	_Bool valid;
+	uint64_t base_us;
+	uint64_t nframes;
+};
+
+void ao_clock_reset(struct ao_clock *clock);
+void ao_clock_wait(struct ao_clock *clock, unsigned rate, unsigned nframes);
+
+// Single-producer, single-consumer audio ring
+
+struct ao_ring;
+
+// 'target_nframes' is the fill level to aim for, and so sets the latency.  It
+// should exceed the producer's buffer size plus the consumer's period.
+// Returns NULL if the build has no atomic operations to implement the ring.
+
+struct ao_ring *ao_ring_new(unsigned nchannels, unsigned rate, unsigned target_nframes);
+void ao_ring_free(struct ao_ring *ring);
+
+// Producer: queue interleaved float frames.  If 'ratelimit' is set, first
+// waits until they are due according to the system clock.  If not, nothing is
+// queued.
+
+void ao_ring_write(struct ao_ring *ring, float const *buf, unsigned nframes, _Bool ratelimit);
+
+// Consumer: fill 'dst' with 'nframes' frames converted to 'fmt'.  Never
+// blocks, so is safe to call from a real-time callback.  If the ring runs
+// dry, the last frame is repeated.  Returns the number of frames actually
+// taken from the ring.
+
+unsigned ao_ring_read(struct ao_ring *ring, void *dst, enum sound_fmt fmt, unsigned nframes);
+
 #endif
@@ -24,6 +24,7 @@
 
 #include "top-config.h"
 
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -445,6 +446,110 @@ void ay891x_cycle(struct AY891X *psg, _Bool BDIR, _Bool BC1, uint8_t *D) {
 	update_reg(psg_, psg_->address);
 }
 
+// Noise generator.  Called each time the noise counter expires.
+
+static void noise_step(struct AY891X_ *psg_) {
+	// 17-bit LFSR.  According to [deathsoft], shift in bit is bits 16 and
+	// 13 XORed, ORed with what looks like a parity calculation.  Including
+	// the parity gives it way too short a period, so I've omitted it here,
+	// and the result seems...  noisy.
+	unsigned shift_in = ((psg_->noise_lfsr ^ (psg_->noise_lfsr >> 3)) & 1) << 16;
+	psg_->noise_lfsr = shift_in | (psg_->noise_lfsr >> 1);
+	psg_->noise_state = psg_->noise_lfsr & 1;
+}
+
+// Envelope generator.  Called each time the envelope counter expires.
+
+static void envelope_step(struct AY891X_ *psg_) {
+	if (psg_->envelope_att) {
+		if (psg_->envelope_level == 15) {
+			if (psg_->envelope_cont) {
+				if (psg_->envelope_hold) {
+					if (psg_->envelope_alt) {
+						psg_->envelope_level = 0;
+						psg_->envelope_att = 0;
+					} else {
+						psg_->envelope_level = 15;
+					}
+				} else {
+					if (psg_->envelope_alt) {
+						psg_->envelope_att = 0;
+					} else {
+						psg_->envelope_level = 0;
+					}
+				}
+			}
+		} else {
+			psg_->envelope_level++;
+		}
+	} else {
+		if (psg_->envelope_level == 0) {
+			if (psg_->envelope_cont) {
+				if (psg_->envelope_hold) {
+					if (psg_->envelope_alt) {
+						psg_->envelope_level = 15;
+						psg_->envelope_att = 1;
+					} else {
+						psg_->envelope_level = 0;
+					}
+				} else {
+					if (psg_->envelope_alt) {
+						psg_->envelope_att = 1;
+					} else {
+						psg_->envelope_level = 15;
+					}
+				}
+			} else {
+				psg_->envelope_level = 0;
+			}
+		} else {
+			psg_->envelope_level--;
+		}
+	}
+}
+
+// Mix tone with noise for each channel and return the summed output level.
+
+static float mix_channels(struct AY891X_ *psg_) {
+	for (int c = 0; c < 3; c++) {
+		_Bool state = (psg_->tone_enable[c] && psg_->tone_state[c]) ||
+		              (psg_->noise_state && psg_->noise_enable[c]);
+		if (psg_->envelope_mode[c]) {
+			unsigned level = state ? psg_->envelope_level : 0;
+			psg_->level[c] = amplitude[level];
+		} else {
+			psg_->level[c] = psg_->amplitude[c][state];
+		}
+	}
+	return psg_->level[0] + psg_->level[1] + psg_->level[2];
+}
+
+// Number of ticks until a counter expires.  Noise and envelope counters
+// expire when decremented to zero or below.
+
+static unsigned ticks_to_expiry(int counter) {
+	return (counter > 1) ? (unsigned)counter : 1;
+}
+
+// Advance a counter by a number of ticks, reloading it from 'period' each
+// time it expires.  Returns the number of expiries.
+
+static unsigned advance_counter(int *counter, int period, unsigned nticks) {
+	unsigned first = ticks_to_expiry(*counter);
+	if (nticks < first) {
+		*counter -= nticks;
+		return 0;
+	}
+	nticks -= first;
+	unsigned p = (period > 1) ? (unsigned)period : 1;
+	*counter = period - (int)(nticks % p);
+	return 1 + nticks / p;
+}
+
+// Maximum number of ticks filtered at once when processing a block
+
+#define BLOCK_NTICKS (256)
+
 float ay891x_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 	struct AY891X_ *psg_ = sptr;
 
@@ -463,8 +568,97 @@ float ay891x_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 		psg_->overrun = 0;
 	}
 
+	// Only counters that can affect the output limit the length of a
+	// block.  The rest are advanced in bulk.  Register writes happen
+	// between calls, so this holds for the whole call.
+	_Bool tone_relevant[3];
+	for (int c = 0; c < 3; c++) {
+		tone_relevant[c] = psg_->tone_enable[c];
+	}
+	_Bool noise_relevant = psg_->noise_enable[0] || psg_->noise_enable[1] || psg_->noise_enable[2];
+	_Bool envelope_relevant = psg_->envelope_mode[0] || psg_->envelope_mode[1] || psg_->envelope_mode[2];
+
 	while (nticks > 0) {
 
+		// Ticks until the next relevant counter expiry.  Output is
+		// constant until then, so all the ticks up to it can be
+		// processed as a block.  Tone counters only expire on reaching
+		// exactly zero.
+		unsigned run = UINT_MAX;
+		for (int c = 0; c < 3; c++) {
+			if (tone_relevant[c] && psg_->tone_counter[c] >= 1 && (unsigned)psg_->tone_counter[c] < run)
+				run = psg_->tone_counter[c];
+		}
+		if (noise_relevant && ticks_to_expiry(psg_->noise_counter) < run)
+			run = ticks_to_expiry(psg_->noise_counter);
+		if (envelope_relevant && ticks_to_expiry(psg_->envelope_counter) < run)
+			run = ticks_to_expiry(psg_->envelope_counter);
+
+		if (run > 1) {
+			// Limit to the ticks remaining in this call.  Equivalent to
+			// the per-tick accounting below.
+			int64_t need = (int64_t)nticks * psg_->refrate - psg_->tickerror;
+			int64_t nleft = (need + psg_->tickrate - 1) / psg_->tickrate;
+			unsigned nidle = run - 1;
+			if (nleft < 1)
+				nleft = 1;
+			if (nleft < nidle)
+				nidle = nleft;
+
+			int64_t tickerror = psg_->tickerror + (int64_t)nidle * psg_->tickrate;
+			nticks -= tickerror / psg_->refrate;
+			psg_->tickerror = tickerror % psg_->refrate;
+
+			unsigned n = advance_counter(&psg_->noise_counter, psg_->noise_period, nidle);
+			for (; n; n--) {
+				noise_step(psg_);
+			}
+			for (int c = 0; c < 3; c++) {
+				if (psg_->tone_counter[c] >= 1) {
+					n = advance_counter(&psg_->tone_counter[c], psg_->tone_period[c], nidle);
+					psg_->tone_state[c] ^= (n & 1);
+				} else {
+					psg_->tone_counter[c] -= nidle;
+				}
+			}
+			n = advance_counter(&psg_->envelope_counter, psg_->envelope_period, nidle);
+			for (; n; n--) {
+				envelope_step(psg_);
+			}
+
+			new_output = mix_channels(psg_);
+
+			// Filter the block, then pick out output samples where they
+			// fall.  Each is the filter output from before the tick it
+			// falls on.
+			while (nidle > 0) {
+				float tick_output[BLOCK_NTICKS];
+				unsigned nblock = (nidle < BLOCK_NTICKS) ? nidle : BLOCK_NTICKS;
+				float prev_output = output;
+				output = filter_iir_apply_n(psg_->filter, new_output, nblock, tick_output);
+				for (unsigned i = 0; i < nblock; i++) {
+					psg_->frameerror += psg_->framerate;
+					if (psg_->frameerror >= psg_->refrate) {
+						psg_->frameerror -= psg_->refrate;
+						if (nframes > 0) {
+							if (buf) {
+								*(buf++) = i ? tick_output[i-1] : prev_output;
+							}
+							nframes--;
+						} else {
+							psg_->overrun = 1;
+						}
+					}
+				}
+				nidle -= nblock;
+			}
+
+			if (nticks <= 0)
+				break;
+		}
+
+		// Single tick in which at least one relevant counter expires
+
 		// framerate will *always* be less than refrate, so this is a
 		// simple test.  allow for 1 overrun sample.
 		psg_->frameerror += psg_->framerate;
@@ -492,14 +686,7 @@ float ay891x_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 		psg_->noise_counter--;
 		if (psg_->noise_counter <= 0) {
 			psg_->noise_counter = psg_->noise_period;
-			// 17-bit LFSR.  According to [deathsoft], shift in bit
-			// is bits 16 and 13 XORed, ORed with what looks like a
-			// parity calculation.  Including the parity gives it
-			// way too short a period, so I've omitted it here, and
-			// the result seems...  noisy.
-			unsigned shift_in = ((psg_->noise_lfsr ^ (psg_->noise_lfsr >> 3)) & 1) << 16;
-			psg_->noise_lfsr = shift_in | (psg_->noise_lfsr >> 1);
-			psg_->noise_state = psg_->noise_lfsr & 1;
+			noise_step(psg_);
 		}
 
 		// tone generators A, B, C
@@ -508,71 +695,18 @@ float ay891x_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 				psg_->tone_counter[c] = psg_->tone_period[c];
 				psg_->tone_state[c] = !psg_->tone_state[c];
 			}
-			// mix tone with noise
-			_Bool state = (psg_->tone_enable[c] && psg_->tone_state[c]) ||
-			              (psg_->noise_state && psg_->noise_enable[c]);
-			if (psg_->envelope_mode[c]) {
-				unsigned level = state ? psg_->envelope_level : 0;
-				psg_->level[c] = amplitude[level];
-			} else {
-				psg_->level[c] = psg_->amplitude[c][state];
-			}
 		}
 
+		// mix and sum the output channels
+		new_output = mix_channels(psg_);
+
 		// envelope
 		psg_->envelope_counter--;
 		if (psg_->envelope_counter <= 0) {
 			psg_->envelope_counter = psg_->envelope_period;
-			if (psg_->envelope_att) {
-				if (psg_->envelope_level == 15) {
-					if (psg_->envelope_cont) {
-						if (psg_->envelope_hold) {
-							if (psg_->envelope_alt) {
-								psg_->envelope_level = 0;
-								psg_->envelope_att = 0;
-							} else {
-								psg_->envelope_level = 15;
-							}
-						} else {
-							if (psg_->envelope_alt) {
-								psg_->envelope_att = 0;
-							} else {
-								psg_->envelope_level = 0;
-							}
-						}
-					}
-				} else {
-					psg_->envelope_level++;
-				}
-			} else {
-				if (psg_->envelope_level == 0) {
-					if (psg_->envelope_cont) {
-						if (psg_->envelope_hold) {
-							if (psg_->envelope_alt) {
-								psg_->envelope_level = 15;
-								psg_->envelope_att = 1;
-							} else {
-								psg_->envelope_level = 0;
-							}
-						} else {
-							if (psg_->envelope_alt) {
-								psg_->envelope_att = 1;
-							} else {
-								psg_->envelope_level = 15;
-							}
-						}
-					} else {
-						psg_->envelope_level = 0;
-					}
-				} else {
-					psg_->envelope_level--;
-				}
-			}
+			envelope_step(psg_);
 		}
 
-		// sum the output channels
-		new_output = psg_->level[0] + psg_->level[1] + psg_->level[2];
-
 		output = filter_iir_apply(psg_->filter, new_output);
 	}
 
@@ -0,0 +1,400 @@
+/** \file
+ *
+ *  \brief Video and audio capture.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  The emulation thread only copies data into a bounded queue: frames as
+ *  24-bit RGB (the renderer knows its own pixel format), audio as floats.  A
+ *  writer thread drains the queue, converts video to Y'CbCr 4:4:4 and audio
+ *  to 16-bit PCM, and does all file I/O.
+ *
+ *  Nothing is ever dropped.  If the writer falls behind by more than the
+ *  queue holds, the emulation thread waits for it.
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_PTHREADS
+#define CAPTURE_THREAD
+#include <pthread.h>
+#endif
+
+#include "xalloc.h"
+
+#include "capture.h"
+#include "fs.h"
+#include "logging.h"
+#include "sound.h"
+#include "vo_render.h"
+#include "wav.h"
+
+// Queue length.  Mixed video and audio; about half a second at typical
+// fragment sizes.
+#define NSLOTS (32)
+
+enum capture_item_type {
+	CAPTURE_ITEM_VIDEO,
+	CAPTURE_ITEM_AUDIO,
+};
+
+struct capture_item {
+	enum capture_item_type type;
+
+	// Video
+	unsigned w, h;
+	_Bool is_60hz;
+
+	// Audio
+	unsigned nframes;
+	unsigned nchannels;
+	unsigned rate;
+
+	// Slot buffers are kept between uses, growing as necessary
+	size_t alloc;
+	void *data;
+};
+
+struct capture {
+	struct {
+		FILE *f;
+		_Bool header_written;
+		unsigned w, h;
+		uint8_t *planes;  // Y', Cb, Cr
+		unsigned nframes;
+	} video;
+
+	struct {
+		FILE *f;
+		_Bool header_written;
+		_Bool format_warned;
+		struct wav_header wav;
+		uint32_t nbytes;
+		uint8_t *pcm;
+		size_t pcm_alloc;
+	} audio;
+
+	// Protected by mutex when threaded
+	unsigned head;
+	unsigned tail;
+	_Bool quit;
+
+	// Number of times the emulation thread had to wait for the writer
+	unsigned nstalls;
+
+#ifdef CAPTURE_THREAD
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cv;
+	pthread_cond_t space_cv;
+#endif
+
+	struct capture_item items[NSLOTS];
+};
+
+static void process_item(struct capture *cap, struct capture_item *item);
+static void finish_audio(struct capture *cap);
+
+#ifdef CAPTURE_THREAD
+static void *writer_main(void *sptr);
+#endif
+
+static FILE *open_output(const char *filename) {
+	FILE *f = fs_open_output(filename);
+	if (!f) {
+		LOG_WARN("capture: can't open '%s' for writing\n", filename);
+	}
+	return f;
+}
+
+struct capture *capture_new(const char *video_filename, const char *audio_filename) {
+	FILE *vf = video_filename ? open_output(video_filename) : NULL;
+	FILE *af = audio_filename ? open_output(audio_filename) : NULL;
+	if (!vf && !af)
+		return NULL;
+
+	struct capture *cap = xmalloc(sizeof(*cap));
+	*cap = (struct capture){0};
+	cap->video.f = vf;
+	cap->audio.f = af;
+
+#ifdef CAPTURE_THREAD
+	pthread_mutex_init(&cap->mutex, NULL);
+	pthread_cond_init(&cap->work_cv, NULL);
+	pthread_cond_init(&cap->space_cv, NULL);
+	if (pthread_create(&cap->thread, NULL, writer_main, cap) != 0) {
+		LOG_WARN("capture: failed to create writer thread\n");
+		pthread_cond_destroy(&cap->space_cv);
+		pthread_cond_destroy(&cap->work_cv);
+		pthread_mutex_destroy(&cap->mutex);
+		if (vf)
+			fs_close_output(vf);
+		if (af)
+			fs_close_output(af);
+		free(cap);
+		return NULL;
+	}
+#endif
+
+	if (vf)
+		LOG_DEBUG(1, "Capturing video to '%s'\n", video_filename);
+	if (af)
+		LOG_DEBUG(1, "Capturing audio to '%s'\n", audio_filename);
+	return cap;
+}
+
+void capture_free(struct capture *cap) {
+	if (!cap)
+		return;
+
+#ifdef CAPTURE_THREAD
+	pthread_mutex_lock(&cap->mutex);
+	cap->quit = 1;
+	pthread_cond_signal(&cap->work_cv);
+	pthread_mutex_unlock(&cap->mutex);
+	pthread_join(cap->thread, NULL);
+	pthread_cond_destroy(&cap->space_cv);
+	pthread_cond_destroy(&cap->work_cv);
+	pthread_mutex_destroy(&cap->mutex);
+#endif
+
+	if (cap->video.f) {
+		fs_close_output(cap->video.f);
+		LOG_DEBUG(1, "capture: %u video frames written\n", cap->video.nframes);
+	}
+	if (cap->audio.f) {
+		finish_audio(cap);
+		fs_close_output(cap->audio.f);
+	}
+	if (cap->nstalls) {
+		LOG_DEBUG(1, "capture: emulation waited for writer %u times\n", cap->nstalls);
+	}
+
+	for (unsigned i = 0; i < NSLOTS; i++) {
+		free(cap->items[i].data);
+	}
+	free(cap->video.planes);
+	free(cap->audio.pcm);
+	free(cap);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Queue handling.  The emulation thread owns the slot at 'head' between
+// get_slot() and commit_slot().
+
+static struct capture_item *get_slot(struct capture *cap, size_t size) {
+#ifdef CAPTURE_THREAD
+	pthread_mutex_lock(&cap->mutex);
+	if ((cap->head - cap->tail) >= NSLOTS) {
+		cap->nstalls++;
+		while ((cap->head - cap->tail) >= NSLOTS) {
+			pthread_cond_wait(&cap->space_cv, &cap->mutex);
+		}
+	}
+	pthread_mutex_unlock(&cap->mutex);
+#endif
+	struct capture_item *item = &cap->items[cap->head % NSLOTS];
+	if (item->alloc < size) {
+		item->data = xrealloc(item->data, size);
+		item->alloc = size;
+	}
+	return item;
+}
+
+static void commit_slot(struct capture *cap) {
+#ifdef CAPTURE_THREAD
+	pthread_mutex_lock(&cap->mutex);
+	cap->head++;
+	pthread_cond_signal(&cap->work_cv);
+	pthread_mutex_unlock(&cap->mutex);
+#else
+	process_item(cap, &cap->items[cap->head % NSLOTS]);
+	cap->head++;
+	cap->tail++;
+#endif
+}
+
+#ifdef CAPTURE_THREAD
+
+static void *writer_main(void *sptr) {
+	struct capture *cap = sptr;
+	pthread_mutex_lock(&cap->mutex);
+	for (;;) {
+		while (cap->head == cap->tail && !cap->quit) {
+			pthread_cond_wait(&cap->work_cv, &cap->mutex);
+		}
+		if (cap->head == cap->tail)
+			break;
+		struct capture_item *item = &cap->items[cap->tail % NSLOTS];
+		pthread_mutex_unlock(&cap->mutex);
+		process_item(cap, item);
+		pthread_mutex_lock(&cap->mutex);
+		cap->tail++;
+		pthread_cond_signal(&cap->space_cv);
+	}
+	pthread_mutex_unlock(&cap->mutex);
+	return NULL;
+}
+
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Emulation thread side
+
+void capture_video_frame(struct capture *cap, struct vo_render *vr, _Bool is_60hz) {
+	if (!cap || !cap->video.f || !vr || !vr->buffer)
+		return;
+	unsigned w = vr->viewport.w;
+	unsigned h = vr->viewport.h;
+	struct capture_item *item = get_slot(cap, w * h * 3);
+	item->type = CAPTURE_ITEM_VIDEO;
+	item->w = w;
+	item->h = h;
+	item->is_60hz = is_60hz;
+	uint8_t *dest = item->data;
+	for (unsigned j = 0; j < h; j++) {
+		vr->line_to_rgb(vr, j, dest);
+		dest += w * 3;
+	}
+	commit_slot(cap);
+}
+
+void capture_audio(struct capture *cap, float const *buf, unsigned nframes,
+		   unsigned nchannels, unsigned rate) {
+	if (!cap || !cap->audio.f || !buf || nframes == 0)
+		return;
+	size_t nsamples = nframes * nchannels;
+	struct capture_item *item = get_slot(cap, nsamples * sizeof(float));
+	item->type = CAPTURE_ITEM_AUDIO;
+	item->nframes = nframes;
+	item->nchannels = nchannels;
+	item->rate = rate;
+	memcpy(item->data, buf, nsamples * sizeof(float));
+	commit_slot(cap);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Writer side
+
+// YUV4MPEG2, full 4:4:4 chroma, BT.601 studio range.  Dimensions, frame rate
+// and pixel aspect are fixed by the first frame.  Later frames of a different
+// size are cropped or padded with black.
+
+static void write_video(struct capture *cap, struct capture_item *item) {
+	if (!cap->video.header_written) {
+		cap->video.w = item->w;
+		cap->video.h = item->h;
+		cap->video.planes = xmalloc(item->w * item->h * 3);
+		// Emulated pixels are twice as tall as they are wide.  60Hz
+		// video is additionally scaled by 1.2 in the display modules.
+		fprintf(cap->video.f, "YUV4MPEG2 W%u H%u %s Ip %s C444\n",
+			cap->video.w, cap->video.h,
+			item->is_60hz ? "F60000:1001" : "F50:1",
+			item->is_60hz ? "A5:12" : "A1:2");
+		cap->video.header_written = 1;
+	}
+
+	unsigned w = cap->video.w;
+	unsigned h = cap->video.h;
+	unsigned plane_size = w * h;
+	uint8_t *py = cap->video.planes;
+	uint8_t *pcb = py + plane_size;
+	uint8_t *pcr = pcb + plane_size;
+	uint8_t const *src = item->data;
+
+	for (unsigned j = 0; j < h; j++) {
+		unsigned i = 0;
+		if (j < item->h) {
+			uint8_t const *s = src + j * item->w * 3;
+			for (; i < w && i < item->w; i++, s += 3) {
+				int R = s[0], G = s[1], B = s[2];
+				*(py++) = ((66*R + 129*G + 25*B + 128) >> 8) + 16;
+				*(pcb++) = ((-38*R - 74*G + 112*B + 128) >> 8) + 128;
+				*(pcr++) = ((112*R - 94*G - 18*B + 128) >> 8) + 128;
+			}
+		}
+		for (; i < w; i++) {
+			*(py++) = 16;
+			*(pcb++) = 128;
+			*(pcr++) = 128;
+		}
+	}
+
+	fputs("FRAME\n", cap->video.f);
+	fwrite(cap->video.planes, 1, plane_size * 3, cap->video.f);
+	cap->video.nframes++;
+}
+
+static void write_audio(struct capture *cap, struct capture_item *item) {
+	if (!cap->audio.header_written) {
+		cap->audio.wav = (struct wav_header){
+			.format = WAV_FORMAT_PCM,
+			.nchannels = item->nchannels,
+			.rate = item->rate,
+			.sample_nbytes = 2,
+		};
+		// Lengths are patched when finished, if the file can be rewound
+		wav_write_header(cap->audio.f, &cap->audio.wav, WAV_DATA_NBYTES_UNKNOWN);
+		cap->audio.header_written = 1;
+	}
+	if (item->nchannels != cap->audio.wav.nchannels || item->rate != cap->audio.wav.rate) {
+		if (!cap->audio.format_warned) {
+			LOG_WARN("capture: audio format changed: discarding\n");
+			cap->audio.format_warned = 1;
+		}
+		return;
+	}
+
+	size_t nsamples = item->nframes * item->nchannels;
+	if (cap->audio.pcm_alloc < nsamples * 2) {
+		cap->audio.pcm = xrealloc(cap->audio.pcm, nsamples * 2);
+		cap->audio.pcm_alloc = nsamples * 2;
+	}
+	float const *src = item->data;
+	uint8_t *dest = cap->audio.pcm;
+	for (size_t i = 0; i < nsamples; i++) {
+		int s = (int)(sound_clip(src[i]) * 0x7fff);
+		wav_put_le16(dest, (unsigned)s & 0xffff);
+		dest += 2;
+	}
+	fwrite(cap->audio.pcm, 1, nsamples * 2, cap->audio.f);
+	cap->audio.nbytes += nsamples * 2;
+}
+
+static void finish_audio(struct capture *cap) {
+	if (!cap->audio.header_written)
+		return;
+	wav_update_header(cap->audio.f, &cap->audio.wav, cap->audio.nbytes);
+}
+
+static void process_item(struct capture *cap, struct capture_item *item) {
+	switch (item->type) {
+	case CAPTURE_ITEM_VIDEO:
+		write_video(cap, item);
+		break;
+	case CAPTURE_ITEM_AUDIO:
+		write_audio(cap, item);
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,43 @@
+/** \file
+ *
+ *  \brief Video and audio capture.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Streams every rendered frame to a YUV4MPEG2 file and the mixed audio to a
+ *  WAV file.  Either filename may be "-" for standard output, or name a pipe.
+ */
+
+#ifndef XROAR_CAPTURE_H_
+#define XROAR_CAPTURE_H_
+
+struct capture;
+struct vo_render;
+
+// Open the output files and start the writer.  Either filename may be NULL.
+// Returns NULL if nothing could be opened.
+struct capture *capture_new(const char *video_filename, const char *audio_filename);
+
+// Flush everything queued, finish the files and close them.
+void capture_free(struct capture *cap);
+
+// Queue the completed frame in the renderer's buffer.  Called at vertical
+// sync.  'is_60hz' selects the frame rate written to the file header.
+void capture_video_frame(struct capture *cap, struct vo_render *vr, _Bool is_60hz);
+
+// Queue interleaved float audio, as mixed by the sound interface.
+void capture_audio(struct capture *cap, float const *buf, unsigned nframes,
+		   unsigned nchannels, unsigned rate);
+
+#endif
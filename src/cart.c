@@ -592,11 +592,11 @@ struct cart_config *cart_find_working_dos(struct machine_config *mc) {
 			cc = cart_config_by_name("delta");
 		}
 	} else {
-		if (xroar.cfg.becker.prefer && (tmp = romlist_find("@rsdos_becker"))) {
+		if (xroar_cfg.becker.prefer && (tmp = romlist_find("@rsdos_becker"))) {
 			cc = cart_config_by_name("becker");
 		} else if ((tmp = romlist_find("@rsdos"))) {
 			cc = cart_config_by_name("rsdos");
-		} else if (!xroar.cfg.becker.prefer && (tmp = romlist_find("@rsdos_becker"))) {
+		} else if (!xroar_cfg.becker.prefer && (tmp = romlist_find("@rsdos_becker"))) {
 			cc = cart_config_by_name("becker");
 		}
 	}
@@ -802,6 +802,7 @@ static struct part *cart_rom_allocate(void) {
 	*c = (struct cart){0};
 
 	cart_rom_init(c);
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
@@ -953,7 +954,7 @@ void cart_rom_detach(struct cart *c) {
 
 // Toggles the cartridge interrupt line.
 static void do_firq(void *data) {
-	static _Bool level = 0;
+	static VAR_ATTR_THREAD_LOCAL _Bool level = 0;
 	struct cart *c = data;
 	DELEGATE_SAFE_CALL(c->signal_firq, level);
 	c->firq_event.at_tick = event_current_tick + EVENT_MS(100);
@@ -78,6 +78,11 @@ struct cart {
 	// Cartridge asserts this to inhibit usual address decode by host.
 	_Bool EXTMEM;
 
+	// Set if the cartridge only cares about accesses to its IO (P2) or ROM
+	// (R2) areas and never asserts EXTMEM.  The host may then skip the
+	// every-cycle read & write calls for other addresses.
+	_Bool decode_p2r2_only;
+
 	// Ways for the cartridge to signal interrupt events to the host.
 	DELEGATE_T1(void, bool) signal_firq;
 	DELEGATE_T1(void, bool) signal_nmi;
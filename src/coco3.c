@@ -139,12 +139,10 @@ struct machine_coco3 {
 	struct ram *RAM;
 
 	struct vo_interface *vo;
-	int frame;  // track frameskip
 	struct sound_interface *snd;
 
 	_Bool inverted_text;
 	struct cart *cart;
-	unsigned frameskip;
 
 	int cycles;
 
@@ -175,6 +173,11 @@ struct machine_coco3 {
 		uint32_t vram_bank;
 	} dat;
 
+	// Host pointers to each 8K block of (non-DAT) RAM as addressed by the
+	// GIME's Z output, or NULL if that block isn't directly accessible.
+	// Lets plain RAM cycles skip the full decode.
+	uint8_t *ram_block[64];
+
 	// Useful configuration side-effect tracking
 	_Bool has_secb;
 	uint32_t crc_secb;
@@ -290,7 +293,6 @@ static _Bool coco3_set_pause(struct machine *m, int state);
 static _Bool coco3_set_inverted_text(struct machine *m, int state);
 static void *coco3_get_interface(struct machine *m, const char *ifname);
 static void coco3_set_composite(struct machine *, _Bool);
-static void coco3_set_frameskip(struct machine *m, unsigned fskip);
 static void coco3_set_ratelimit(struct machine *m, _Bool ratelimit);
 
 static uint8_t coco3_read_byte(struct machine *m, unsigned A, uint8_t D);
@@ -319,6 +321,9 @@ static struct machine_bp coco3_print_breakpoint[] = {
 
 static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A);
 static void cpu_cycle_noclock(void *sptr, int ncycles, _Bool RnW, uint16_t A);
+static void update_ram_blocks(struct machine_coco3 *mcc3);
+static void coco3_idle_skip(struct machine_coco3 *mcc3, int ncycles);
+static unsigned coco3_nvma_cycles(void *sptr, int ncycles);
 static void coco3_instruction_posthook(void *sptr);
 static uint16_t fetch_vram(void *sptr, uint32_t A);
 
@@ -388,7 +393,6 @@ static struct part *coco3_allocate(void) {
 	m->set_inverted_text = coco3_set_inverted_text;
 	m->get_interface = coco3_get_interface;
 	m->set_composite = coco3_set_composite;
-	m->set_frameskip = coco3_set_frameskip;
 	m->set_ratelimit = coco3_set_ratelimit;
 
 	m->read_byte = coco3_read_byte;
@@ -514,7 +518,7 @@ static _Bool coco3_finish(struct part *p) {
 	// Report and check CRC (Super Extended Colour BASIC)
 	rombank_report(mcc3->ROM0, "Super Extended Colour BASIC");
 	mcc3->crc_secb = 0xb4c88d6c;  // Super Extended Colour BASIC (NTSC)
-	mcc3->has_secb = rombank_verify_crc(mcc3->ROM0, "Super Extended Colour BASIC", -1, "@coco3", xroar.cfg.force_crc_match, &mcc3->crc_secb);
+	mcc3->has_secb = rombank_verify_crc(mcc3->ROM0, "Super Extended Colour BASIC", -1, "@coco3", xroar_cfg.force_crc_match, &mcc3->crc_secb);
 
 	// RAM configuration
 	{
@@ -523,6 +527,7 @@ static _Bool coco3_finish(struct part *p) {
 		unsigned total_k = nbanks * bank_k;
 		LOG_DEBUG(1, "[ram] %u banks * %uK = %uK total RAM\n", nbanks, bank_k, total_k);
 	}
+	update_ram_blocks(mcc3);
 
 	// Connect any cartridge part
 	coco3_connect_cart(p);
@@ -598,6 +603,7 @@ static _Bool coco3_finish(struct part *p) {
 	// CPU
 
 	mcc3->CPU->mem_cycle = DELEGATE_AS2(void, bool, uint16, tcc1014_mem_cycle, mcc3->GIME);
+	mcc3->CPU->nvma_cycles = DELEGATE_AS1(unsigned, int, coco3_nvma_cycles, mcc3);
 	mcc3->GIME->CPUD = &mcc3->CPU->D;
 
 	// Breakpoint session
@@ -652,8 +658,8 @@ static _Bool coco3_finish(struct part *p) {
 
 #ifdef WANT_GDB_TARGET
 	// GDB
-	if (xroar.cfg.debug.gdb) {
-		mcc3->gdb_interface = gdb_interface_new(xroar.cfg.debug.gdb_ip, xroar.cfg.debug.gdb_port, m, mcc3->bp_session);
+	if (xroar_cfg.debug.gdb) {
+		mcc3->gdb_interface = gdb_interface_new(xroar_cfg.debug.gdb_ip, xroar_cfg.debug.gdb_port, m, mcc3->bp_session);
 	}
 #endif
 
@@ -1006,11 +1012,6 @@ static void coco3_set_composite(struct machine *m, _Bool value) {
 	tcc1014_set_composite(mcc3->GIME, value);
 }
 
-static void coco3_set_frameskip(struct machine *m, unsigned fskip) {
-	struct machine_coco3 *mcc3 = (struct machine_coco3 *)m;
-	mcc3->frameskip = fskip;
-}
-
 static void coco3_set_ratelimit(struct machine *m, _Bool ratelimit) {
 	struct machine_coco3 *mcc3 = (struct machine_coco3 *)m;
 	sound_set_ratelimit(mcc3->snd, ratelimit);
@@ -1184,6 +1185,27 @@ static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 	event_run_queue(&MACHINE_EVENT_LIST);
 	MC6809_IRQ_SET(mcc3->CPU, mcc3->PIA0->a.irq | mcc3->PIA0->b.irq | mcc3->GIME->IRQ);
 	MC6809_FIRQ_SET(mcc3->CPU, mcc3->PIA1->a.irq | mcc3->PIA1->b.irq | mcc3->GIME->FIRQ);
+	coco3_idle_skip(mcc3, ncycles);
+
+	// Plain RAM access: no cartridge that needs to see every cycle, DAT
+	// board not translating, and nothing else selected.
+	if (mcc3->GIME->RAS && mcc3->GIME->S == 7 && !mcc3->dat.MMUEN &&
+	    (!mcc3->cart || mcc3->cart->decode_p2r2_only)
+#ifdef WANT_GDB_TARGET
+	    && !mcc3->bp_session->wp_read_list && !mcc3->bp_session->wp_write_list
+#endif
+	    ) {
+		uint32_t Z = mcc3->GIME->Z;
+		uint8_t *p = mcc3->ram_block[(Z >> 13) & 63];
+		if (p) {
+			if (RnW) {
+				mcc3->CPU->D = p[Z & 0x1fff];
+			} else {
+				p[Z & 0x1fff] = mcc3->CPU->D;
+			}
+			return;
+		}
+	}
 
 	if (RnW) {
 		read_byte(mcc3, A);
@@ -1200,6 +1222,62 @@ static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 	}
 }
 
+// If the CPU is just waiting for an interrupt, every cycle until the next
+// scheduled event is an identical dummy access to $FFFF, so skip straight to
+// the last of them.  Also stops short of the end of the current run.
+
+static void coco3_idle_skip(struct machine_coco3 *mcc3, int ncycles) {
+	if (!xroar_cfg.debug.idle_skip || !mc6809_is_idle(mcc3->CPU))
+		return;
+	// A cartridge might be counting cycles
+	if (mcc3->cart && !mcc3->cart->decode_p2r2_only)
+		return;
+#ifdef WANT_GDB_TARGET
+	if (mcc3->bp_session->wp_read_list)
+		return;
+#endif
+
+	int nskip = (mcc3->cycles - 1) / ncycles;
+	if (MACHINE_EVENT_LIST.nevents) {
+		int dt = event_tick_delta(MACHINE_EVENT_LIST.deadline, event_current_tick);
+		int n = (dt - 1) / ncycles;
+		if (n < nskip)
+			nskip = n;
+	}
+	if (nskip <= 0)
+		return;
+
+	mcc3->cycles -= nskip * ncycles;
+	event_current_tick += nskip * ncycles;
+}
+
+// Called by the CPU part way through a run of dummy cycles.  Each remaining
+// cycle repeats the access to $FFFF just made, so as long as no event falls
+// due, their only effect is the passage of time.
+
+static unsigned coco3_nvma_cycles(void *sptr, int ncycles) {
+	struct machine_coco3 *mcc3 = sptr;
+	// A cartridge might be counting cycles
+	if (mcc3->cart && !mcc3->cart->decode_p2r2_only)
+		return 0;
+#ifdef WANT_GDB_TARGET
+	if (mcc3->bp_session->wp_read_list)
+		return 0;
+#endif
+
+	int max_ticks = mcc3->cycles;
+	if (MACHINE_EVENT_LIST.nevents) {
+		int dt = event_tick_delta(MACHINE_EVENT_LIST.deadline, event_current_tick);
+		if (dt < max_ticks)
+			max_ticks = dt;
+	}
+	int ticks;
+	unsigned n = tcc1014_nvma_cycles(mcc3->GIME, ncycles, max_ticks, &ticks);
+	mcc3->cycles -= ticks;
+	event_current_tick += ticks;
+	return n;
+}
+
 static void cpu_cycle_noclock(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 	struct machine_coco3 *mcc3 = sptr;
 	(void)ncycles;
@@ -1210,6 +1288,22 @@ static void cpu_cycle_noclock(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 	}
 }
 
+// Find host pointers for each 8K block of RAM in bank 0.  RAM address
+// translation only moves individual address bits around, so a block is
+// contiguous if each of its low 13 address bits lands in the right place.
+
+static void update_ram_blocks(struct machine_coco3 *mcc3) {
+	for (unsigned b = 0; b < 64; b++) {
+		uint32_t Z = b << 13;
+		uint8_t *p = ram_a8(mcc3->RAM, 0, Z, Z >> 9);
+		for (uint32_t i = 1; p && i < 0x2000; i <<= 1) {
+			if (ram_a8(mcc3->RAM, 0, Z | i, (Z | i) >> 9) != p + i)
+				p = NULL;
+		}
+		mcc3->ram_block[b] = p;
+	}
+}
+
 /* Read a byte without advancing clock.  Used for debugging & breakpoints. */
 
 static uint8_t coco3_read_byte(struct machine *m, unsigned A, uint8_t D) {
@@ -1256,7 +1350,7 @@ static uint16_t fetch_vram(void *sptr, uint32_t A) {
 	unsigned Zrow = A & ~1;
 	unsigned Zcol = A >> 9;
 	uint8_t *Vp = ram_a8(mcc3->RAM, bank, Zrow, Zcol);
-	static uint16_t D = 0;
+	static VAR_ATTR_THREAD_LOCAL uint16_t D = 0;
 	if (Vp) {
 		D = (*Vp << 8) | *(Vp+1);
 	}
@@ -1355,16 +1449,14 @@ static void gime_fs(void *sptr, _Bool level) {
 	mc6821_set_cx1(&mcc3->PIA0->b, level);
 	if (level) {
 		sound_update(mcc3->snd);
-		mcc3->frame--;
-		if (mcc3->frame < 0)
-			mcc3->frame = mcc3->frameskip;
-		vo_vsync(mcc3->vo, mcc3->frame == 0);
+		vo_vsync(mcc3->vo);
+		tcc1014_set_timing_only(mcc3->GIME, mcc3->vo->skip_render);
 	}
 }
 
 static void gime_render_line(void *sptr, unsigned burst, unsigned npixels, uint8_t const *data) {
 	struct machine_coco3 *mcc3 = sptr;
-	DELEGATE_CALL(mcc3->vo->render_line, burst, npixels, data);
+	DELEGATE_CALL(mcc3->vo->render_line, burst, npixels, mcc3->vo->skip_render ? NULL : data);
 }
 
 // CoCo serial printing ROM hook.
@@ -0,0 +1,238 @@
+/** \file
+ *
+ *  \brief CPU core benchmark.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Runs each CPU core in turn against a flat 64K of RAM holding a short loop
+ *  of common instructions, and reports emulated instructions and cycles per
+ *  second of host CPU time.  Only the CPU is emulated, so the figures measure
+ *  the interpreter itself: use them to compare builds (e.g. configured with
+ *  and without --enable-threaded-dispatch, which affects only the MC6803) on
+ *  the same host.
+ *
+ *  Not built by default.  Build with "make cpubench" in the src directory.
+ *
+ *  Usage: cpubench [MCYCLES]
+ *
+ *  MCYCLES is the number of emulated cycles per core, in millions (default
+ *  100).
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "array.h"
+#include "delegate.h"
+#include "xalloc.h"
+
+#include "mc6801/mc6801.h"
+#include "mc6809/mc6809.h"
+#include "part.h"
+
+// 6809 code, also run on the 6309 (in 6809 emulation mode)
+
+static const uint8_t code_6809[] = {
+	0x10, 0xce, 0x80, 0x00,      // 1000  LDS #$8000
+	0x8e, 0x20, 0x00,            // 1004  LDX #$2000
+	0x10, 0x8e, 0x30, 0x00,      // 1007  LDY #$3000
+	0xce, 0x40, 0x00,            // 100b  LDU #$4000
+	0xc6, 0x40,                  // 100e  LDB #$40
+	0xa6, 0x80,                  // 1010  LDA ,X+
+	0xab, 0xa0,                  // 1012  ADDA ,Y+
+	0xa7, 0xc0,                  // 1014  STA ,U+
+	0x34, 0x04,                  // 1016  PSHS B
+	0x1f, 0x89,                  // 1018  TFR A,B
+	0x3d,                        // 101a  MUL
+	0xdd, 0x80,                  // 101b  STD <$80
+	0x35, 0x04,                  // 101d  PULS B
+	0xbd, 0x10, 0x27,            // 101f  JSR $1027
+	0x5a,                        // 1022  DECB
+	0x26, 0xeb,                  // 1023  BNE $1010
+	0x20, 0xdd,                  // 1025  BRA $1004
+	0x39,                        // 1027  RTS
+};
+
+// Equivalent 6801 code
+
+static const uint8_t code_6801[] = {
+	0x8e, 0x80, 0x00,            // 1000  LDS #$8000
+	0xce, 0x20, 0x00,            // 1003  LDX #$2000
+	0xc6, 0x40,                  // 1006  LDAB #$40
+	0xa6, 0x00,                  // 1008  LDAA 0,X
+	0xab, 0x01,                  // 100a  ADDA 1,X
+	0xa7, 0x02,                  // 100c  STAA 2,X
+	0x08,                        // 100e  INX
+	0x37,                        // 100f  PSHB
+	0x16,                        // 1010  TAB
+	0x3d,                        // 1011  MUL
+	0xfd, 0x40, 0x00,            // 1012  STD $4000
+	0x33,                        // 1015  PULB
+	0xbd, 0x10, 0x1e,            // 1016  JSR $101e
+	0x5a,                        // 1019  DECB
+	0x26, 0xec,                  // 101a  BNE $1008
+	0x20, 0xe5,                  // 101c  BRA $1003
+	0x39,                        // 101e  RTS
+};
+
+struct bench {
+	uint8_t ram[0x10000];
+	uint8_t *D;
+	_Bool *running;
+	uint64_t ncycles;
+	uint64_t limit;
+	uint64_t ninstructions;
+};
+
+struct core {
+	const char *name;
+	void *options;
+	const uint8_t *code;
+	size_t code_size;
+	void (*setup)(struct part *p, struct bench *b, _Bool count);
+	void (*run)(struct part *p);
+};
+
+static void setup_6809(struct part *p, struct bench *b, _Bool count);
+static void run_6809(struct part *p);
+static void setup_6801(struct part *p, struct bench *b, _Bool count);
+static void run_6801(struct part *p);
+
+static const struct core cores[] = {
+	{ "MC6809", NULL, code_6809, sizeof(code_6809), setup_6809, run_6809 },
+	{ "HD6309", NULL, code_6809, sizeof(code_6809), setup_6809, run_6809 },
+	{ "MC6803", "6803", code_6801, sizeof(code_6801), setup_6801, run_6801 },
+};
+
+static void bench_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
+	struct bench *b = sptr;
+	if (RnW) {
+		*b->D = b->ram[A];
+	} else {
+		b->ram[A] = *b->D;
+	}
+	if (++b->ncycles >= b->limit)
+		*b->running = 0;
+}
+
+static void bench_instruction_posthook(void *sptr) {
+	struct bench *b = sptr;
+	b->ninstructions++;
+}
+
+static void setup_6809(struct part *p, struct bench *b, _Bool count) {
+	struct MC6809 *cpu = (struct MC6809 *)p;
+	b->D = &cpu->D;
+	b->running = &cpu->running;
+	cpu->mem_cycle = DELEGATE_AS2(void, bool, uint16, bench_mem_cycle, b);
+	if (count)
+		cpu->debug_cpu.instruction_posthook = DELEGATE_AS0(void, bench_instruction_posthook, b);
+	cpu->reset(cpu);
+}
+
+static void run_6809(struct part *p) {
+	struct MC6809 *cpu = (struct MC6809 *)p;
+	cpu->running = 1;
+	cpu->run(cpu);
+}
+
+static void setup_6801(struct part *p, struct bench *b, _Bool count) {
+	struct MC6801 *cpu = (struct MC6801 *)p;
+	b->D = &cpu->D;
+	b->running = &cpu->running;
+	cpu->mem_cycle = DELEGATE_AS2(void, bool, uint16, bench_mem_cycle, b);
+	if (count)
+		cpu->debug_cpu.instruction_posthook = DELEGATE_AS0(void, bench_instruction_posthook, b);
+	cpu->reset(cpu);
+}
+
+static void run_6801(struct part *p) {
+	struct MC6801 *cpu = (struct MC6801 *)p;
+	cpu->running = 1;
+	cpu->run(cpu);
+}
+
+// Run a core from reset for the given number of cycles.  Returns host CPU
+// time taken.
+
+static clock_t bench_run(const struct core *c, struct bench *b, uint64_t ncycles, _Bool count) {
+	struct part *p = part_create(c->name, c->options);
+	if (!p) {
+		fprintf(stderr, "%s: can't create part\n", c->name);
+		exit(EXIT_FAILURE);
+	}
+	memset(b->ram, 0, sizeof(b->ram));
+	memcpy(b->ram + 0x1000, c->code, c->code_size);
+	b->ram[0xfffe] = 0x10;
+	b->ram[0xffff] = 0x00;
+	b->ncycles = 0;
+	b->limit = ncycles;
+	b->ninstructions = 0;
+	c->setup(p, b, count);
+
+	clock_t start = clock();
+	while (b->ncycles < ncycles) {
+		c->run(p);
+	}
+	clock_t elapsed = clock() - start;
+
+	part_free(p);
+	return elapsed;
+}
+
+int main(int argc, char **argv) {
+	uint64_t ncycles = 100000000;
+	if (argc > 1) {
+		long mcycles = strtol(argv[1], NULL, 0);
+		if (mcycles < 1) {
+			fprintf(stderr, "usage: %s [MCYCLES]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		ncycles = (uint64_t)mcycles * 1000000;
+	}
+
+#ifdef OP_DISPATCH_THREADED
+	printf("MC6803 opcode dispatch: threaded\n");
+#else
+	printf("MC6803 opcode dispatch: switch\n");
+#endif
+
+	struct bench *b = xmalloc(sizeof(*b));
+
+	for (unsigned i = 0; i < ARRAY_N_ELEMENTS(cores); i++) {
+		const struct core *c = &cores[i];
+
+		// Each core is run twice from reset over the same number of
+		// cycles, so both runs execute the same instructions.  The
+		// first counts them through the post-instruction hook, the
+		// second is timed with no hook set.
+		(void)bench_run(c, b, ncycles, 1);
+		uint64_t ninstructions = b->ninstructions;
+		double seconds = (double)bench_run(c, b, ncycles, 0) / CLOCKS_PER_SEC;
+		if (seconds <= 0.)
+			seconds = 1. / CLOCKS_PER_SEC;
+
+		printf("%-8s %8.2f Minstr/s %8.2f Mcycles/s  (%.2fs)\n", c->name,
+		       (ninstructions / seconds) / 1e6,
+		       (ncycles / seconds) / 1e6, seconds);
+	}
+
+	free(b);
+	return EXIT_SUCCESS;
+}
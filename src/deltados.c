@@ -116,6 +116,7 @@ static struct part *deltados_allocate(void) {
 	c->reset = deltados_reset;
 	c->has_interface = deltados_has_interface;
 	c->attach_interface = deltados_attach_interface;
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
@@ -228,7 +228,7 @@ static _Bool deluxecoco_finish(struct part *p) {
 	// Report and check CRC (Advanced Colour BASIC)
 	rombank_report(mdp->ROM0, "Advanced Colour BASIC");
 	md->crc_combined = 0x1cce231e;  // ACB 00.00.07
-	md->has_combined = rombank_verify_crc(mdp->ROM0, "Advanced Colour BASIC", -1, "@deluxecoco", xroar.cfg.force_crc_match, &md->crc_combined);
+	md->has_combined = rombank_verify_crc(mdp->ROM0, "Advanced Colour BASIC", -1, "@deluxecoco", xroar_cfg.force_crc_match, &md->crc_combined);
 
 	md->SAM->cpu_cycle = DELEGATE_AS3(void, int, bool, uint16, deluxecoco_cpu_cycle, mdp);
 
@@ -422,6 +422,7 @@ static void deluxecoco_cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A)
 		_Bool supp_irq = mdp->irq_60hz;
 		MC6809_IRQ_SET(md->CPU, md->PIA0->a.irq || md->PIA0->b.irq || supp_irq);
 		MC6809_FIRQ_SET(md->CPU, md->PIA1->a.irq || md->PIA1->b.irq);
+		dragon_idle_skip(md, ncycles);
 	}
 
 	unsigned Zrow = md->SAM->Zrow;
@@ -460,10 +461,8 @@ static void deluxecoco_vdg_fs(void *sptr, _Bool level) {
 	mc6883_vdg_fsync(md->SAM, level);
 	if (level) {
 		sound_update(md->snd);
-		md->frame--;
-		if (md->frame < 0)
-			md->frame = md->frameskip;
-		vo_vsync(md->vo, md->frame == 0);
+		vo_vsync(md->vo);
+		mc6847_set_timing_only(md->VDG, md->vo->skip_render);
 	} else {
 		if (mdp->irq_60hz_enable) {
 			mdp->irq_60hz = 1;
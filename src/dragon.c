@@ -71,7 +71,6 @@ struct machine_dragon_common {
 	struct ram *RAM;
 
 	struct vo_interface *vo;
-	int frame;  // track frameskip
 	struct sound_interface *snd;
 
 	// Derived machines can use these to redirect address decoding.  If
@@ -81,7 +80,6 @@ struct machine_dragon_common {
 
 	_Bool inverted_text;
 	struct cart *cart;
-	unsigned frameskip;
 
 	int cycles;
 
@@ -92,6 +90,17 @@ struct machine_dragon_common {
 	// RAM read buffer.  Driven to data bus only when SAM S == 0.
 	uint8_t Dread;
 
+	// Fast path for plain RAM & ROM accesses.  For each 256 byte page,
+	// points to directly accessible memory if a read or write to that page
+	// has no side effects beyond transferring the byte.  Rebuilt on demand
+	// whenever anything affecting address decode changes.
+	struct {
+		_Bool valid;
+		unsigned sam_reg;  // SAM map bits (P, M, TY) when built
+		uint8_t *read[256];
+		uint8_t *write[256];
+	} page_map;
+
 	// Debug
 	struct bp_session *bp_session;
 	_Bool single_step;
@@ -300,7 +309,6 @@ static int dragon_set_keyboard_type(struct machine *m, int action);
 static _Bool dragon_set_pause(struct machine *m, int state);
 static _Bool dragon_set_inverted_text(struct machine *m, int state);
 static void *dragon_get_interface(struct machine *m, const char *ifname);
-static void dragon_set_frameskip(struct machine *m, unsigned fskip);
 static void dragon_set_ratelimit(struct machine *m, _Bool ratelimit);
 
 static uint8_t dragon_read_byte(struct machine *m, unsigned A, uint8_t D);
@@ -330,6 +338,8 @@ static struct machine_bp coco_print_breakpoint[] = {
 };
 
 static inline void advance_clock(struct machine_dragon_common *md, int ncycles);
+static void dragon_idle_skip(struct machine_dragon_common *md, int ncycles);
+static unsigned dragon_nvma_cycles(void *sptr, int ncycles);
 static void dragon_cpu_cycle(struct machine_dragon_common *md, _Bool RnW,
 			     uint16_t A, unsigned Zrow, unsigned Zcol);
 static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A);
@@ -402,7 +412,6 @@ static void dragon_allocate_common(struct machine_dragon_common *md) {
 	m->set_pause = dragon_set_pause;
 	m->set_inverted_text = dragon_set_inverted_text;
 	m->get_interface = dragon_get_interface;
-	m->set_frameskip = dragon_set_frameskip;
 	m->set_ratelimit = dragon_set_ratelimit;
 
 	m->read_byte = dragon_read_byte;
@@ -490,6 +499,9 @@ static _Bool dragon_finish_common(struct machine_dragon_common *md) {
 		return 0;
 	}
 
+	// Memory map may have changed
+	md->page_map.valid = 0;
+
 	_Bool is_dragon32 = strcmp(mc->architecture, "dragon32") == 0;
 
 	md->has_combined = md->has_extbas = md->has_bas = md->has_altbas = 0;
@@ -530,6 +542,7 @@ static _Bool dragon_finish_common(struct machine_dragon_common *md) {
 	md->SAM->cpu_cycle = DELEGATE_AS3(void, int, bool, uint16, cpu_cycle, md);
 	md->SAM->vdg_update = DELEGATE_AS0(void, mc6847_update, md->VDG);
 	md->CPU->mem_cycle = DELEGATE_AS2(void, bool, uint16, mc6883_mem_cycle, md->SAM);
+	md->CPU->nvma_cycles = DELEGATE_AS1(unsigned, int, dragon_nvma_cycles, md);
 
 	// Breakpoint session
 	md->bp_session = bp_session_new(m);
@@ -738,8 +751,8 @@ static _Bool dragon_finish_common(struct machine_dragon_common *md) {
 
 #ifdef WANT_GDB_TARGET
 	// GDB
-	if (xroar.cfg.debug.gdb) {
-		md->gdb_interface = gdb_interface_new(xroar.cfg.debug.gdb_ip, xroar.cfg.debug.gdb_port, m, md->bp_session);
+	if (xroar_cfg.debug.gdb) {
+		md->gdb_interface = gdb_interface_new(xroar_cfg.debug.gdb_ip, xroar_cfg.debug.gdb_port, m, md->bp_session);
 	}
 #endif
 
@@ -798,15 +811,15 @@ static _Bool dragon_finish(struct part *p) {
 	// Check CRCs
 	if (is_dragon32) {
 		md->crc_combined = 0xe3879310;  // Dragon 32 BASIC
-		md->has_combined = rombank_verify_crc(md->ROM0, "BASIC", -1, "@d32", xroar.cfg.force_crc_match, &md->crc_combined);
+		md->has_combined = rombank_verify_crc(md->ROM0, "BASIC", -1, "@d32", xroar_cfg.force_crc_match, &md->crc_combined);
 
 	} else {
 		md->crc_bas = (mc->ram > 4) ? 0xd8f4d15e : 0x00b50aaa;  // CB 1.3/1.0
 		const char *crclist = (mc->ram > 4) ? "@coco" : "@bas10";
-		md->has_bas = rombank_verify_crc(md->ROM0, "Colour BASIC", 1, crclist, xroar.cfg.force_crc_match, &md->crc_bas);
+		md->has_bas = rombank_verify_crc(md->ROM0, "Colour BASIC", 1, crclist, xroar_cfg.force_crc_match, &md->crc_bas);
 
 		md->crc_extbas = 0xa82a6254;  // ECB 1.1
-		md->has_extbas = rombank_verify_crc(md->ROM0, "Extended Colour BASIC", 0, "@cocoext", xroar.cfg.force_crc_match, &md->crc_extbas);
+		md->has_extbas = rombank_verify_crc(md->ROM0, "Extended Colour BASIC", 0, "@cocoext", xroar_cfg.force_crc_match, &md->crc_extbas);
 	}
 
 	// VDG
@@ -968,6 +981,7 @@ static void dragon_connect_cart(struct part *p) {
 	struct machine_dragon_common *md = (struct machine_dragon_common *)p;
 	struct cart *c = (struct cart *)part_component_by_id_is_a(p, "cart", "dragon-cart");
 	md->cart = c;
+	md->page_map.valid = 0;
 	if (!c)
 		return;
 	assert(c->read != NULL);
@@ -987,6 +1001,7 @@ static void dragon_remove_cart(struct machine *m) {
 	struct machine_dragon_common *md = (struct machine_dragon_common *)m;
 	part_free((struct part *)md->cart);
 	md->cart = NULL;
+	md->page_map.valid = 0;
 }
 
 static void dragon_reset(struct machine *m, _Bool hard) {
@@ -1002,6 +1017,7 @@ static void dragon_reset(struct machine *m, _Bool hard) {
 		md->cart->reset(md->cart, hard);
 	}
 	mc6883_reset(md->SAM);
+	md->page_map.valid = 0;
 	md->CPU->reset(md->CPU);
 	mc6847_reset(md->VDG);
 	tape_reset(md->tape_interface);
@@ -1182,11 +1198,6 @@ static void *dragon_get_interface(struct machine *m, const char *ifname) {
 	return NULL;
 }
 
-static void dragon_set_frameskip(struct machine *m, unsigned fskip) {
-	struct machine_dragon_common *md = (struct machine_dragon_common *)m;
-	md->frameskip = fskip;
-}
-
 static void dragon_set_ratelimit(struct machine *m, _Bool ratelimit) {
 	struct machine_dragon_common *md = (struct machine_dragon_common *)m;
 	sound_set_ratelimit(md->snd, ratelimit);
@@ -1208,6 +1219,10 @@ static void dragon_instruction_posthook(void *sptr) {
 static inline void advance_clock(struct machine_dragon_common *md, int ncycles);
 static void read_byte(struct machine_dragon_common *md, unsigned A);
 static void write_byte(struct machine_dragon_common *md, unsigned A);
+static void dragon_update_page_map(struct machine_dragon_common *md);
+
+// SAM register bits that affect the memory map: P, M1, M0, TY.
+#define SAM_MAP_BITS (0xe400)
 
 // The SAM's mc6883_mem_cycle() is set up to call cpu_cycle(), which does the
 // following:
@@ -1233,6 +1248,38 @@ static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 		advance_clock(md, ncycles);
 		MC6809_IRQ_SET(md->CPU, md->PIA0->a.irq || md->PIA0->b.irq);
 		MC6809_FIRQ_SET(md->CPU, md->PIA1->a.irq || md->PIA1->b.irq);
+		dragon_idle_skip(md, ncycles);
+	}
+
+	// Most cycles are plain RAM or ROM accesses: handle those without
+	// going through full decode.
+	if (!md->page_map.valid)
+		dragon_update_page_map(md);
+#ifdef WANT_GDB_TARGET
+	if (!md->bp_session->wp_read_list && !md->bp_session->wp_write_list)
+#endif
+	{
+		if (RnW) {
+			uint8_t *p = md->page_map.read[A >> 8];
+			if (p) {
+				md->CPU->D = p[A & 0xff];
+				return;
+			}
+		} else {
+			uint8_t *p = md->page_map.write[A >> 8];
+			if (p) {
+				p[A & 0xff] = md->CPU->D;
+				return;
+			}
+		}
+	}
+
+	// A write to the SAM control register may change the memory map.
+	// Derived SAM state is only updated after this returns, so the map is
+	// rebuilt on the next cycle.
+	if (!RnW && A >= 0xffd4) {
+		if ((mc6883_get_register(md->SAM) & SAM_MAP_BITS) != md->page_map.sam_reg)
+			md->page_map.valid = 0;
 	}
 
 	unsigned Zrow = md->SAM->Zrow;
@@ -1241,6 +1288,64 @@ static void cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A) {
 	dragon_cpu_cycle(md, RnW, A, Zrow, Zcol);
 }
 
+// Find directly accessible memory backing a whole 256 byte RAM page, or NULL
+// if it's not present or not contiguous.  SAM and RAM address translation
+// only ever move individual address bits around, so it's enough to check
+// that each of the low eight bits ends up in the right place.
+
+static uint8_t *page_map_ram(struct machine_dragon_common *md, uint16_t A) {
+	unsigned bank, row, col;
+	if (!mc6883_decode_ram(md->SAM, A, &bank, &row, &col))
+		return NULL;
+	uint8_t *p = ram_a8(md->RAM, bank, row, col);
+	if (!p)
+		return NULL;
+	for (unsigned i = 1; i < 256; i <<= 1) {
+		if (!mc6883_decode_ram(md->SAM, A | i, &bank, &row, &col))
+			return NULL;
+		if (ram_a8(md->RAM, bank, row, col) != p + i)
+			return NULL;
+	}
+	return p;
+}
+
+static void dragon_update_page_map(struct machine_dragon_common *md) {
+	md->page_map.valid = 1;
+	md->page_map.sam_reg = mc6883_get_register(md->SAM) & SAM_MAP_BITS;
+	for (unsigned page = 0; page < 256; page++) {
+		md->page_map.read[page] = NULL;
+		md->page_map.write[page] = NULL;
+	}
+
+	// A cartridge that may snoop the bus or assert EXTMEM needs to see
+	// every cycle.
+	if (md->cart && !md->cart->decode_p2r2_only)
+		return;
+
+	// Page $FF is IO and is never mapped.
+	for (unsigned page = 0; page < 0xff; page++) {
+		uint16_t A = page << 8;
+
+		unsigned S = mc6883_decode(md->SAM, 1, A);
+		if (S == 0) {
+			md->page_map.read[page] = page_map_ram(md, A);
+		} else if ((S == 1 || S == 2) && !md->read_byte && md->ROM0) {
+			// Derived machines that override read_byte() may page
+			// their ROMs, so only use ROM0 directly if not.
+			uint8_t *p = rombank_a8(md->ROM0, A);
+			if (p && rombank_a8(md->ROM0, A | 0xff) == p + 0xff)
+				md->page_map.read[page] = p;
+		}
+
+		// Writes always go to RAM if selected, but also reach ROM
+		// & cartridge decode on an unexpanded Dragon 32.
+		S = mc6883_decode(md->SAM, 0, A);
+		if (S == 7 || (!(S & 4) && !md->unexpanded_dragon32)) {
+			md->page_map.write[page] = page_map_ram(md, A);
+		}
+	}
+}
+
 // Advance clock and run scheduled events
 
 static inline void advance_clock(struct machine_dragon_common *md, int ncycles) {
@@ -1250,6 +1355,74 @@ static inline void advance_clock(struct machine_dragon_common *md, int ncycles)
 	event_run_queue(&MACHINE_EVENT_LIST);
 }
 
+// Called after a cycle's clock has been advanced and interrupt inputs
+// updated.  If the CPU is just waiting for an interrupt, every cycle until the
+// next scheduled event is an identical dummy access to $FFFF, so skip straight
+// to the last of them.  Also stops short of the end of the current run.
+
+static void dragon_idle_skip(struct machine_dragon_common *md, int ncycles) {
+	if (!xroar_cfg.debug.idle_skip || !mc6809_is_idle(md->CPU))
+		return;
+	// A cartridge might be counting cycles
+	if (md->cart && !md->cart->decode_p2r2_only)
+		return;
+#ifdef WANT_GDB_TARGET
+	if (md->bp_session->wp_read_list)
+		return;
+#endif
+	// Only skip once the SAM has settled into a steady cycle length.
+	// Fast cycles also alternate the interleave state, so skip an even
+	// number of them.
+	_Bool fast = (ncycles == EVENT_TICKS_14M31818(8));
+	if (!fast && ncycles != EVENT_TICKS_14M31818(16))
+		return;
+
+	int nskip = (md->cycles - 1) / ncycles;
+	if (MACHINE_EVENT_LIST.nevents) {
+		int dt = event_tick_delta(MACHINE_EVENT_LIST.deadline, event_current_tick);
+		int n = (dt - 1) / ncycles;
+		if (n < nskip)
+			nskip = n;
+	}
+	if (fast)
+		nskip &= ~1;
+	if (nskip <= 0)
+		return;
+
+	md->cycles -= nskip * ncycles;
+	event_current_tick += nskip * ncycles;
+}
+
+// Called by the CPU part way through a run of dummy cycles.  Each remaining
+// cycle repeats the access to $FFFF just made, so as long as no event falls
+// due, their only effect is the passage of time.  Stops short of the next event
+// and of the end of the current run, leaving those to the normal path.
+
+static unsigned dragon_nvma_cycles(void *sptr, int ncycles) {
+	struct machine_dragon_common *md = sptr;
+	if (md->clock_inhibit)
+		return 0;
+	// A cartridge might be counting cycles
+	if (md->cart && !md->cart->decode_p2r2_only)
+		return 0;
+#ifdef WANT_GDB_TARGET
+	if (md->bp_session->wp_read_list)
+		return 0;
+#endif
+
+	int max_ticks = md->cycles;
+	if (MACHINE_EVENT_LIST.nevents) {
+		int dt = event_tick_delta(MACHINE_EVENT_LIST.deadline, event_current_tick);
+		if (dt < max_ticks)
+			max_ticks = dt;
+	}
+	int ticks;
+	unsigned n = mc6883_nvma_cycles(md->SAM, ncycles, max_ticks, &ticks);
+	md->cycles -= ticks;
+	event_current_tick += ticks;
+	return n;
+}
+
 // Common routine called by cpu_cycle() (or override) to access RAM and devices
 // for a CPU cycle.
 
@@ -1631,17 +1804,15 @@ static void vdg_fs(void *sptr, _Bool level) {
 	mc6883_vdg_fsync(md->SAM, level);
 	if (level) {
 		sound_update(md->snd);
-		md->frame--;
-		if (md->frame < 0)
-			md->frame = md->frameskip;
-		vo_vsync(md->vo, md->frame == 0);
+		vo_vsync(md->vo);
+		mc6847_set_timing_only(md->VDG, md->vo->skip_render);
 	}
 }
 
 static void vdg_render_line(void *sptr, unsigned burst, unsigned npixels, uint8_t const *data) {
 	struct machine_dragon_common *md = sptr;
 	burst = (burst | md->ntsc_burst_mod) & 3;
-	DELEGATE_CALL(md->vo->render_line, burst, npixels, data);
+	DELEGATE_CALL(md->vo->render_line, burst, npixels, md->vo->skip_render ? NULL : data);
 }
 
 /* Dragon parallel printer line delegate. */
@@ -122,6 +122,7 @@ static struct part *dragondos_allocate(void) {
 	c->reset = dragondos_reset;
 	c->has_interface = dragondos_has_interface;
 	c->attach_interface = dragondos_attach_interface;
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
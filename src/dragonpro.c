@@ -253,12 +253,12 @@ static _Bool dragonpro_finish(struct part *p) {
 	// Report and check CRC (BOOT)
 	rombank_report(mdp->BOOT, "BOOT");
 	uint32_t boot_crc32 = 0xc3dab585;  // Dragon Pro BOOT 1.0
-	(void)rombank_verify_crc(mdp->BOOT, "BOOT", -1, "@dragonpro_boot", xroar.cfg.force_crc_match, &boot_crc32);
+	(void)rombank_verify_crc(mdp->BOOT, "BOOT", -1, "@dragonpro_boot", xroar_cfg.force_crc_match, &boot_crc32);
 
 	// Report and check CRC (32K BASIC)
 	rombank_report(mdp->ROM0, "32K BASIC");
 	md->crc_combined = 0x84f68bf9;  // Dragon 64 32K mode BASIC
-	md->has_combined = rombank_verify_crc(mdp->ROM0, "32K BASIC", -1, "@dragonpro_basic", xroar.cfg.force_crc_match, &md->crc_combined);
+	md->has_combined = rombank_verify_crc(mdp->ROM0, "32K BASIC", -1, "@dragonpro_basic", xroar_cfg.force_crc_match, &md->crc_combined);
 
 	md->SAM->cpu_cycle = DELEGATE_AS3(void, int, bool, uint16, dragonpro_cpu_cycle, mdp);
 
@@ -476,6 +476,7 @@ static void dragonpro_cpu_cycle(void *sptr, int ncycles, _Bool RnW, uint16_t A)
 		_Bool supp_firq = mdp->PIA2->a.irq || mdp->PIA2->b.irq;
 		MC6809_IRQ_SET(md->CPU, md->PIA0->a.irq || md->PIA0->b.irq);
 		MC6809_FIRQ_SET(md->CPU, md->PIA1->a.irq || md->PIA1->b.irq || supp_firq);
+		dragon_idle_skip(md, ncycles);
 	}
 
 	unsigned Zrow = md->SAM->Zrow;
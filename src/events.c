@@ -2,7 +2,7 @@
  *
  *  \brief Event scheduling & dispatch.
  *
- *  \copyright Copyright 2005-2022 Ciaran Anscomb
+ *  \copyright Copyright 2005-2024 Ciaran Anscomb
  *
  *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
  *
@@ -26,12 +26,17 @@
 #include "logging.h"
 
 extern inline int event_tick_delta(event_ticks t0, event_ticks t1);
-extern inline _Bool event_pending(struct event **list);
-extern inline void event_dispatch_next(struct event **list);
-extern inline void event_run_queue(struct event **list);
+extern inline _Bool event_pending(struct event_list *list);
+extern inline void event_run_queue(struct event_list *list);
 
+VAR_ATTR_THREAD_LOCAL event_ticks event_current_tick = 0;
 
-event_ticks event_current_tick = 0;
+// Autofree events no longer in use.
+static VAR_ATTR_THREAD_LOCAL struct event *event_pool = NULL;
+
+static void heap_sift_up(struct event_list *list, unsigned i);
+static void heap_sift_down(struct event_list *list, unsigned i);
+static void heap_remove(struct event_list *list, unsigned i);
 
 struct event *event_new(DELEGATE_T0(void) delegate) {
 	struct event *new = xmalloc(sizeof(*new));
@@ -51,25 +56,33 @@ void event_free(struct event *event) {
 	free(event);
 }
 
-void event_queue(struct event **list, struct event *event) {
-	struct event **entry;
+void event_queue(struct event_list *list, struct event *event) {
 	if (event->queued)
 		event_dequeue(event);
+	if (list->nevents >= list->heap_size) {
+		list->heap_size = list->heap_size ? list->heap_size * 2 : 16;
+		list->heap = xrealloc(list->heap, list->heap_size * sizeof(*list->heap));
+	}
 	event->list = list;
 	event->queued = 1;
-	for (entry = list; *entry; entry = &((*entry)->next)) {
-		if (event_tick_delta(event->at_tick, (*entry)->at_tick) < 0) {
-			event->next = *entry;
-			*entry = event;
-			return;
-		}
-	}
-	*entry = event;
+	// Clear any "queue me" flag left by deserialisation
 	event->next = NULL;
+	event->seq = list->next_seq++;
+	unsigned i = list->nevents++;
+	list->heap[i] = event;
+	event->heap_index = i;
+	heap_sift_up(list, i);
+	list->deadline = list->heap[0]->at_tick;
 }
 
-void event_queue_auto(struct event **list, DELEGATE_T0(void) delegate, int dt) {
-	struct event *e = event_new(delegate);
+void event_queue_auto(struct event_list *list, DELEGATE_T0(void) delegate, int dt) {
+	struct event *e = event_pool;
+	if (e) {
+		event_pool = e->next;
+		event_init(e, delegate);
+	} else {
+		e = event_new(delegate);
+	}
 	e->at_tick += dt;
 	e->autofree = 1;
 	event_queue(list, e);
@@ -79,15 +92,102 @@ void event_dequeue(struct event *event) {
 	if (!event->queued)
 		return;
 	event->queued = 0;
-	struct event **list = event->list;
-	if (*list == event) {
-		*list = event->next;
-		return;
+	struct event_list *list = event->list;
+	heap_remove(list, event->heap_index);
+	if (list->nevents)
+		list->deadline = list->heap[0]->at_tick;
+}
+
+void event_dispatch_next(struct event_list *list) {
+	struct event *e = list->heap[0];
+	e->queued = 0;
+	heap_remove(list, 0);
+	if (list->nevents)
+		list->deadline = list->heap[0]->at_tick;
+	DELEGATE_CALL(e->delegate);
+	if (e->autofree) {
+		e->next = event_pool;
+		event_pool = e;
 	}
-	for (struct event **entry = list; *entry; entry = &((*entry)->next)) {
-		if ((*entry)->next == event) {
-			(*entry)->next = event->next;
-			return;
+}
+
+void event_list_clear(struct event_list *list) {
+	while (list->nevents) {
+		struct event *e = list->heap[--list->nevents];
+		e->queued = 0;
+		if (e->autofree) {
+			e->next = event_pool;
+			event_pool = e;
 		}
 	}
+	free(list->heap);
+	list->heap = NULL;
+	list->heap_size = 0;
+}
+
+void event_pool_free(void) {
+	while (event_pool) {
+		struct event *e = event_pool;
+		event_pool = e->next;
+		free(e);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Heap maintenance.  Events due on the same tick are ordered by sequence
+// number, which preserves the guarantee that they run in the order they were
+// queued.
+
+static _Bool event_before(struct event *e0, struct event *e1) {
+	int dt = event_tick_delta(e0->at_tick, e1->at_tick);
+	if (dt != 0)
+		return dt < 0;
+	return (int32_t)(e0->seq - e1->seq) < 0;
+}
+
+static void heap_set(struct event_list *list, unsigned i, struct event *e) {
+	list->heap[i] = e;
+	e->heap_index = i;
+}
+
+static void heap_sift_up(struct event_list *list, unsigned i) {
+	struct event *e = list->heap[i];
+	while (i > 0) {
+		unsigned parent = (i - 1) >> 1;
+		if (!event_before(e, list->heap[parent]))
+			break;
+		heap_set(list, i, list->heap[parent]);
+		i = parent;
+	}
+	heap_set(list, i, e);
+}
+
+static void heap_sift_down(struct event_list *list, unsigned i) {
+	struct event *e = list->heap[i];
+	unsigned n = list->nevents;
+	for (;;) {
+		unsigned child = (i << 1) + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && event_before(list->heap[child + 1], list->heap[child]))
+			child++;
+		if (!event_before(list->heap[child], e))
+			break;
+		heap_set(list, i, list->heap[child]);
+		i = child;
+	}
+	heap_set(list, i, e);
+}
+
+static void heap_remove(struct event_list *list, unsigned i) {
+	unsigned last = --list->nevents;
+	if (i == last)
+		return;
+	heap_set(list, i, list->heap[last]);
+	if (i > 0 && event_before(list->heap[i], list->heap[(i - 1) >> 1])) {
+		heap_sift_up(list, i);
+	} else {
+		heap_sift_down(list, i);
+	}
 }
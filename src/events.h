@@ -2,7 +2,7 @@
  *
  *  \brief Event scheduling & dispatch.
  *
- *  \copyright Copyright 2005-2022 Ciaran Anscomb
+ *  \copyright Copyright 2005-2024 Ciaran Anscomb
  *
  *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
  *
@@ -37,18 +37,44 @@ typedef uint32_t event_ticks;
 #define EVENT_US(us) ((EVENT_TICK_RATE * (us)) / 1000000)
 #define EVENT_TICKS_14M31818(t) (t)
 
-/* Current "time". */
-extern event_ticks event_current_tick;
+// Current "time".  Private to each thread, as is the pool of autofree events:
+// each thread may run its own emulator instance.
+extern VAR_ATTR_THREAD_LOCAL event_ticks event_current_tick;
+
+struct event_list;
 
 struct event {
 	event_ticks at_tick;
 	DELEGATE_T0(void) delegate;
 	_Bool queued;
 	_Bool autofree;
-	struct event **list;
+	struct event_list *list;
+	// Position within list's heap while queued.
+	unsigned heap_index;
+	// Insertion order, used to break ties between events due on the same
+	// tick.
+	uint32_t seq;
+	// Not used for queueing.  Links the free list of autofree events, and
+	// when deserialising, is set to point to the event itself to flag to
+	// the reader that it should be queued.  Cleared by event_queue().
 	struct event *next;
 };
 
+// A list of queued events, held as a binary min-heap ordered by tick, then by
+// insertion order.  The tick of the event at the root of the heap is cached
+// in 'deadline', so testing whether anything is due is a single comparison
+// against event_current_tick, and nothing else need be touched until that
+// time arrives.  If the list is empty, the deadline is meaningless, but must
+// still be checked against 'nevents'.
+
+struct event_list {
+	event_ticks deadline;
+	unsigned nevents;
+	unsigned heap_size;
+	struct event **heap;
+	uint32_t next_seq;
+};
+
 struct event *event_new(DELEGATE_T0(void));
 void event_init(struct event *event, DELEGATE_T0(void));
 
@@ -56,12 +82,23 @@ void event_init(struct event *event, DELEGATE_T0(void));
  * order of their being added to queue */
 
 void event_free(struct event *event);
-void event_queue(struct event **list, struct event *event);
+void event_queue(struct event_list *list, struct event *event);
 void event_dequeue(struct event *event);
 
 // Allocate an event and queue it, flagged to autofree.  Event will be
-// scheduled for current time + dt.
-void event_queue_auto(struct event **list, DELEGATE_T0(void), int dt);
+// scheduled for current time + dt.  Autofree events are recycled through a
+// free list rather than returned to the system.
+void event_queue_auto(struct event_list *list, DELEGATE_T0(void), int dt);
+
+// Remove the next event from the list and call its delegate.
+void event_dispatch_next(struct event_list *list);
+
+// Dequeue every event in a list and release the list's storage.  Autofree
+// events go back to the free list; others still belong to whoever queued them.
+void event_list_clear(struct event_list *list);
+
+// Free the calling thread's pool of unused autofree events.
+void event_pool_free(void);
 
 #define event_queued(e) ((e)->queued)
 
@@ -74,20 +111,11 @@ inline int event_tick_delta(event_ticks t0, event_ticks t1) {
 	return *(int32_t *)&dt;
 }
 
-inline _Bool event_pending(struct event **list) {
-	return *list && event_tick_delta(event_current_tick, (*list)->at_tick) >= 0;
-}
-
-inline void event_dispatch_next(struct event **list) {
-	struct event *e = *list;
-	*list = e->next;
-	e->queued = 0;
-	DELEGATE_CALL(e->delegate);
-	if (e->autofree)
-		free(e);
+inline _Bool event_pending(struct event_list *list) {
+	return event_tick_delta(event_current_tick, list->deadline) >= 0 && list->nevents;
 }
 
-inline void event_run_queue(struct event **list) {
+inline void event_run_queue(struct event_list *list) {
 	while (event_pending(list))
 		event_dispatch_next(list);
 }
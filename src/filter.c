@@ -193,6 +193,105 @@ static double complex eval(const double complex *coeffs, int npz, double complex
 
 extern inline float filter_iir_apply(struct filter_iir *filter, float value);
 
+// Filter history is held in locals where it fits
+#define FILTER_IIR_MAX_LOCAL (8)
+
+float filter_iir_apply_n(struct filter_iir *filter, float value, unsigned n, float *out) {
+	int nz = filter->nz;
+	int np = filter->np;
+	if (nz > FILTER_IIR_MAX_LOCAL || np > FILTER_IIR_MAX_LOCAL) {
+		for (; n; n--) {
+			float output = filter_iir_apply(filter, value);
+			if (out)
+				*(out++) = output;
+		}
+		return filter->output;
+	}
+
+	float zv[FILTER_IIR_MAX_LOCAL];
+	float pv[FILTER_IIR_MAX_LOCAL];
+	for (int i = 0; i < nz; i++)
+		zv[i] = filter->zv[i];
+	for (int i = 0; i < np; i++)
+		pv[i] = filter->pv[i];
+
+	float v = value / filter->dc_gain;
+	float output = filter->output;
+
+	// Until the new value has filled the zero history, this is just
+	// filter_iir_apply().  Callers will often be continuing a previous
+	// run, in which case it's already full.
+	int nfill = 0;
+	for (int i = 0; i < nz; i++) {
+		if (zv[i] != v) {
+			nfill = nz;
+			break;
+		}
+	}
+	for (; n && nfill; n--, nfill--) {
+		for (int i = 0; i < nz-1; i++)
+			zv[i] = zv[i+1];
+		zv[nz-1] = v;
+		for (int i = 0; i < np-1; i++)
+			pv[i] = pv[i+1];
+		pv[np-1] = output;
+
+		float sum = 0.0;
+		for (int i = 0; i < nz; i++)
+			sum += filter->z[i] * zv[i];
+		for (int i = 0; i < np; i++)
+			sum += filter->p[i] * pv[i];
+		output = sum;
+		if (out)
+			*(out++) = output;
+	}
+
+	// After that, the zeroes contribute a constant.  It's summed in the
+	// same order, so the result is identical.
+	if (n) {
+		float zsum = 0.0;
+		for (int i = 0; i < nz; i++)
+			zsum += filter->z[i] * v;
+		if (np == 3) {
+			// Third order (as used by the sound chips) gets to keep
+			// everything in registers
+			float p0 = filter->p[0], p1 = filter->p[1], p2 = filter->p[2];
+			float pv0 = pv[0], pv1 = pv[1], pv2 = pv[2];
+			for (; n; n--) {
+				pv0 = pv1;
+				pv1 = pv2;
+				pv2 = output;
+				output = zsum + p0 * pv0 + p1 * pv1 + p2 * pv2;
+				if (out)
+					*(out++) = output;
+			}
+			pv[0] = pv0;
+			pv[1] = pv1;
+			pv[2] = pv2;
+		} else {
+			for (; n; n--) {
+				for (int i = 0; i < np-1; i++)
+					pv[i] = pv[i+1];
+				pv[np-1] = output;
+
+				float sum = zsum;
+				for (int i = 0; i < np; i++)
+					sum += filter->p[i] * pv[i];
+				output = sum;
+				if (out)
+					*(out++) = output;
+			}
+		}
+	}
+
+	for (int i = 0; i < nz; i++)
+		filter->zv[i] = zv[i];
+	for (int i = 0; i < np; i++)
+		filter->pv[i] = pv[i];
+	filter->output = output;
+	return output;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 // FIR filters
@@ -65,6 +65,12 @@ inline float filter_iir_apply(struct filter_iir *filter, float value) {
 	return output;
 }
 
+// Equivalent to calling filter_iir_apply() 'n' times with the same value, but
+// considerably cheaper.  If 'out' is not NULL, each output is written to it.
+// Returns the final output.
+
+float filter_iir_apply_n(struct filter_iir *filter, float value, unsigned n, float *out);
+
 // FIR filters
 
 // This is only being added to support experimental code, and for now we're
@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -290,6 +291,53 @@ int32_t fs_read_vint32(FILE *fd, int *nread) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// Stream for data written to "-", once stdout has been reserved
+
+static FILE *fs_stdout = NULL;
+
+void fs_reserve_stdout(void) {
+	if (fs_stdout)
+		return;
+	fflush(stdout);
+	fs_stdout = stdout;
+	int fd = dup(fileno(stdout));
+	if (fd < 0)
+		return;
+	FILE *f = fdopen(fd, "wb");
+	if (!f) {
+		close(fd);
+		return;
+	}
+	// Everything else printed to stdout now goes to stderr
+	if (dup2(fileno(stderr), fileno(stdout)) < 0) {
+		fclose(f);
+		return;
+	}
+	fs_stdout = f;
+}
+
+FILE *fs_open_output(const char *filename) {
+	if (strcmp(filename, "-") == 0) {
+		fs_reserve_stdout();
+		return fs_stdout;
+	}
+	return fopen(filename, "wb");
+}
+
+void fs_close_output(FILE *fd) {
+	if (fs_output_is_stdout(fd)) {
+		fflush(fd);
+	} else {
+		fclose(fd);
+	}
+}
+
+_Bool fs_output_is_stdout(FILE *fd) {
+	return fd && (fd == stdout || fd == fs_stdout);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 char *fs_getcwd(void) {
 	size_t buflen = 4096;
 	char *buf = xmalloc(buflen);
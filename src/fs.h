@@ -80,6 +80,25 @@ int32_t fs_read_vint32(FILE *fd, int *nread);
  * numbers and moving sign to bit0 for more efficient encoding.
  */
 
+// Reserve stdout for binary output.  The original stdout is kept for files
+// named "-", and anything else printed to stdout (i.e., log messages) is sent
+// to stderr instead.  Call before anything is logged.
+
+void fs_reserve_stdout(void);
+
+// Open a file for binary output, or return stdout if filename is "-".  errno
+// set if appropriate.
+
+FILE *fs_open_output(const char *filename);
+
+// Close a file opened with fs_open_output().  stdout is only flushed.
+
+void fs_close_output(FILE *fd);
+
+// True if file is the stream fs_open_output() returns for "-".
+
+_Bool fs_output_is_stdout(FILE *fd);
+
 // Wrap getcwd(), automatically allocating a buffer.  May still return NULL for
 // other reasons, so check errno (check getcwd manpage).
 char *fs_getcwd(void);
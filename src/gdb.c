@@ -117,6 +117,9 @@ struct gdb_interface_private {
 	struct MC6883 *sam;
 	_Bool is_6309;
 
+	// The machine's clock lives in the thread that runs it
+	event_ticks *clock;
+
 	// Breakpoint session
 	struct bp_session *bp_session;
 
@@ -148,8 +151,8 @@ enum gdb_error {
 	GDBE_WRITE_ERROR,
 };
 
-static char in_packet[1025];
-static char packet[1025];
+static VAR_ATTR_THREAD_LOCAL char in_packet[1025];
+static VAR_ATTR_THREAD_LOCAL char packet[1025];
 
 static int read_packet(struct gdb_interface_private *gip, char *buffer, unsigned count);
 static int send_packet(struct gdb_interface_private *gip, const char *buffer, unsigned count);
@@ -197,6 +200,7 @@ struct gdb_interface *gdb_interface_new(const char *hostname, const char *portna
 	gip->cpu = cpu;
 	gip->sam = sam;
 	gip->bp_session = bp_session;
+	gip->clock = &event_current_tick;
 	gip->run_state = gdb_run_state_running;
 
 	gip->is_6309 = (strcmp(((struct part *)cpu)->partdb->name, "HD6309") == 0);
@@ -883,7 +887,7 @@ static int qRcmd(struct gdb_interface_private *gip, char *args) {
 	char reply[255];
 	*reply = '\0';
 	if (0 == strcmp(cmd, "cycles")) {
-		sprintf(reply, "%u cycles %s\n", (uint32_t) event_current_tick / 16, args);
+		sprintf(reply, "%u cycles %s\n", (uint32_t) *gip->clock / 16, args);
 	} else if (0 == strcmp(cmd, "trace")) {
 		logging.trace_cpu = atoi(args);
 	} else {
@@ -109,6 +109,7 @@ static struct part *gmc_allocate(void) {
 	c->reset = gmc_reset;
 	c->has_interface = gmc_has_interface;
 	c->attach_interface = gmc_attach_interface;
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
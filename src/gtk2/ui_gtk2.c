@@ -498,8 +498,8 @@ static void *ui_gtk2_new(void *cfg) {
 	gtk2_update_cartridge_menu(uigtk2);
 	uigtk2_update_radio_menu_from_enum(uigtk2->keymap_radio_menu, machine_keyboard_list, "machine-keyboard-%s", NULL, 0);
 	gtk2_update_joystick_menus(uigtk2);
-	uigtk2_update_radio_menu_from_enum(uigtk2->hkbd_layout_radio_menu, hkbd_layout_list, "hkbd-layout-%s", NULL, xroar.cfg.kbd.layout);
-	uigtk2_update_radio_menu_from_enum(uigtk2->hkbd_lang_radio_menu, hkbd_lang_list, "hkbd-lang-%s", NULL, xroar.cfg.kbd.lang);
+	uigtk2_update_radio_menu_from_enum(uigtk2->hkbd_layout_radio_menu, hkbd_layout_list, "hkbd-layout-%s", NULL, xroar_cfg.kbd.layout);
+	uigtk2_update_radio_menu_from_enum(uigtk2->hkbd_lang_radio_menu, hkbd_lang_list, "hkbd-lang-%s", NULL, xroar_cfg.kbd.lang);
 
 	/* Extract menubar widget and add to vbox */
 	uigtk2->menubar = gtk_ui_manager_get_widget(uigtk2->menu_manager, "/MainMenu");
@@ -673,6 +673,18 @@ static void ui_gtk2_update_state(void *sptr, int tag, int value, const void *dat
 		uigtk2_notify_radio_menu_set_current_value(uigtk2->tv_input_radio_menu, value);
 		break;
 
+	case ui_tag_frame_rate:
+		{
+			char title[32];
+			if (value > 0) {
+				snprintf(title, sizeof(title), "XRoar (%d fps)", value);
+			} else {
+				snprintf(title, sizeof(title), "XRoar");
+			}
+			gtk_window_set_title(GTK_WINDOW(uigtk2->top_window), title);
+		}
+		break;
+
 	case ui_tag_brightness:
 		gtk2_vo_update_brightness(uigtk2, value);
 		break;
@@ -512,8 +512,8 @@ static void *ui_gtk3_new(void *cfg) {
 	gtk3_update_cartridge_menu(uigtk3);
 	uigtk3_update_radio_menu_from_enum(uigtk3->keymap_radio_menu, machine_keyboard_list, "machine-keyboard-%s", NULL, 0);
 	gtk3_update_joystick_menus(uigtk3);
-	uigtk3_update_radio_menu_from_enum(uigtk3->hkbd_layout_radio_menu, hkbd_layout_list, "hkbd-layout-%s", NULL, xroar.cfg.kbd.layout);
-	uigtk3_update_radio_menu_from_enum(uigtk3->hkbd_lang_radio_menu, hkbd_lang_list, "hkbd-lang-%s", NULL, xroar.cfg.kbd.lang);
+	uigtk3_update_radio_menu_from_enum(uigtk3->hkbd_layout_radio_menu, hkbd_layout_list, "hkbd-layout-%s", NULL, xroar_cfg.kbd.layout);
+	uigtk3_update_radio_menu_from_enum(uigtk3->hkbd_lang_radio_menu, hkbd_lang_list, "hkbd-lang-%s", NULL, xroar_cfg.kbd.lang);
 
 	// Extract menubar widget and add to vbox
 	uigtk3->menubar = gtk_ui_manager_get_widget(uigtk3->menu_manager, "/MainMenu");
@@ -670,6 +670,18 @@ static void ui_gtk3_update_state(void *sptr, int tag, int value, const void *dat
 		uigtk3_notify_radio_menu_set_current_value(uigtk3->tv_input_radio_menu, value);
 		break;
 
+	case ui_tag_frame_rate:
+		{
+			char title[32];
+			if (value > 0) {
+				snprintf(title, sizeof(title), "XRoar (%d fps)", value);
+			} else {
+				snprintf(title, sizeof(title), "XRoar");
+			}
+			gtk_window_set_title(GTK_WINDOW(uigtk3->top_window), title);
+		}
+		break;
+
 	case ui_tag_gain:
 	case ui_tag_brightness:
 	case ui_tag_contrast:
@@ -1132,7 +1132,7 @@ void hk_update_keymap(void) {
 		hkbd.scancode_mod[c] = 0;
 	}
 
-	hkbd.layout = xroar.cfg.kbd.layout;
+	hkbd.layout = xroar_cfg.kbd.layout;
 
 	if (os_scancode_to_hk_scancode) {
 		free(os_scancode_to_hk_scancode);
@@ -1148,7 +1148,7 @@ void hk_update_keymap(void) {
 #elif defined(HAVE_COCOA)
 	have_keymap = have_keymap || hk_darwin_update_keymap();
 #endif
-	if (xroar.cfg.kbd.lang != hk_lang_auto) {
+	if (xroar_cfg.kbd.lang != hk_lang_auto) {
 		have_keymap = 0;
 	}
 	have_keymap = have_keymap || hk_default_update_keymap();
@@ -1201,7 +1201,7 @@ void hk_update_keymap(void) {
 	}
 
 	// Apply user-supplied binds:
-	for (struct slist *iter = xroar.cfg.kbd.bind_list; iter; iter = iter->next) {
+	for (struct slist *iter = xroar_cfg.kbd.bind_list; iter; iter = iter->next) {
 		struct dkbd_bind *bind = (struct dkbd_bind *)iter->data;
 		uint8_t code = hk_scancode_from_name(bind->hostkey);
 		if (code != hk_scan_None) {
@@ -1375,7 +1375,7 @@ void hk_scan_press(uint8_t code) {
 
 	// Translated mode.  The HK symbol is usually its Unicode value so most
 	// are used directly.  There are a few special supplementary cases.
-	if (xroar.cfg.kbd.translate) {
+	if (xroar_cfg.kbd.translate) {
 		unsigned unicode = sym;
 		if (shift && (sym == hk_sym_BackSpace || sym == hk_sym_Delete)) {
 			// shift + backspace -> erase line
@@ -1446,7 +1446,7 @@ void hk_scan_release(uint8_t code) {
 		break;
 	}
 
-	if (xroar.cfg.kbd.translate) {
+	if (xroar_cfg.kbd.translate) {
 		// Use the last recorded Unicode value for this scancode
 		unsigned unicode = hkbd.scancode_pressed_unicode[code];
 		keyboard_unicode_release(xroar.keyboard_interface, unicode);
@@ -1476,7 +1476,7 @@ static _Bool hk_default_update_keymap(void) {
 		hkbd.scancode_mod[c] = 0;
 	}
 
-	unsigned lang = (unsigned)xroar.cfg.kbd.lang;
+	unsigned lang = (unsigned)xroar_cfg.kbd.lang;
 	if (hkbd.layout == hk_layout_auto) {
 		// Japanese -> JIS, else ANSI
 		hkbd.layout = lang == hk_lang_jp ? hk_layout_jis : hk_layout_ansi;
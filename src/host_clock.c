@@ -0,0 +1,63 @@
+/** \file
+ *
+ *  \brief Host wall clock.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ */
+
+#include "top-config.h"
+
+#ifndef HAVE_SDL2
+// for struct timespec, gettimeofday, nanosleep
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdint.h>
+
+#ifdef HAVE_SDL2
+#include <SDL.h>
+#else
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#include "host_clock.h"
+
+uint64_t host_clock_us(void) {
+#ifdef HAVE_SDL2
+	Uint64 count = SDL_GetPerformanceCounter();
+	Uint64 freq = SDL_GetPerformanceFrequency();
+	return (count / freq) * 1000000 + ((count % freq) * 1000000) / freq;
+#else
+	struct timeval tp;
+	gettimeofday(&tp, NULL);
+	return (uint64_t)tp.tv_sec * 1000000 + tp.tv_usec;
+#endif
+}
+
+void host_clock_sleep_us(unsigned us) {
+#ifdef HAVE_SDL2
+	SDL_Delay(us / 1000);
+#else
+	struct timespec elapsed, tv;
+	elapsed.tv_sec = us / 1000000;
+	elapsed.tv_nsec = (us % 1000000) * 1000;
+	do {
+		errno = 0;
+		tv.tv_sec = elapsed.tv_sec;
+		tv.tv_nsec = elapsed.tv_nsec;
+	} while (nanosleep(&tv, &elapsed) && errno == EINTR);
+#endif
+}
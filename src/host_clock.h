@@ -0,0 +1,36 @@
+/** \file
+ *
+ *  \brief Host wall clock.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Used to pace emulation against real time.  With SDL2 available, its timer
+ *  is used, otherwise gettimeofday() and nanosleep().
+ */
+
+#ifndef XROAR_HOST_CLOCK_H_
+#define XROAR_HOST_CLOCK_H_
+
+#include <stdint.h>
+
+// Current host time in microseconds.  Only differences are meaningful.
+
+uint64_t host_clock_us(void);
+
+// Sleep for at least 'us' microseconds.  With SDL2, resolution is 1ms, and
+// shorter sleeps may return immediately.
+
+void host_clock_sleep_us(unsigned us);
+
+#endif
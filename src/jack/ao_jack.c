@@ -2,7 +2,7 @@
  *
  *  \brief JACK sound module.
  *
- *  \copyright Copyright 2003-2016 Ciaran Anscomb
+ *  \copyright Copyright 2003-2024 Ciaran Anscomb
  *
  *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
  *
@@ -15,24 +15,19 @@
  *
  *  \endlicenseblock
  *
- *  Currently only nfragments == 1 is supported.  The architecture of JACK is
- *  sufficiently different that new code will be needed to properly support
- *  stereo, so nchannels == 1 too.
+ *  Mixed audio is queued in the common audio ring (see ao.h), and the JACK
+ *  process callback reads from it without ever waiting on the emulation.
+ *  The ring targets one period more than the configured number of fragments.
+ *
+ *  The architecture of JACK is sufficiently different that new code will be
+ *  needed to properly support stereo, so nchannels == 1.
  */
 
 #include "top-config.h"
 
-// for struct timespec, gettimeofday
-#define _POSIX_C_SOURCE 200112L
-
-#include <errno.h>
-#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#include <unistd.h>
-#include <sys/time.h>
 
 #include <jack/jack.h>
 
@@ -57,18 +52,11 @@ struct ao_jack_interface {
 	jack_client_t *client;
 	jack_port_t *output_port;
 
-	float *callback_buffer;
-	_Bool shutting_down;
-
 	unsigned nfragments;
+	unsigned fragment_nframes;
 
-	pthread_mutex_t fragment_mutex;
-	pthread_cond_t fragment_cv;
+	struct ao_ring *ring;
 	float *fragment_buffer;
-	unsigned fragment_queue_length;
-	unsigned write_fragment;
-
-	unsigned timeout_us;
 };
 
 static int callback_1(jack_nframes_t nframes, void *arg);
@@ -92,7 +80,29 @@ static void *new(void *cfg) {
 	}
 
 	unsigned buffer_nframes;
-	enum sound_fmt sample_fmt = SOUND_FMT_FLOAT;
+	jack_nframes_t rate = jack_get_sample_rate(aojack->client);
+	jack_nframes_t fragment_nframes = jack_get_buffer_size(aojack->client);
+
+	aojack->nfragments = 1;
+	if (xroar_cfg.ao.fragments > 0 && xroar_cfg.ao.fragments <= 64)
+		aojack->nfragments = xroar_cfg.ao.fragments;
+
+	buffer_nframes = fragment_nframes * aojack->nfragments;
+	aojack->fragment_nframes = fragment_nframes;
+
+	// Create the ring before activating the client, as the process
+	// callback reads from it
+	aojack->ring = ao_ring_new(1, rate, buffer_nframes + fragment_nframes);
+	aojack->fragment_buffer = xmalloc(fragment_nframes * sizeof(float));
+	memset(aojack->fragment_buffer, 0, fragment_nframes * sizeof(float));
+
+	ao->sound_interface = sound_interface_new(aojack->fragment_buffer, SOUND_FMT_FLOAT, rate, 1, fragment_nframes);
+	if (!aojack->ring || !ao->sound_interface) {
+		LOG_ERROR("Failed to initialise JACK: XRoar internal error\n");
+		jack_client_close(aojack->client);
+		goto failed;
+	}
+	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_jack_write_buffer, ao);
 
 	jack_set_process_callback(aojack->client, callback_1, aojack);
 	aojack->output_port = jack_port_register(aojack->client, "output0", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
@@ -116,39 +126,17 @@ static void *new(void *cfg) {
 		}
 	}
 	free(ports);
-	jack_nframes_t rate = jack_get_sample_rate(aojack->client);
-	jack_nframes_t fragment_nframes = jack_get_buffer_size(aojack->client);
-
-	aojack->nfragments = 1;
-	if (xroar.cfg.ao.fragments > 0 && xroar.cfg.ao.fragments <= 64)
-		aojack->nfragments = xroar.cfg.ao.fragments;
-
-	aojack->timeout_us = (fragment_nframes * 1500000) / rate;
-
-	buffer_nframes = fragment_nframes * aojack->nfragments;
 
-	pthread_mutex_init(&aojack->fragment_mutex, NULL);
-	pthread_cond_init(&aojack->fragment_cv, NULL);
-
-	aojack->shutting_down = 0;
-	aojack->fragment_queue_length = 0;
-	aojack->write_fragment = 0;
-	aojack->callback_buffer = NULL;
-
-	aojack->fragment_buffer = NULL;
-
-	ao->sound_interface = sound_interface_new(aojack->fragment_buffer, sample_fmt, rate, 1, fragment_nframes);
-	if (!ao->sound_interface) {
-		LOG_ERROR("Failed to initialise JACK: XRoar internal error\n");
-		goto failed;
-	}
-	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_jack_write_buffer, ao);
 	LOG_DEBUG(1, "\t%u frags * %u frames/frag = %u frames buffer (%.1fms)\n", aojack->nfragments, fragment_nframes, buffer_nframes, (float)(buffer_nframes * 1000) / rate);
 
 	return aojack;
 
 failed:
 	if (aojack) {
+		if (ao->sound_interface)
+			sound_interface_free(ao->sound_interface);
+		ao_ring_free(aojack->ring);
+		free(aojack->fragment_buffer);
 		free(aojack);
 	}
 	return NULL;
@@ -157,81 +145,26 @@ failed:
 static void ao_jack_free(void *sptr) {
 	struct ao_jack_interface *aojack = sptr;
 
-	aojack->shutting_down = 1;
-
-	// unblock audio thread
-	pthread_mutex_lock(&aojack->fragment_mutex);
-	aojack->fragment_queue_length = 1;
-	pthread_cond_signal(&aojack->fragment_cv);
-	pthread_mutex_unlock(&aojack->fragment_mutex);
-
+	// Closing the client stops the process callback
 	if (aojack->client)
 		jack_client_close(aojack->client);
 	aojack->client = NULL;
 
-	pthread_cond_destroy(&aojack->fragment_cv);
-	pthread_mutex_destroy(&aojack->fragment_mutex);
 	sound_interface_free(aojack->public.sound_interface);
+	ao_ring_free(aojack->ring);
+	free(aojack->fragment_buffer);
 	free(aojack);
 }
 
 static void *ao_jack_write_buffer(void *sptr, void *buffer) {
 	struct ao_jack_interface *aojack = sptr;
-
-	pthread_mutex_lock(&aojack->fragment_mutex);
-
-	if (buffer) {
-		aojack->write_fragment = (aojack->write_fragment + 1) % aojack->nfragments;
-		aojack->fragment_queue_length++;
-		pthread_cond_signal(&aojack->fragment_cv);
-	}
-
-	if (!aojack->public.sound_interface->ratelimit) {
-		pthread_mutex_unlock(&aojack->fragment_mutex);
-		return NULL;
-	}
-
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
-	tv.tv_usec += aojack->timeout_us;
-	tv.tv_sec += (tv.tv_usec / 1000000);
-	tv.tv_usec %= 1000000;
-	struct timespec ts;
-	ts.tv_sec = tv.tv_sec;
-	ts.tv_nsec = tv.tv_usec * 1000;
-
-	// for nfragments == 1, wait for callback to send buffer
-	while (aojack->callback_buffer == NULL) {
-		if (pthread_cond_timedwait(&aojack->fragment_cv, &aojack->fragment_mutex, &ts) == ETIMEDOUT) {
-			pthread_mutex_unlock(&aojack->fragment_mutex);
-			return NULL;
-		}
-	}
-	aojack->fragment_buffer = aojack->callback_buffer;
-	aojack->callback_buffer = NULL;
-
-	pthread_mutex_unlock(&aojack->fragment_mutex);
-	return aojack->fragment_buffer;;
+	ao_ring_write(aojack->ring, buffer, aojack->fragment_nframes, aojack->public.sound_interface->ratelimit);
+	return buffer;
 }
 
 static int callback_1(jack_nframes_t nframes, void *arg) {
 	struct ao_jack_interface *aojack = arg;
-
-	if (aojack->shutting_down)
-		return -1;
-	pthread_mutex_lock(&aojack->fragment_mutex);
-
-	// pass callback buffer to main thread
-	aojack->callback_buffer = (float *)jack_port_get_buffer(aojack->output_port, nframes);
-	pthread_cond_signal(&aojack->fragment_cv);
-
-	// wait until main thread signals filled buffer
-	while (aojack->fragment_queue_length == 0)
-		pthread_cond_wait(&aojack->fragment_cv, &aojack->fragment_mutex);
-
-	// set to 0 so next callback will wait
-	aojack->fragment_queue_length = 0;
-
-	pthread_mutex_unlock(&aojack->fragment_mutex);
+	float *output = jack_port_get_buffer(aojack->output_port, nframes);
+	ao_ring_read(aojack->ring, output, SOUND_FMT_FLOAT, nframes);
 	return 0;
 }
@@ -60,9 +60,9 @@ static struct slist *config_list = NULL;
 static unsigned next_id = 0;
 
 // Current configuration, per-port:
-struct joystick_config const *joystick_port_config[JOYSTICK_NUM_PORTS];
+VAR_ATTR_THREAD_LOCAL struct joystick_config const *joystick_port_config[JOYSTICK_NUM_PORTS];
 
-static struct joystick_submodule *selected_interface = NULL;
+static VAR_ATTR_THREAD_LOCAL struct joystick_submodule *selected_interface = NULL;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -71,12 +71,12 @@ struct joystick {
 	struct joystick_button *buttons[JOYSTICK_NUM_BUTTONS];
 };
 
-static struct joystick *joystick_port[JOYSTICK_NUM_PORTS];
+static VAR_ATTR_THREAD_LOCAL struct joystick *joystick_port[JOYSTICK_NUM_PORTS];
 
 // Support the swap/cycle shortcuts:
-static struct joystick_config const *virtual_joystick_config;
-static struct joystick const *virtual_joystick = NULL;
-static struct joystick_config const *cycled_config = NULL;
+static VAR_ATTR_THREAD_LOCAL struct joystick_config const *virtual_joystick_config;
+static VAR_ATTR_THREAD_LOCAL struct joystick const *virtual_joystick = NULL;
+static VAR_ATTR_THREAD_LOCAL struct joystick_config const *cycled_config = NULL;
 
 static void joystick_config_free(struct joystick_config *jc);
 
@@ -97,8 +97,6 @@ void joystick_shutdown(void) {
 	for (unsigned p = 0; p < JOYSTICK_NUM_PORTS; p++) {
 		joystick_unmap(p);
 	}
-	slist_free_full(config_list, (slist_free_func)joystick_config_free);
-	config_list = NULL;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -188,6 +186,11 @@ _Bool joystick_config_remove(const char *name) {
 	return 1;
 }
 
+void joystick_config_remove_all(void) {
+	slist_free_full(config_list, (slist_free_func)joystick_config_free);
+	config_list = NULL;
+}
+
 struct slist *joystick_config_list(void) {
 	return config_list;
 }
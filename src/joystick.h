@@ -75,7 +75,7 @@ struct joystick_config {
 	char *button_specs[JOYSTICK_NUM_BUTTONS];
 };
 
-extern struct joystick_config const *joystick_port_config[JOYSTICK_NUM_PORTS];
+extern VAR_ATTR_THREAD_LOCAL struct joystick_config const *joystick_port_config[JOYSTICK_NUM_PORTS];
 extern struct joystick_module * const *ui_joystick_module_list;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -124,8 +124,12 @@ struct joystick_config *joystick_config_by_id(unsigned i);
 struct joystick_config *joystick_config_by_name(const char *name);
 void joystick_config_print_all(FILE *f, _Bool all);
 _Bool joystick_config_remove(const char *name);
+void joystick_config_remove_all(void);
 struct slist *joystick_config_list(void);
 
+// Port mappings are per-instance: joystick_shutdown() unmaps the calling
+// thread's ports, but leaves the (shared) configurations.
+
 void joystick_init(void);
 void joystick_shutdown(void);
 
@@ -0,0 +1,383 @@
+/** \file
+ *
+ *  \brief Embeddable emulator interface.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Provides a headless UI module with its own video and audio modules.  Video
+ *  is rendered into memory and copied out at each vertical sync.  Audio is
+ *  appended to a capture buffer for the caller to pull, and never blocks, so
+ *  the emulation runs only as fast as it is stepped.
+ */
+
+#include "top-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "delegate.h"
+#include "xalloc.h"
+
+#include "ao.h"
+#include "auto_kbd.h"
+#include "events.h"
+#include "keyboard.h"
+#include "libxroar.h"
+#include "logging.h"
+#include "machine.h"
+#include "module.h"
+#include "snapshot.h"
+#include "sound.h"
+#include "ui.h"
+#include "vo.h"
+#include "vo_render.h"
+#include "xroar.h"
+
+// Large enough for any viewport selectable with vo_set_viewport()
+#define MAX_VIEWPORT_WIDTH (800)
+#define MAX_VIEWPORT_HEIGHT (300)
+
+#define AUDIO_FRAGMENT_NFRAMES (1024)
+#define AUDIO_NCHANNELS (2)
+
+struct libxroar_interface {
+	struct ui_interface ui_interface;
+
+	struct {
+		// Rendered into by vo_render
+		uint32_t *pixels;
+		// Copied from above on vsync
+		uint32_t *frame;
+		int frame_w, frame_h;
+		unsigned frame_count;
+	} video;
+
+	struct {
+		unsigned rate;
+		// Handed to the sound module to fill
+		int16_t *fragment;
+		// Ring buffer of captured frames
+		int16_t *ring;
+		unsigned ring_nframes;
+		unsigned head;
+		unsigned count;
+	} audio;
+};
+
+// The instance belonging to the calling thread
+static VAR_ATTR_THREAD_LOCAL struct libxroar_interface *libxroar;
+
+// UI module
+
+extern struct module filereq_null_module;
+
+static struct module * const libxroar_filereq_module_list[] = {
+	&filereq_null_module, NULL
+};
+
+static void *ao_libxroar_new(void *cfg);
+
+static struct module ao_libxroar_module = {
+	.name = "libxroar", .description = "Audio capture",
+	.new = ao_libxroar_new,
+};
+
+static struct module * const libxroar_ao_module_list[] = {
+	&ao_libxroar_module, NULL
+};
+
+static void *ui_libxroar_new(void *cfg);
+
+static struct ui_module ui_libxroar_module = {
+	.common = { .name = "libxroar", .description = "Embedded", .new = ui_libxroar_new, },
+	.filereq_module_list = libxroar_filereq_module_list,
+	.ao_module_list = libxroar_ao_module_list,
+};
+
+static struct ui_module * const libxroar_ui_module_list[] = {
+	&ui_libxroar_module, NULL
+};
+
+static void ui_libxroar_free(void *sptr);
+static void ui_libxroar_update_state(void *sptr, int tag, int value, const void *data);
+
+static void vo_libxroar_free(void *sptr);
+static void vo_libxroar_set_viewport(void *sptr, int vp_w, int vp_h);
+static void vo_libxroar_draw(void *sptr);
+
+static void *ui_libxroar_new(void *cfg) {
+	struct ui_cfg *ui_cfg = cfg;
+	struct libxroar_interface *lx = xmalloc(sizeof(*lx));
+	*lx = (struct libxroar_interface){0};
+	struct ui_interface *ui = &lx->ui_interface;
+
+	ui->free = DELEGATE_AS0(void, ui_libxroar_free, lx);
+	ui->update_state = DELEGATE_AS3(void, int, int, cvoidp, ui_libxroar_update_state, lx);
+
+	struct vo_interface *vo = vo_interface_new(sizeof(*vo));
+	*vo = (struct vo_interface){0};
+	ui->vo_interface = vo;
+
+	struct vo_render *vr = vo_render_new(VO_RENDER_FMT_RGBA8);
+	vr->cmp.colour_killer = ui_cfg->vo_cfg.colour_killer;
+	vo_set_renderer(vo, vr);
+
+	size_t npixels = MAX_VIEWPORT_WIDTH * MAX_VIEWPORT_HEIGHT;
+	lx->video.pixels = xmalloc(npixels * sizeof(uint32_t));
+	lx->video.frame = xmalloc(npixels * sizeof(uint32_t));
+	memset(lx->video.pixels, 0, npixels * sizeof(uint32_t));
+	memset(lx->video.frame, 0, npixels * sizeof(uint32_t));
+	vo_render_set_buffer(vr, lx->video.pixels);
+
+	vo->free = DELEGATE_AS0(void, vo_libxroar_free, lx);
+	vo->set_viewport = DELEGATE_AS2(void, int, int, vo_libxroar_set_viewport, lx);
+	vo->draw = DELEGATE_AS0(void, vo_libxroar_draw, lx);
+
+	vo_set_viewport(vo, VO_PICTURE_TITLE);
+
+	libxroar = lx;
+	return lx;
+}
+
+static void ui_libxroar_free(void *sptr) {
+	struct libxroar_interface *lx = sptr;
+	if (lx == libxroar)
+		libxroar = NULL;
+	free(lx->audio.ring);
+	free(lx->audio.fragment);
+	free(lx->video.frame);
+	free(lx->video.pixels);
+	free(lx);
+}
+
+static void ui_libxroar_update_state(void *sptr, int tag, int value, const void *data) {
+	(void)sptr;
+	(void)tag;
+	(void)value;
+	(void)data;
+}
+
+// Video module
+
+static void vo_libxroar_free(void *sptr) {
+	struct libxroar_interface *lx = sptr;
+	struct vo_interface *vo = lx->ui_interface.vo_interface;
+	vo_render_free(vo->renderer);
+	free(vo);
+	lx->ui_interface.vo_interface = NULL;
+}
+
+static void vo_libxroar_set_viewport(void *sptr, int vp_w, int vp_h) {
+	struct libxroar_interface *lx = sptr;
+	struct vo_render *vr = lx->ui_interface.vo_interface->renderer;
+
+	if (vp_w > MAX_VIEWPORT_WIDTH)
+		vp_w = MAX_VIEWPORT_WIDTH;
+	if (vp_h > MAX_VIEWPORT_HEIGHT)
+		vp_h = MAX_VIEWPORT_HEIGHT;
+
+	vo_render_set_viewport(vr, vp_w, vp_h);
+	vr->buffer_pitch = vr->viewport.w;
+}
+
+static void vo_libxroar_draw(void *sptr) {
+	struct libxroar_interface *lx = sptr;
+	struct vo_render *vr = lx->ui_interface.vo_interface->renderer;
+
+	lx->video.frame_w = vr->viewport.w;
+	lx->video.frame_h = vr->viewport.h;
+	memcpy(lx->video.frame, lx->video.pixels, lx->video.frame_w * lx->video.frame_h * sizeof(uint32_t));
+	lx->video.frame_count++;
+}
+
+// Audio module
+
+static void ao_libxroar_free(void *sptr);
+static void *ao_libxroar_write_buffer(void *sptr, void *buffer);
+
+static void *ao_libxroar_new(void *cfg) {
+	(void)cfg;
+	struct libxroar_interface *lx = libxroar;
+	if (!lx)
+		return NULL;
+
+	struct ao_interface *ao = xmalloc(sizeof(*ao));
+	*ao = (struct ao_interface){0};
+
+	unsigned rate = (xroar_cfg.ao.rate > 0) ? xroar_cfg.ao.rate : 44100;
+	lx->audio.rate = rate;
+	lx->audio.fragment = xmalloc(AUDIO_FRAGMENT_NFRAMES * AUDIO_NCHANNELS * sizeof(int16_t));
+	// Keep up to a second of audio, but always at least two fragments, as
+	// each write adds a whole fragment
+	lx->audio.ring_nframes = rate;
+	if (lx->audio.ring_nframes < 2 * AUDIO_FRAGMENT_NFRAMES)
+		lx->audio.ring_nframes = 2 * AUDIO_FRAGMENT_NFRAMES;
+	lx->audio.ring = xmalloc(lx->audio.ring_nframes * AUDIO_NCHANNELS * sizeof(int16_t));
+
+	ao->free = DELEGATE_AS0(void, ao_libxroar_free, ao);
+	ao->sound_interface = sound_interface_new(lx->audio.fragment, SOUND_FMT_S16_HE, rate, AUDIO_NCHANNELS, AUDIO_FRAGMENT_NFRAMES);
+	if (!ao->sound_interface) {
+		free(ao);
+		return NULL;
+	}
+	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_libxroar_write_buffer, lx);
+	return ao;
+}
+
+static void ao_libxroar_free(void *sptr) {
+	struct ao_interface *ao = sptr;
+	sound_interface_free(ao->sound_interface);
+	free(ao);
+}
+
+static void *ao_libxroar_write_buffer(void *sptr, void *buffer) {
+	struct libxroar_interface *lx = sptr;
+	int16_t const *src = buffer;
+	unsigned nframes = AUDIO_FRAGMENT_NFRAMES;
+	unsigned size = lx->audio.ring_nframes;
+
+	// Drop oldest audio to make room
+	if (lx->audio.count + nframes > size) {
+		unsigned ndrop = lx->audio.count + nframes - size;
+		lx->audio.head = (lx->audio.head + ndrop) % size;
+		lx->audio.count -= ndrop;
+	}
+
+	unsigned tail = (lx->audio.head + lx->audio.count) % size;
+	while (nframes > 0) {
+		unsigned n = size - tail;
+		if (n > nframes)
+			n = nframes;
+		memcpy(lx->audio.ring + tail * AUDIO_NCHANNELS, src, n * AUDIO_NCHANNELS * sizeof(int16_t));
+		src += n * AUDIO_NCHANNELS;
+		lx->audio.count += n;
+		nframes -= n;
+		tail = 0;
+	}
+	return buffer;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Public interface
+
+_Bool libxroar_init(int argc, char **argv) {
+	if (libxroar) {
+		LOG_ERROR("libxroar: instance already running in this thread\n");
+		return 0;
+	}
+	ui_module_list = libxroar_ui_module_list;
+	if (!xroar_init(argc, argv) || !libxroar) {
+		xroar_shutdown();
+		return 0;
+	}
+	return 1;
+}
+
+void libxroar_shutdown(void) {
+	xroar_shutdown();
+}
+
+void libxroar_set_machine(struct machine_config *mc) {
+	if (!mc)
+		return;
+	xroar_set_machine(1, mc->id);
+}
+
+_Bool libxroar_set_machine_by_name(const char *name) {
+	struct machine_config *mc = machine_config_by_name(name);
+	if (!mc)
+		return 0;
+	libxroar_set_machine(mc);
+	return 1;
+}
+
+void libxroar_load_file(const char *filename, _Bool autorun) {
+	xroar_load_file_by_type(filename, autorun);
+}
+
+void libxroar_run(int nticks) {
+	xroar_run(nticks);
+}
+
+void libxroar_run_frame(void) {
+	if (!libxroar)
+		return;
+	unsigned frame_count = libxroar->video.frame_count;
+	// Give up after a second's worth of emulation, in case video output
+	// has stopped for some reason (e.g. CPU halted with no clock).
+	for (int i = 0; i < 1000 && libxroar->video.frame_count == frame_count; i++) {
+		xroar_run(EVENT_MS(1));
+	}
+}
+
+unsigned libxroar_frame_count(void) {
+	return libxroar ? libxroar->video.frame_count : 0;
+}
+
+const uint32_t *libxroar_get_frame(int *w, int *h) {
+	if (!libxroar)
+		return NULL;
+	if (w)
+		*w = libxroar->video.frame_w;
+	if (h)
+		*h = libxroar->video.frame_h;
+	return libxroar->video.frame;
+}
+
+unsigned libxroar_audio_rate(void) {
+	return libxroar ? libxroar->audio.rate : 0;
+}
+
+unsigned libxroar_read_audio(int16_t *dest, unsigned maxframes) {
+	if (!libxroar)
+		return 0;
+	unsigned size = libxroar->audio.ring_nframes;
+	unsigned ncopied = 0;
+	while (ncopied < maxframes && libxroar->audio.count > 0) {
+		unsigned n = size - libxroar->audio.head;
+		if (n > libxroar->audio.count)
+			n = libxroar->audio.count;
+		if (n > maxframes - ncopied)
+			n = maxframes - ncopied;
+		memcpy(dest + ncopied * AUDIO_NCHANNELS, libxroar->audio.ring + libxroar->audio.head * AUDIO_NCHANNELS, n * AUDIO_NCHANNELS * sizeof(int16_t));
+		libxroar->audio.head = (libxroar->audio.head + n) % size;
+		libxroar->audio.count -= n;
+		ncopied += n;
+	}
+	return ncopied;
+}
+
+void libxroar_key_press(int dscan) {
+	if (xroar.keyboard_interface)
+		keyboard_press(xroar.keyboard_interface, dscan);
+}
+
+void libxroar_key_release(int dscan) {
+	if (xroar.keyboard_interface)
+		keyboard_release(xroar.keyboard_interface, dscan);
+}
+
+void libxroar_type(const char *str) {
+	if (xroar.auto_kbd && str)
+		ak_parse_type_string(xroar.auto_kbd, str);
+}
+
+_Bool libxroar_save_state(const char *filename) {
+	return write_snapshot(filename) == 0;
+}
+
+_Bool libxroar_load_state(const char *filename) {
+	return read_snapshot(filename) == 0;
+}
@@ -0,0 +1,105 @@
+/** \file
+ *
+ *  \brief Embeddable emulator interface.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Drives the emulator without a UI run loop.  The caller steps the machine
+ *  explicitly, then reads back video and audio.  Intended for test harnesses,
+ *  batch processing and anything else that wants to host the emulator.
+ *
+ *  Emulator state is per-thread, so one instance may run in each thread.
+ *
+ *  There is one configuration per process.  Options passed to the first
+ *  libxroar_init() are parsed into it, and every instance started while any
+ *  is still running shares it: those later calls must pass no options (argc
+ *  of 1), and fail otherwise.  Instances may then diverge through this API,
+ *  e.g. libxroar_set_machine_by_name() or libxroar_load_file().  The
+ *  configuration is released when the last instance shuts down, after which
+ *  the next libxroar_init() parses its options afresh.
+ *
+ *  libxroar_init() and libxroar_shutdown() must not be called concurrently
+ *  from different threads.
+ */
+
+#ifndef XROAR_LIBXROAR_H_
+#define XROAR_LIBXROAR_H_
+
+#include <stdint.h>
+
+struct machine_config;
+
+/// Initialise an instance in the calling thread.
+//
+// Arguments are processed as for the command line (argv[0] is ignored), but
+// the UI, video and audio modules are always the built-in headless ones.
+// While another instance is running, no arguments may be given (see above).
+// Returns false on failure.
+_Bool libxroar_init(int argc, char **argv);
+
+/// Shut down the calling thread's instance.
+void libxroar_shutdown(void);
+
+/// Replace the running machine, then reset it.
+void libxroar_set_machine(struct machine_config *mc);
+
+/// Replace the running machine with a named configuration.
+// Returns false if no such machine is known.
+_Bool libxroar_set_machine_by_name(const char *name);
+
+/// Load a file of any supported type, optionally autorunning it.
+void libxroar_load_file(const char *filename, _Bool autorun);
+
+/// Run the machine for (approximately) the specified number of ticks.
+// Ticks are those of the event scheduler (EVENT_TICK_RATE per second).
+void libxroar_run(int nticks);
+
+/// Run the machine until the next frame has been rendered.
+void libxroar_run_frame(void);
+
+/// Number of frames rendered so far.
+unsigned libxroar_frame_count(void);
+
+/// Most recently completed frame.
+//
+// Pixels are 32-bit in host byte order, red in the most significant byte and
+// alpha in the least (VO_RENDER_FMT_RGBA8).  Lines are packed with no
+// padding.  The returned pointer remains valid until the next call to
+// libxroar_run() or libxroar_run_frame().
+const uint32_t *libxroar_get_frame(int *w, int *h);
+
+/// Audio output sample rate.
+unsigned libxroar_audio_rate(void);
+
+/// Pull captured audio.
+//
+// Copies at most maxframes stereo frames of signed 16-bit host-endian samples
+// into dest, returning the number copied.  If audio is not pulled often
+// enough, the oldest samples are dropped.
+unsigned libxroar_read_audio(int16_t *dest, unsigned maxframes);
+
+/// Press or release a key, by Dragon scancode (DSCAN_* in dkbd.h).
+void libxroar_key_press(int dscan);
+void libxroar_key_release(int dscan);
+
+/// Queue text to be typed, as for the -type option.
+void libxroar_type(const char *str);
+
+/// Write a snapshot.  Returns false on failure.
+_Bool libxroar_save_state(const char *filename);
+
+/// Read a snapshot.  Returns false on failure.
+_Bool libxroar_load_state(const char *filename);
+
+#endif
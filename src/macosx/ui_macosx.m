@@ -1439,6 +1439,10 @@ static void cocoa_ui_update_state(void *sptr, int tag, int value, const void *da
 		current_ccr = TAG_CCR | value;
 		break;
 
+	case ui_tag_frame_rate:
+		ui_sdl_update_frame_rate(uisdl2, value);
+		break;
+
 	/* Keyboard */
 
 	case ui_tag_keymap:
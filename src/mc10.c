@@ -63,13 +63,11 @@ struct machine_mc10 {
 	struct ram *RAM1;
 
 	struct vo_interface *vo;
-	int frame;  // track frameskip
 	struct sound_interface *snd;
 
 	unsigned ram0_inhibit_bit;
 
 	_Bool inverted_text;
-	unsigned frameskip;
 	unsigned video_mode;
 	uint16_t video_attr;
 
@@ -193,7 +191,6 @@ static void mc10_mem_cycle(void *sptr, _Bool RnW, uint16_t A);
 
 static _Bool mc10_set_inverted_text(struct machine *m, int action);
 static void *mc10_get_interface(struct machine *m, const char *ifname);
-static void mc10_set_frameskip(struct machine *m, unsigned fskip);
 static void mc10_set_ratelimit(struct machine *m, _Bool ratelimit);
 
 static void mc10_print_byte(void *);
@@ -256,7 +253,6 @@ static struct part *mc10_allocate(void) {
 
 	m->set_inverted_text = mc10_set_inverted_text;
 	m->get_interface = mc10_get_interface;
-	m->set_frameskip = mc10_set_frameskip;
 	m->set_ratelimit = mc10_set_ratelimit;
 
 	m->keyboard.type = dkbd_layout_mc10;
@@ -384,7 +380,7 @@ static _Bool mc10_finish(struct part *p) {
 	// Report and check CRC (Microcolour BASIC)
 	rombank_report(mp->ROM0, "MicroColour BASIC");
 	mp->crc_bas = 0x11fda97e;  // MicroColour BASIC 1.0 (MC-10)
-	mp->has_bas = rombank_verify_crc(mp->ROM0, "MicroColour BASIC", -1, "@mc10_compat", xroar.cfg.force_crc_match, &mp->crc_bas);
+	mp->has_bas = rombank_verify_crc(mp->ROM0, "MicroColour BASIC", -1, "@mc10_compat", xroar_cfg.force_crc_match, &mp->crc_bas);
 
 	// RAM configuration
 	{
@@ -497,8 +493,8 @@ static _Bool mc10_finish(struct part *p) {
 
 #ifdef WANT_GDB_TARGET
 	// GDB
-	/* if (xroar.cfg.gdb) {
-		mp->gdb_interface = gdb_interface_new(xroar.cfg.gdb_ip, xroar.cfg.gdb_port, m, mmp>bp_session);
+	/* if (xroar_cfg.gdb) {
+		mp->gdb_interface = gdb_interface_new(xroar_cfg.gdb_ip, xroar_cfg.gdb_port, m, mmp>bp_session);
 	} */
 #endif
 
@@ -868,16 +864,14 @@ static void mc10_vdg_fs(void *sptr, _Bool level) {
 	struct machine_mc10 *mp = sptr;
 	if (level) {
 		sound_update(mp->snd);
-		mp->frame--;
-		if (mp->frame < 0)
-			mp->frame = mp->frameskip;
-		vo_vsync(mp->vo, mp->frame == 0);
+		vo_vsync(mp->vo);
+		mc6847_set_timing_only(mp->VDG, mp->vo->skip_render);
 	}
 }
 
 static void mc10_vdg_render_line(void *sptr, unsigned burst, unsigned npixels, uint8_t const *data) {
 	struct machine_mc10 *mp = sptr;
-	DELEGATE_CALL(mp->vo->render_line, burst, npixels, data);
+	DELEGATE_CALL(mp->vo->render_line, burst, npixels, mp->vo->skip_render ? NULL : data);
 }
 
 static void mc10_vdg_fetch_handler(void *sptr, uint16_t A, int nbytes, uint16_t *dest) {
@@ -938,11 +932,6 @@ static void mc10_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-static void mc10_set_frameskip(struct machine *m, unsigned fskip) {
-	struct machine_mc10 *mp = (struct machine_mc10 *)m;
-	mp->frameskip = fskip;
-}
-
 static void mc10_set_ratelimit(struct machine *m, _Bool ratelimit) {
 	struct machine_mc10 *mp = (struct machine_mc10 *)m;
 	sound_set_ratelimit(mp->snd, ratelimit);
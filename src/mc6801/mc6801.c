@@ -340,6 +340,8 @@ static void mc6801_reset(struct MC6801 *cpu) {
 // Run CPU while cpu->running is true.
 
 static void mc6801_run(struct MC6801 *cpu) {
+	unsigned op;
+	OP_DISPATCH_INIT(cpu->op_dispatch, 0x100);
 
 	do {
 
@@ -367,32 +369,6 @@ static void mc6801_run(struct MC6801 *cpu) {
 			cpu->state = mc6801_state_label_a;
 			continue;
 
-		case mc6801_state_label_a:
-			if (cpu->nmi_active) {
-				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu);
-				peek_byte(cpu, REG_SP);
-				cpu->state = mc6801_state_dispatch_irq;
-				continue;
-			}
-			if (!(REG_CC & CC_I) && (cpu->irq1_active || cpu->irq2_active)) {
-				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu);
-				peek_byte(cpu, REG_SP);
-				cpu->state = mc6801_state_dispatch_irq;
-				continue;
-			}
-			REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
-			cpu->state = mc6801_state_next_instruction;
-			// Instruction fetch hook called here so that machine
-			// can be stopped beforehand.
-			DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
-			continue;
-
 		case mc6801_state_wai:
 			peek_byte(cpu, REG_SP);
 			if (cpu->nmi_active) {
@@ -443,39 +419,75 @@ static void mc6801_run(struct MC6801 *cpu) {
 			cpu->state = mc6801_state_label_a;
 			continue;
 
+		case mc6801_state_label_a:
+			if (cpu->nmi_active) {
+				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu);
+				peek_byte(cpu, REG_SP);
+				cpu->state = mc6801_state_dispatch_irq;
+				continue;
+			}
+			if (!(REG_CC & CC_I) && (cpu->irq1_active || cpu->irq2_active)) {
+				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu);
+				peek_byte(cpu, REG_SP);
+				cpu->state = mc6801_state_dispatch_irq;
+				continue;
+			}
+			REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
+			cpu->state = mc6801_state_next_instruction;
+			// Instruction fetch hook called here so that machine
+			// can be stopped beforehand.
+			DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
+			// Unless the hook stopped the CPU, carry on into the
+			// instruction fetch rather than going back round the
+			// state dispatch.
+			if (!cpu->running || cpu->state != mc6801_state_next_instruction)
+				continue;
+			// fall through
+
 		case mc6801_state_next_instruction:
 			{
-			unsigned op;
 			cpu->state = mc6801_state_label_a;
 			// Fetch op-code and process
 			op = byte_immediate(cpu);
+			OP_DISPATCH;
 			switch (op) {
 
 			// 0x00 CLB illegal - clear, no flags
 			case 0x00:
+				OP_HANDLER;
 				REG_B = 0;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x01 NOP inherent
 			case 0x01:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x02 SEXA illegal
 			case 0x02:
+				OP_HANDLER;
 				REG_A = (REG_CC & CC_C) ? 0xff : 0;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x03 SETA illegal
 			case 0x03:
+				OP_HANDLER;
 				REG_A = 0xff;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x04 LSRD inherent
 			case 0x04:
+				OP_HANDLER;
 				REG_D = op_lsr16_v(cpu, REG_D);
 				peek_byte(cpu, REG_PC);
 				NVMA_CYCLE;
@@ -483,6 +495,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x05 ASLD inherent
 			case 0x05:
+				OP_HANDLER;
 				REG_D = op_asl16(cpu, REG_D);
 				peek_byte(cpu, REG_PC);
 				NVMA_CYCLE;
@@ -490,6 +503,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x06 TAP inherent
 			case 0x06:
+				OP_HANDLER;
 				REG_CC = 0xc0 | REG_A | CC_I;
 				cpu->itmp = REG_A & CC_I;
 				if (cpu->itmp) {
@@ -500,12 +514,14 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x07 TPA inherent
 			case 0x07:
+				OP_HANDLER;
 				REG_A = 0xc0 | REG_CC;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x08 INX inherent
 			case 0x08:
+				OP_HANDLER;
 				REG_X++;
 				CLR_Z;
 				SET_Z16(REG_X);
@@ -515,6 +531,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x09 DEX inherent
 			case 0x09:
+				OP_HANDLER;
 				REG_X--;
 				CLR_Z;
 				SET_Z16(REG_X);
@@ -524,36 +541,42 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x0a CLV inherent
 			case 0x0a:
+				OP_HANDLER;
 				REG_CC &= ~CC_V;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x0b SEV inherent
 			case 0x0b:
+				OP_HANDLER;
 				REG_CC |= CC_V;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x0c CLC inherent
 			case 0x0c:
+				OP_HANDLER;
 				REG_CC &= ~CC_C;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x0d SEC inherent
 			case 0x0d:
+				OP_HANDLER;
 				REG_CC |= CC_C;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x0e CLI inherent
 			case 0x0e:
+				OP_HANDLER;
 				cpu->itmp = 0;
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x0f SEI inherent
 			case 0x0f:
+				OP_HANDLER;
 				REG_CC |= CC_I;
 				cpu->itmp = CC_I;
 				cpu->irq1_latch = cpu->irq2_latch = 0;
@@ -562,24 +585,28 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x10 SBA inherent
 			case 0x10:
+				OP_HANDLER;
 				REG_A = op_sub(cpu, REG_A, REG_B);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x11 CBA inherent
 			case 0x11:
+				OP_HANDLER;
 				(void)op_sub(cpu, REG_A, REG_B);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x12 SCBA inherent, illegal; A = A - B - C
 			case 0x12:
+				OP_HANDLER;
 				REG_A = op_sbc(cpu, REG_A, REG_B);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x13 S1BA inherent, illegal; A = A - B - 1
 			case 0x13:
+				OP_HANDLER;
 				{
 					unsigned out = REG_A - REG_B - 1;
 					CLR_NZVC;
@@ -593,6 +620,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0x1c TCAB inherent, illegal; B = A - 1
 			case 0x14:
 			case 0x1c:
+				OP_HANDLER;
 				{
 					unsigned out = REG_A - 1;
 					CLR_NZV;
@@ -605,6 +633,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x15 TCBA inherent, illegal; A = B - 1
 			case 0x15:
+				OP_HANDLER;
 				{
 					unsigned out = REG_B - 1;
 					CLR_NZV;
@@ -619,6 +648,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0x1e TAB inherent, illegal
 			case 0x16:
 			case 0x1e:
+				OP_HANDLER;
 				REG_B = REG_A;
 				CLR_NZV;
 				SET_NZ8(REG_B);
@@ -627,6 +657,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x17 TBA inherent
 			case 0x17:
+				OP_HANDLER;
 				REG_A = REG_B;
 				CLR_NZV;
 				SET_NZ8(REG_A);
@@ -637,24 +668,28 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0x1a ABA inherent, illegal
 			case 0x18:
 			case 0x1a:
+				OP_HANDLER;
 				REG_A = op_add_nzv(cpu, REG_A, REG_B);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x19 DAA inherent
 			case 0x19:
+				OP_HANDLER;
 				REG_A = op_daa_v(cpu, REG_A);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x1b ABA inherent
 			case 0x1b:
+				OP_HANDLER;
 				REG_A = op_add(cpu, REG_A, REG_B);
 				peek_byte(cpu, REG_PC);
 				break;
 
 			// 0x1d TCBA inherent, illegal; A = B - 1
 			case 0x1d:
+				OP_HANDLER;
 				{
 					unsigned out = REG_B - 1;
 					CLR_NZVC;
@@ -669,6 +704,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x1f TBAC inherent, illegal; A = B, set C
 			case 0x1f:
+				OP_HANDLER;
 				REG_A = REG_B;
 				CLR_NZV;
 				SET_NZ8(REG_B);
@@ -681,6 +717,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			case 0x24: case 0x25: case 0x26: case 0x27:
 			case 0x28: case 0x29: case 0x2a: case 0x2b:
 			case 0x2c: case 0x2d: case 0x2e: case 0x2f: {
+				OP_HANDLER;
 				unsigned tmp = sex8(byte_immediate(cpu));
 				NVMA_CYCLE;
 				if (branch_condition(cpu, op))
@@ -689,6 +726,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x30 TSX inherent
 			case 0x30:
+				OP_HANDLER;
 				REG_X = REG_SP + 1;
 				peek_byte(cpu, REG_PC);
 				NVMA_CYCLE;
@@ -696,12 +734,14 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x31 INS inherent
 			case 0x31:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP++);
 				break;
 
 			// 0x32 PULA inherent
 			case 0x32:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP++);
 				REG_A = fetch_byte_notrace(cpu, REG_SP);
@@ -709,6 +749,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x33 PULB inherent
 			case 0x33:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP++);
 				REG_B = fetch_byte_notrace(cpu, REG_SP);
@@ -716,12 +757,14 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x34 DES inherent
 			case 0x34:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP--);
 				break;
 
 			// 0x35 TXS inherent
 			case 0x35:
+				OP_HANDLER;
 				REG_SP = REG_X - 1;
 				peek_byte(cpu, REG_PC);
 				NVMA_CYCLE;
@@ -729,18 +772,21 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x36 PSHA inherent
 			case 0x36:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				store_byte(cpu, REG_SP--, REG_A);
 				break;
 
 			// 0x37 PSHB inherent
 			case 0x37:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				store_byte(cpu, REG_SP--, REG_B);
 				break;
 
 			// 0x38 PULX inherent
 			case 0x38:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP++);
 				REG_X = fetch_byte_notrace(cpu, REG_SP++) << 8;
@@ -749,6 +795,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x39 RTS inherent
 			case 0x39:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				REG_PC = pull_s_word(cpu);
 				NVMA_CYCLE;
@@ -756,6 +803,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3a ABX inherent
 			case 0x3a:
+				OP_HANDLER;
 				REG_X += REG_B;
 				peek_byte(cpu, REG_PC);
 				NVMA_CYCLE;
@@ -763,6 +811,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3b RTI inherent
 			case 0x3b:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				peek_byte(cpu, REG_SP);
 				// no point tracking the 1-cycle delay for ITMP->I here
@@ -776,6 +825,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3c PSHX inherent
 			case 0x3c:
+				OP_HANDLER;
 				peek_byte(cpu, REG_PC);
 				store_byte(cpu, REG_SP--, REG_X & 0xff);
 				store_byte(cpu, REG_SP--, REG_X >> 8);
@@ -783,6 +833,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3d MUL inherent
 			case 0x3d: {
+				OP_HANDLER;
 				unsigned tmp = REG_A * REG_B;
 				REG_D = tmp;
 				if (tmp & 0x80)
@@ -802,6 +853,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3e WAI inherent
 			case 0x3e:
+				OP_HANDLER;
 				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
 				peek_byte(cpu, REG_PC);
 				stack_irq_registers(cpu);
@@ -811,6 +863,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x3f SWI inherent
 			case 0x3f:
+				OP_HANDLER;
 				REG_CC = (REG_CC & ~CC_I) | cpu->itmp;
 				peek_byte(cpu, REG_PC);
 				stack_irq_registers(cpu);
@@ -842,6 +895,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			case 0x74: case 0x75: case 0x76: case 0x77:
 			case 0x78: case 0x79: case 0x7a: case 0x7b:
 			case 0x7c: case 0x7d: case 0x7f: {
+				OP_HANDLER;
 				uint16_t ea;
 				unsigned tmp1;
 				switch ((op >> 4) & 0xf) {
@@ -902,12 +956,14 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0x4e, 0x5e T (HCF)
 			case 0x4e:
 			case 0x5e:
+				OP_HANDLER;
 				cpu->state = mc6801_state_hcf;
 				break;
 
 			// 0x6e JMP indexed
 			// 0x7e JMP extended
 			case 0x6e: case 0x7e: {
+				OP_HANDLER;
 				unsigned ea;
 				switch ((op >> 4) & 0xf) {
 				case 0x6: ea = ea_indexed(cpu); break;
@@ -943,6 +999,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			case 0xf0: case 0xf1: case 0xf2:
 			case 0xf4: case 0xf5: case 0xf6:
 			case 0xf8: case 0xf9: case 0xfa: case 0xfb: {
+				OP_HANDLER;
 				unsigned tmp1, tmp2;
 				tmp1 = !(op & 0x40) ? REG_A : REG_B;
 				switch ((op >> 4) & 3) {
@@ -978,6 +1035,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0xc3, 0xd3, 0xe3, 0xf3 ADDD
 			case 0x83: case 0x93: case 0xa3: case 0xb3:
 			case 0xc3: case 0xd3: case 0xe3: case 0xf3: {
+				OP_HANDLER;
 				unsigned tmp1, tmp2;
 				tmp1 = REG_D;
 				switch ((op >> 4) & 3) {
@@ -998,6 +1056,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// 0x8c, 0x9c, 0xac, 0xbc CPX
 			case 0x8c: case 0x9c: case 0xac: case 0xbc: {
+				OP_HANDLER;
 				unsigned tmp2;
 				switch ((op >> 4) & 3) {
 				case 0: tmp2 = word_immediate(cpu); break;
@@ -1013,6 +1072,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0x8d BSR
 			// 0x9d, 0xad, 0xbd JSR
 			case 0x8d: case 0x9d: case 0xad: case 0xbd: {
+				OP_HANDLER;
 				unsigned ea;
 				switch ((op >> 4) & 3) {
 				case 0: ea = short_relative(cpu); ea += REG_PC; NVMA_CYCLE; break;
@@ -1032,6 +1092,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			case 0x8e: case 0x9e: case 0xae: case 0xbe:
 			case 0xcc: case 0xdc: case 0xec: case 0xfc:
 			case 0xce: case 0xde: case 0xee: case 0xfe: {
+				OP_HANDLER;
 				unsigned tmp1, tmp2;
 				switch ((op >> 4) & 3) {
 				case 0: tmp2 = word_immediate(cpu); break;
@@ -1055,6 +1116,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// count right
 			case 0x8f:
 			case 0xcd: case 0xcf: {
+				OP_HANDLER;
 				unsigned tmp1;
 				(void)word_immediate(cpu);
 				switch (op & 0x4e) {
@@ -1071,6 +1133,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			// 0xd7, 0xe7, 0xf7 STAB
 			case 0x97: case 0xa7: case 0xb7:
 			case 0xd7: case 0xe7: case 0xf7: {
+				OP_HANDLER;
 				uint16_t ea;
 				uint8_t tmp1;
 				tmp1 = !(op & 0x40) ? REG_A : REG_B;
@@ -1091,6 +1154,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 			case 0x9f: case 0xaf: case 0xbf:
 			case 0xdd: case 0xed: case 0xfd:
 			case 0xdf: case 0xef: case 0xff: {
+				OP_HANDLER;
 				uint16_t ea, tmp1;
 				switch (op & 0x4e) {
 				default:
@@ -1112,6 +1176,7 @@ static void mc6801_run(struct MC6801 *cpu) {
 
 			// Illegal instruction
 			default:
+				OP_HANDLER;
 				NVMA_CYCLE;
 				break;
 			}
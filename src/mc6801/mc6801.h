@@ -25,6 +25,7 @@
 #include "pl-endian.h"
 
 #include "debug_cpu.h"
+#include "mc680x/mc680x_dispatch.h"
 #include "part.h"
 
 #ifdef TRACE
@@ -136,6 +137,9 @@ struct MC6801 {
 #ifdef TRACE
 	struct mc6801_trace *tracer;
 #endif
+#ifdef OP_DISPATCH_THREADED
+	void *op_dispatch[0x100];  // handler addresses, filled on first run
+#endif
 
 	// Registers
 	uint8_t reg_cc;
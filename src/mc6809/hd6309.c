@@ -251,6 +251,7 @@ static struct part *hd6309_allocate(void) {
 	cpu->reset = hd6309_reset;
 	cpu->run = hd6309_run;
 	cpu->mem_cycle = DELEGATE_DEFAULT2(void, bool, uint16);
+	cpu->nvma_cycles = DELEGATE_DEFAULT1(unsigned, int);
 
 	// Tested: on power on, all registers have random-ish values, although
 	// it definitely seems to err towards bits being set in my environment.
@@ -370,45 +371,6 @@ static void hd6309_run(struct MC6809 *cpu) {
 			}
 			continue;
 
-		// done_instruction case for backwards-compatibility
-		case hd6309_state_done_instruction:
-		case hd6309_state_label_a:
-			if (cpu->halt) {
-				NVMA_CYCLE;
-				continue;
-			}
-			hcpu->state = hd6309_state_label_b;
-			// fall through
-
-		case hd6309_state_label_b:
-			if (cpu->nmi_active) {
-				HD6309_TRACE_VECTOR(hcpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu, 1);
-				hcpu->state = hd6309_state_dispatch_irq;
-			} else if (!(REG_CC & CC_F) && cpu->firq_active) {
-				HD6309_TRACE_VECTOR(hcpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu, FIRQ_STACK_ALL);
-				hcpu->state = hd6309_state_dispatch_irq;
-			} else if (!(REG_CC & CC_I) && cpu->irq_active) {
-				HD6309_TRACE_VECTOR(hcpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu, 1);
-				hcpu->state = hd6309_state_dispatch_irq;
-			} else {
-				HD6309_TRACE_INSTRUCTION(hcpu);
-				hcpu->state = hd6309_state_next_instruction;
-				cpu->page = 0;
-				// Instruction fetch hook called here so that machine
-				// can be stopped beforehand.
-				DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
-			}
-			continue;
-
 		case hd6309_state_dispatch_irq:
 			if (cpu->nmi_active) {
 				cpu->nmi_active = cpu->nmi = cpu->nmi_latch = 0;
@@ -426,7 +388,11 @@ static void hd6309_run(struct MC6809 *cpu) {
 			cpu->nmi_active = cpu->nmi_latch;
 			cpu->firq_active = cpu->firq_latch;
 			cpu->irq_active = cpu->irq_latch;
+			cpu->waiting = !cpu->nmi_active &&
+			               !(cpu->firq_active && !(REG_CC & CC_F)) &&
+			               !(cpu->irq_active && !(REG_CC & CC_I));
 			NVMA_CYCLE;
+			cpu->waiting = 0;
 			if (!cpu->halt) {
 				hcpu->state = hd6309_state_dispatch_irq;
 			}
@@ -442,7 +408,9 @@ static void hd6309_run(struct MC6809 *cpu) {
 			cpu->nmi_active = cpu->nmi_latch;
 			cpu->firq_active = cpu->firq_latch;
 			cpu->irq_active = cpu->irq_latch;
+			cpu->waiting = !(cpu->nmi_active || cpu->firq_active || cpu->irq_active);
 			NVMA_CYCLE;
+			cpu->waiting = 0;
 			if (cpu->halt) {
 				hcpu->state = hd6309_state_sync_check_halt;
 			}
@@ -492,6 +460,50 @@ static void hd6309_run(struct MC6809 *cpu) {
 			}
 			continue;
 
+		// done_instruction case for backwards-compatibility
+		case hd6309_state_done_instruction:
+		case hd6309_state_label_a:
+			if (cpu->halt) {
+				NVMA_CYCLE;
+				continue;
+			}
+			hcpu->state = hd6309_state_label_b;
+			// fall through
+
+		case hd6309_state_label_b:
+			if (cpu->nmi_active) {
+				HD6309_TRACE_VECTOR(hcpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu, 1);
+				hcpu->state = hd6309_state_dispatch_irq;
+			} else if (!(REG_CC & CC_F) && cpu->firq_active) {
+				HD6309_TRACE_VECTOR(hcpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu, FIRQ_STACK_ALL);
+				hcpu->state = hd6309_state_dispatch_irq;
+			} else if (!(REG_CC & CC_I) && cpu->irq_active) {
+				HD6309_TRACE_VECTOR(hcpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu, 1);
+				hcpu->state = hd6309_state_dispatch_irq;
+			} else {
+				HD6309_TRACE_INSTRUCTION(hcpu);
+				hcpu->state = hd6309_state_next_instruction;
+				cpu->page = 0;
+				// Instruction fetch hook called here so that machine
+				// can be stopped beforehand.
+				DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
+			}
+			// Unless an interrupt is being taken or the hook stopped
+			// the CPU, carry on into the instruction fetch rather
+			// than going back round the state dispatch.
+			if (!cpu->running || hcpu->state != hd6309_state_next_instruction)
+				continue;
+			// fall through
+
 		case hd6309_state_next_instruction:
 			{
 			unsigned op;
@@ -673,9 +685,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				SET_N16(REG_D);
 				if (REG_D == 0 && REG_W == 0)
 					REG_CC |= CC_Z;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(3);
 				break;
 
 			// 0x16 LBRA relative
@@ -693,11 +703,9 @@ static void hd6309_run(struct MC6809 *cpu) {
 				uint16_t ea;
 				ea = long_relative(cpu);
 				ea += REG_PC;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				if (!NATIVE_MODE) {
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 				}
 				push_s_word(cpu, REG_PC);
 				REG_PC = ea;
@@ -792,13 +800,9 @@ static void hd6309_run(struct MC6809 *cpu) {
 					case 0xf: REG_F = tmp2; break;
 					default: break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(3);
 				if (!NATIVE_MODE) {
-					NVMA_CYCLE;
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(3);
 				}
 			} break;
 
@@ -841,11 +845,9 @@ static void hd6309_run(struct MC6809 *cpu) {
 					case 0xf: REG_F = tmp1; break;
 					default: break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				if (!NATIVE_MODE) {
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 				}
 			} break;
 
@@ -1026,14 +1028,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				if (tmp & 0x80)
 					REG_CC |= CC_C;
 				peek_byte(cpu, REG_PC);
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(8);
 				if (!NATIVE_MODE)
 					NVMA_CYCLE;
 			} break;
@@ -1162,7 +1157,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 			case 0x8d: case 0x9d: case 0xad: case 0xbd: {
 				uint16_t ea;
 				switch ((op >> 4) & 3) {
-				case 0: ea = short_relative(cpu); ea += REG_PC; NVMA_CYCLE; NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
+				case 0: ea = short_relative(cpu); ea += REG_PC; NVMA_CYCLES(2); if (!NATIVE_MODE) NVMA_CYCLE; break;
 				case 1: ea = ea_direct(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
 				case 2: ea = ea_indexed(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
 				case 3: ea = ea_extended(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
@@ -1419,32 +1414,28 @@ static void hd6309_run(struct MC6809 *cpu) {
 
 			// 0x1038 PSHSW inherent
 			case 0x0238:
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				push_s_byte(cpu, REG_F);
 				push_s_byte(cpu, REG_E);
 				break;
 
 			// 0x1039 PULSW inherent
 			case 0x0239:
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				REG_E = pull_s_byte(cpu);
 				REG_F = pull_s_byte(cpu);
 				break;
 
 			// 0x103a PSHUW inherent
 			case 0x023a:
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				push_u_byte(cpu, REG_F);
 				push_u_byte(cpu, REG_E);
 				break;
 
 			// 0x103b PULUW inherent
 			case 0x023b:
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 				REG_E = pull_u_byte(cpu);
 				REG_F = pull_u_byte(cpu);
 				break;
@@ -1687,9 +1678,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				}
 				postbyte = byte_immediate(cpu);
 				// Verified 3 NVMA cycles:
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(3);
 				hcpu->tfm_src = tfm_reg_to_ptr(hcpu, postbyte >> 4);
 				hcpu->tfm_dest = tfm_reg_to_ptr(hcpu, postbyte & 0xf);
 				REG_CC &= ~(CC_Z); // [hoglet67]
@@ -1722,8 +1711,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				data = byte_immediate(cpu);
 				data &= (MD_FM | MD_NM);
 				REG_MD = (REG_MD & ~(MD_FM | MD_NM)) | data;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 			} break;
 
 			// 0x113f SWI3 inherent
@@ -1814,9 +1802,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				case 3: tmp2 = byte_extended(cpu); break;
 				default: tmp2 = 0; break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(3);
 				if (tmp2 == 0) {
 					REG_MD |= MD_D0;
 					CLR_NZV;
@@ -1901,9 +1887,7 @@ static void hd6309_run(struct MC6809 *cpu) {
 				case 3: tmp2 = word_extended(cpu); break;
 				default: tmp2 = 0; break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(3);
 				if (tmp2 == 0) {
 					REG_MD |= MD_D0;
 					CLR_NZV;
@@ -2130,29 +2114,27 @@ static uint16_t ea_indexed(struct MC6809 *cpu) {
 	} else if (postbyte == 0xcf || postbyte == 0xd0) {
 		ea = REG_W;
 		REG_W += 2;
-		NVMA_CYCLE;
-		NVMA_CYCLE;
+		NVMA_CYCLES(2);
 	} else if (postbyte == 0xef || postbyte == 0xf0) {
 		REG_W -= 2;
 		ea = REG_W;
-		NVMA_CYCLE;
-		NVMA_CYCLE;
+		NVMA_CYCLES(2);
 	} else switch (postbyte & 0x0f) {
 		case 0x00: ea = reg; reg += 1; peek_byte(cpu, REG_PC); NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
-		case 0x01: ea = reg; reg += 2; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
+		case 0x01: ea = reg; reg += 2; peek_byte(cpu, REG_PC); NVMA_CYCLES(2); if (!NATIVE_MODE) NVMA_CYCLE; break;
 		case 0x02: reg -= 1; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
-		case 0x03: reg -= 2; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
+		case 0x03: reg -= 2; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLES(2); if (!NATIVE_MODE) NVMA_CYCLE; break;
 		case 0x04: ea = reg; peek_byte(cpu, REG_PC); break;
 		case 0x05: ea = reg + sex8(REG_B); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
 		case 0x06: ea = reg + sex8(REG_A); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
 		case 0x07: ea = reg + sex8(REG_E); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
 		case 0x08: ea = byte_immediate(cpu); ea = sex8(ea) + reg; NVMA_CYCLE; break;
-		case 0x09: ea = word_immediate(cpu); ea = ea + reg; NVMA_CYCLE; NVMA_CYCLE; if (!NATIVE_MODE) NVMA_CYCLE; break;
+		case 0x09: ea = word_immediate(cpu); ea = ea + reg; NVMA_CYCLES(2); if (!NATIVE_MODE) NVMA_CYCLE; break;
 		case 0x0a: ea = reg + sex8(REG_F); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
-		case 0x0b: ea = reg + REG_D; peek_byte(cpu, REG_PC); peek_byte(cpu, REG_PC + 1); NVMA_CYCLE; if (!NATIVE_MODE) { NVMA_CYCLE; NVMA_CYCLE; } break;
+		case 0x0b: ea = reg + REG_D; peek_byte(cpu, REG_PC); peek_byte(cpu, REG_PC + 1); NVMA_CYCLE; if (!NATIVE_MODE) { NVMA_CYCLES(2); } break;
 		case 0x0c: ea = byte_immediate(cpu); ea = sex8(ea) + REG_PC; NVMA_CYCLE; break;
-		case 0x0d: ea = word_immediate(cpu); ea = ea + REG_PC; peek_byte(cpu, REG_PC); NVMA_CYCLE; if (!NATIVE_MODE) { NVMA_CYCLE; NVMA_CYCLE; } break;
-		case 0x0e: ea = reg + REG_W; NVMA_CYCLE; NVMA_CYCLE; break;
+		case 0x0d: ea = word_immediate(cpu); ea = ea + REG_PC; peek_byte(cpu, REG_PC); NVMA_CYCLE; if (!NATIVE_MODE) { NVMA_CYCLES(2); } break;
+		case 0x0e: ea = reg + REG_W; NVMA_CYCLES(2); break;
 		case 0x0f: ea = word_immediate(cpu); if (!NATIVE_MODE) NVMA_CYCLE; break;
 		default: ea = 0; break;
 	}
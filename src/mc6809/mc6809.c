@@ -111,6 +111,7 @@ extern inline void MC6809_HALT_SET(struct MC6809 *cpu, _Bool val);
 extern inline void MC6809_NMI_SET(struct MC6809 *cpu, _Bool val);
 extern inline void MC6809_FIRQ_SET(struct MC6809 *cpu, _Bool val);
 extern inline void MC6809_IRQ_SET(struct MC6809 *cpu, _Bool val);
+extern inline _Bool mc6809_is_idle(struct MC6809 *cpu);
 
 /*
  * External interface
@@ -228,6 +229,7 @@ static struct part *mc6809_allocate(void) {
 	cpu->reset = mc6809_reset;
 	cpu->run = mc6809_run;
 	cpu->mem_cycle = DELEGATE_DEFAULT2(void, bool, uint16);
+	cpu->nvma_cycles = DELEGATE_DEFAULT1(unsigned, int);
 
 	// Tested: (almost?) always, all registers are zeroed on power on.
 	//
@@ -307,45 +309,6 @@ static void mc6809_run(struct MC6809 *cpu) {
 			}
 			continue;
 
-		// done_instruction case for backwards-compatibility
-		case mc6809_state_done_instruction:
-		case mc6809_state_label_a:
-			if (cpu->halt) {
-				NVMA_CYCLE;
-				continue;
-			}
-			cpu->state = mc6809_state_label_b;
-			// fall through
-
-		case mc6809_state_label_b:
-			if (cpu->nmi_active) {
-				MC6809_TRACE_VECTOR(cpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu);
-				cpu->state = mc6809_state_dispatch_irq;
-			} else if (!(REG_CC & CC_F) && cpu->firq_active) {
-				MC6809_TRACE_VECTOR(cpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_firq_registers(cpu);
-				cpu->state = mc6809_state_dispatch_irq;
-			} else if (!(REG_CC & CC_I) && cpu->irq_active) {
-				MC6809_TRACE_VECTOR(cpu);
-				peek_byte(cpu, REG_PC);
-				peek_byte(cpu, REG_PC);
-				stack_irq_registers(cpu);
-				cpu->state = mc6809_state_dispatch_irq;
-			} else {
-				MC6809_TRACE_INSTRUCTION(cpu);
-				cpu->state = mc6809_state_next_instruction;
-				cpu->page = 0;
-				// Instruction fetch hook called here so that machine
-				// can be stopped beforehand.
-				DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
-			}
-			continue;
-
 		case mc6809_state_dispatch_irq:
 			if (cpu->nmi_active) {
 				cpu->nmi_active = cpu->nmi = cpu->nmi_latch = 0;
@@ -363,7 +326,11 @@ static void mc6809_run(struct MC6809 *cpu) {
 			cpu->nmi_active = cpu->nmi_latch;
 			cpu->firq_active = cpu->firq_latch;
 			cpu->irq_active = cpu->irq_latch;
+			cpu->waiting = !cpu->nmi_active &&
+			               !(cpu->firq_active && !(REG_CC & CC_F)) &&
+			               !(cpu->irq_active && !(REG_CC & CC_I));
 			NVMA_CYCLE;
+			cpu->waiting = 0;
 			if (!cpu->halt) {
 				cpu->state = mc6809_state_dispatch_irq;
 			}
@@ -379,7 +346,9 @@ static void mc6809_run(struct MC6809 *cpu) {
 			cpu->nmi_active = cpu->nmi_latch;
 			cpu->firq_active = cpu->firq_latch;
 			cpu->irq_active = cpu->irq_latch;
+			cpu->waiting = !(cpu->nmi_active || cpu->firq_active || cpu->irq_active);
 			NVMA_CYCLE;
+			cpu->waiting = 0;
 			if (cpu->halt) {
 				cpu->state = mc6809_state_sync_check_halt;
 			}
@@ -392,6 +361,50 @@ static void mc6809_run(struct MC6809 *cpu) {
 			}
 			continue;
 
+		// done_instruction case for backwards-compatibility
+		case mc6809_state_done_instruction:
+		case mc6809_state_label_a:
+			if (cpu->halt) {
+				NVMA_CYCLE;
+				continue;
+			}
+			cpu->state = mc6809_state_label_b;
+			// fall through
+
+		case mc6809_state_label_b:
+			if (cpu->nmi_active) {
+				MC6809_TRACE_VECTOR(cpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu);
+				cpu->state = mc6809_state_dispatch_irq;
+			} else if (!(REG_CC & CC_F) && cpu->firq_active) {
+				MC6809_TRACE_VECTOR(cpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_firq_registers(cpu);
+				cpu->state = mc6809_state_dispatch_irq;
+			} else if (!(REG_CC & CC_I) && cpu->irq_active) {
+				MC6809_TRACE_VECTOR(cpu);
+				peek_byte(cpu, REG_PC);
+				peek_byte(cpu, REG_PC);
+				stack_irq_registers(cpu);
+				cpu->state = mc6809_state_dispatch_irq;
+			} else {
+				MC6809_TRACE_INSTRUCTION(cpu);
+				cpu->state = mc6809_state_next_instruction;
+				cpu->page = 0;
+				// Instruction fetch hook called here so that machine
+				// can be stopped beforehand.
+				DELEGATE_SAFE_CALL(cpu->debug_cpu.instruction_hook);
+			}
+			// Unless an interrupt is being taken or the hook stopped
+			// the CPU, carry on into the instruction fetch rather
+			// than going back round the state dispatch.
+			if (!cpu->running || cpu->state != mc6809_state_next_instruction)
+				continue;
+			// fall through
+
 		case mc6809_state_next_instruction: {
 			unsigned op;
 			// Fetch op-code and process
@@ -502,8 +515,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 				}
 				switch (op & 0xf) {
 				case 0xd: // TST
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 					break;
 				default: // the rest need storing
 					switch ((op >> 4) & 0xf) {
@@ -600,8 +612,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0316: case 0x038d: {
 				uint16_t ea = long_relative(cpu);
 				REG_PC += ea;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(2);
 			} break;
 
 			// 0x17 LBSR relative
@@ -611,10 +622,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0317: {
 				uint16_t ea = long_relative(cpu);
 				ea += REG_PC;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(4);
 				push_s_word(cpu, REG_PC);
 				REG_PC = ea;
 			} break;
@@ -717,12 +725,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 					case 0xb: REG_DP = tmp2; break;
 					default: break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(6);
 			} break;
 
 			// 0x1f TFR immediate
@@ -758,10 +761,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 					case 0xb: REG_DP = tmp1; break;
 					default: break;
 				}
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(4);
 			} break;
 
 			// 0x20 - 0x2f short branches
@@ -819,8 +819,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0334:
 				{
 					unsigned postbyte = byte_immediate(cpu);
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 					peek_byte(cpu, REG_S);
 					if (postbyte & 0x80) { push_s_word(cpu, REG_PC); }
 					if (postbyte & 0x40) { push_s_word(cpu, REG_U); }
@@ -840,8 +839,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0335:
 				{
 					unsigned postbyte = byte_immediate(cpu);
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 					if (postbyte & 0x01) { REG_CC = pull_s_byte(cpu); }
 					if (postbyte & 0x02) { REG_A = pull_s_byte(cpu); }
 					if (postbyte & 0x04) { REG_B = pull_s_byte(cpu); }
@@ -861,8 +859,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0336:
 				{
 					unsigned postbyte = byte_immediate(cpu);
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 					peek_byte(cpu, REG_U);
 					if (postbyte & 0x80) { push_u_word(cpu, REG_PC); }
 					if (postbyte & 0x40) { push_u_word(cpu, REG_S); }
@@ -882,8 +879,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x0337:
 				{
 					unsigned postbyte = byte_immediate(cpu);
-					NVMA_CYCLE;
-					NVMA_CYCLE;
+					NVMA_CYCLES(2);
 					if (postbyte & 0x01) { REG_CC = pull_u_byte(cpu); }
 					if (postbyte & 0x02) { REG_A = pull_u_byte(cpu); }
 					if (postbyte & 0x04) { REG_B = pull_u_byte(cpu); }
@@ -977,15 +973,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 				if (tmp & 0x80)
 					REG_CC |= CC_C;
 				peek_byte(cpu, REG_PC);
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
-				NVMA_CYCLE;
+				NVMA_CYCLES(9);
 			} break;
 
 			// 0x3e RESET inherent, illegal
@@ -1203,7 +1191,7 @@ static void mc6809_run(struct MC6809 *cpu) {
 			case 0x039d: case 0x03ad: case 0x03bd: {
 				unsigned ea;
 				switch ((op >> 4) & 3) {
-				case 0: ea = short_relative(cpu); ea += REG_PC; NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
+				case 0: ea = short_relative(cpu); ea += REG_PC; NVMA_CYCLES(3); break;
 				case 1: ea = ea_direct(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
 				case 2: ea = ea_indexed(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
 				case 3: ea = ea_extended(cpu); peek_byte(cpu, ea); NVMA_CYCLE; break;
@@ -1460,20 +1448,20 @@ static uint16_t ea_indexed(struct MC6809 *cpu) {
 		return reg + sex5(postbyte & 0x1f);
 	}
 	switch (postbyte & 0x0f) {
-		case 0x00: ea = reg; reg += 1; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; break;
-		case 0x01: ea = reg; reg += 2; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
-		case 0x02: reg -= 1; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; break;
-		case 0x03: reg -= 2; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
+		case 0x00: ea = reg; reg += 1; peek_byte(cpu, REG_PC); NVMA_CYCLES(2); break;
+		case 0x01: ea = reg; reg += 2; peek_byte(cpu, REG_PC); NVMA_CYCLES(3); break;
+		case 0x02: reg -= 1; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLES(2); break;
+		case 0x03: reg -= 2; ea = reg; peek_byte(cpu, REG_PC); NVMA_CYCLES(3); break;
 		case 0x04: ea = reg; peek_byte(cpu, REG_PC); break;
 		case 0x05: ea = reg + sex8(REG_B); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
 		case 0x07: // illegal
 		case 0x06: ea = reg + sex8(REG_A); peek_byte(cpu, REG_PC); NVMA_CYCLE; break;
 		case 0x08: ea = byte_immediate(cpu); ea = sex8(ea) + reg; NVMA_CYCLE; break;
-		case 0x09: ea = word_immediate(cpu); ea = ea + reg; NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
+		case 0x09: ea = word_immediate(cpu); ea = ea + reg; NVMA_CYCLES(3); break;
 		case 0x0a: ea = REG_PC | 0xff; break;
-		case 0x0b: ea = reg + REG_D; peek_byte(cpu, REG_PC); peek_byte(cpu, REG_PC + 1); NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
+		case 0x0b: ea = reg + REG_D; peek_byte(cpu, REG_PC); peek_byte(cpu, REG_PC + 1); NVMA_CYCLES(3); break;
 		case 0x0c: ea = byte_immediate(cpu); ea = sex8(ea) + REG_PC; NVMA_CYCLE; break;
-		case 0x0d: ea = word_immediate(cpu); ea = ea + REG_PC; peek_byte(cpu, REG_PC); NVMA_CYCLE; NVMA_CYCLE; NVMA_CYCLE; break;
+		case 0x0d: ea = word_immediate(cpu); ea = ea + REG_PC; peek_byte(cpu, REG_PC); NVMA_CYCLES(3); break;
 		case 0x0e: ea = 0xffff; break; // illegal
 		case 0x0f: ea = word_immediate(cpu); NVMA_CYCLE; break;
 		default: ea = 0; break;
@@ -86,10 +86,19 @@ struct MC6809 {
 	/* Memory access cycle */
 	DELEGATE_T2(void, bool, uint16) mem_cycle;
 
+	// Run of dummy cycles.  Called with the number of dummy accesses to
+	// $FFFF still to come after one has gone through mem_cycle as normal.
+	// Returns how many of them the machine accounted for in one go (which
+	// may be none); the CPU performs the rest individually.
+	DELEGATE_T1(unsigned, int) nvma_cycles;
+
 	/* Internal state */
 
 	unsigned state;
 	_Bool running;
+	// Set during the dummy cycles of SYNC or CWAI, while no interrupt is
+	// in a position to wake the CPU.
+	_Bool waiting;
 	uint16_t page;  // 0, 0x200, or 0x300
 #ifdef TRACE
 	struct mc6809_trace *tracer;
@@ -134,6 +143,19 @@ inline void MC6809_IRQ_SET(struct MC6809 *cpu, _Bool val) {
 	cpu->irq = val;
 }
 
+// True if the CPU is waiting for an interrupt (SYNC or CWAI) and its inputs
+// have been stable long enough to have propagated through the latches.  Until
+// something changes them, all further cycles will be identical dummy cycles,
+// so the machine may skip ahead to the next scheduled event.
+
+inline _Bool mc6809_is_idle(struct MC6809 *cpu) {
+	return cpu->waiting && !cpu->halt && !(cpu->nmi_armed && cpu->nmi) &&
+	       cpu->firq == cpu->firq_latch && cpu->irq == cpu->irq_latch &&
+	       cpu->nmi_latch == cpu->nmi_active &&
+	       cpu->firq_latch == cpu->firq_active &&
+	       cpu->irq_latch == cpu->irq_active;
+}
+
 // Used by MC6809-compatibles:
 _Bool mc6809_is_a(struct part *p, const char *name);
 unsigned mc6809_get_pc(void *sptr);
@@ -45,6 +45,25 @@ static void store_byte(struct MC6809 *cpu, uint16_t a, uint8_t d) {
 #define peek_byte(c,a) ((void)fetch_byte_notrace(c,a))
 #define NVMA_CYCLE (peek_byte(cpu, 0xffff))
 
+// A run of dummy cycles.  The first goes through mem_cycle as normal, after
+// which the interrupt lines seen by the latches can only change if the
+// machine runs an event.  The machine is then offered the rest of the run to
+// account for in one call.  Anything it declines is done a cycle at a time.
+
+static void nvma_cycles(struct MC6809 *cpu, int n) {
+	NVMA_CYCLE;
+	while (--n > 0) {
+		cpu->nmi_latch |= (cpu->nmi_armed && cpu->nmi);
+		cpu->firq_latch = cpu->firq;
+		cpu->irq_latch = cpu->irq;
+		n -= DELEGATE_CALL(cpu->nvma_cycles, n);
+		if (n > 0)
+			NVMA_CYCLE;
+	}
+}
+
+#define NVMA_CYCLES(n) nvma_cycles(cpu, (n))
+
 /* Stack operations */
 
 static void push_s_byte(struct MC6809 *cpu, uint8_t v) {
@@ -0,0 +1,87 @@
+/** \file
+ *
+ *  \brief Motorola MC680x-compatible opcode dispatch.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  By default, the CPU cores decode each op-code with a switch statement.
+ *  Configured with --enable-threaded-dispatch, and compiled with GCC or Clang,
+ *  the MC6801 core instead jumps through a per-CPU table of handler addresses
+ *  (labels-as-values).
+ *
+ *  The MC6809 and HD6309 cores don't use this: measured with cpubench, they
+ *  ran no faster than with the switch, while the MC6801 gained around 5%.
+ *
+ *  The switch statement stays the single source of which op-codes map to
+ *  which handler.  On first run, each op-code is sent through the switch
+ *  once with the core's "registering" flag set, and the OP_HANDLER at the
+ *  top of each case group records its own address in the table instead of
+ *  executing.  From then on, the switch is bypassed.
+ *
+ *  Usage, in a core's run function:
+ *
+ *  - declare 'op' at function scope, before OP_DISPATCH_INIT(table, nops);
+ *  - OP_DISPATCH; immediately before "switch (op)"
+ *  - OP_HANDLER; as the first statement after each group of case labels
+ *
+ *  The table, declared in the CPU struct under OP_DISPATCH_THREADED, must be
+ *  zero-initialised, and 'nops' must cover every value of 'op'.
+ */
+
+#ifndef XROAR_MC680X_DISPATCH_H_
+#define XROAR_MC680X_DISPATCH_H_
+
+#if defined(THREADED_DISPATCH) && defined(__GNUC__)
+
+#define OP_DISPATCH_THREADED
+
+// Handlers are distinguished by source line, so there must be only one
+// OP_HANDLER on any line.  Code falling through from the previous case group
+// runs the registration check, but only registration ever finds it true.
+
+#define OP_HANDLER OP_HANDLER_(__LINE__)
+#define OP_HANDLER_(l) OP_HANDLER__(l)
+#define OP_HANDLER__(l) \
+	if (op_registering) { \
+		op_dispatch_table[op] = &&op_handler_##l; \
+		goto op_dispatch_registered; \
+	} \
+	op_handler_##l:
+
+#define OP_DISPATCH_INIT(t, n) \
+	void **op_dispatch_table = (t); \
+	_Bool op_registering = !op_dispatch_table[0]; \
+	if (op_registering) { \
+		for (op = 0; op < (n); op++) { \
+			goto op_dispatch_register; \
+op_dispatch_registered: ; \
+		} \
+		op_registering = 0; \
+	} \
+	do { } while (0)
+
+#define OP_DISPATCH \
+	goto *op_dispatch_table[op]; \
+op_dispatch_register: \
+	do { } while (0)
+
+#else
+
+#define OP_HANDLER do { } while (0)
+#define OP_DISPATCH_INIT(t, n) do { } while (0)
+#define OP_DISPATCH do { } while (0)
+
+#endif
+
+#endif
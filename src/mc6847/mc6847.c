@@ -80,7 +80,7 @@ struct MC6847_private {
 	uint8_t vram_sg_data;
 
 	/* Output */
-	int frame;  // frameskip counter
+	_Bool timing_only;  // frame is being skipped, see mc6847_set_timing_only()
 
 	/* Internal state */
 	_Bool is_32byte;
@@ -300,29 +300,36 @@ static _Bool mc6847_write_elem(void *sptr, struct ser_handle *sh, int tag) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// In timing-only mode, scanlines only fetch data to keep external address
+// counters in step, and no pixels are generated.  The last active line is
+// always rendered in full, leaving state that persists into the bottom border
+// (border colour, CSS latches) as it would have been.
+
+static _Bool is_timing_only(struct MC6847_private *vdg) {
+	return vdg->timing_only && vdg->scanline != (VDG_ACTIVE_AREA_END - 1);
+}
+
 static void do_hs_fall(void *data) {
 	struct MC6847_private *vdg = data;
 	// Finish rendering previous scanline
-	if (vdg->frame == 0) {
-		if (vdg->scanline < VDG_ACTIVE_AREA_START) {
-			if (!vdg->have_border_only) {
-				memset(vdg->pixel_data + VDG_LEFT_BORDER_START, vdg->border_colour, VDG_tAVB);
-				vdg->have_border_only = 1;
-			}
-		} else if (vdg->scanline >= VDG_ACTIVE_AREA_START && vdg->scanline < VDG_ACTIVE_AREA_END) {
-			vdg->have_border_only = 0;
-			render_scanline(vdg);
-			vdg->public.row++;
-			if (vdg->public.row > 11)
-				vdg->public.row = 0;
-			if ((vdg->public.row % vdg->nLPR) == 0)
-				vdg->A += vdg->is_32byte ? 32 : 16;
-			vdg->beam_pos = VDG_LEFT_BORDER_START;
-		} else if (vdg->scanline >= VDG_ACTIVE_AREA_END) {
-			if (!vdg->have_border_only) {
-				memset(vdg->pixel_data + VDG_LEFT_BORDER_START, vdg->border_colour, VDG_tAVB);
-				vdg->have_border_only = 1;
-			}
+	if (vdg->scanline < VDG_ACTIVE_AREA_START) {
+		if (!vdg->have_border_only) {
+			memset(vdg->pixel_data + VDG_LEFT_BORDER_START, vdg->border_colour, VDG_tAVB);
+			vdg->have_border_only = 1;
+		}
+	} else if (vdg->scanline >= VDG_ACTIVE_AREA_START && vdg->scanline < VDG_ACTIVE_AREA_END) {
+		vdg->have_border_only = 0;
+		render_scanline(vdg);
+		vdg->public.row++;
+		if (vdg->public.row > 11)
+			vdg->public.row = 0;
+		if ((vdg->public.row % vdg->nLPR) == 0)
+			vdg->A += vdg->is_32byte ? 32 : 16;
+		vdg->beam_pos = VDG_LEFT_BORDER_START;
+	} else if (vdg->scanline >= VDG_ACTIVE_AREA_END) {
+		if (!vdg->have_border_only) {
+			memset(vdg->pixel_data + VDG_LEFT_BORDER_START, vdg->border_colour, VDG_tAVB);
+			vdg->have_border_only = 1;
 		}
 	}
 	DELEGATE_CALL(vdg->public.render_line, vdg->burst, VDG_LINE_DURATION, vdg->pixel_data);
@@ -427,6 +434,10 @@ static void render_scanline(struct MC6847_private *vdg) {
 	// Calculate where we are in the scanline, and queue video data up to
 	// this point in time.
 
+	// In timing-only mode, the fetch handler is passed a NULL buffer: it
+	// need only advance its address counters.
+
+	_Bool timing_only = is_timing_only(vdg);
 	unsigned beam_to = (event_current_tick - vdg->scanline_start) / EVENT_VDG_TIME(1);
 	if (vdg->is_32byte && beam_to >= (VDG_tHBNK + 16)) {
 		unsigned nbytes = (beam_to - VDG_tHBNK) >> 4;
@@ -434,7 +445,7 @@ static void render_scanline(struct MC6847_private *vdg) {
 			nbytes = 42;
 		if (nbytes > vdg->vram_nbytes) {
 			unsigned nfetch = nbytes - vdg->vram_nbytes;
-			DELEGATE_CALL(vdg->public.fetch_data, vdg->A + vdg->vram_nbytes, nfetch, vdg->vram + vdg->vram_nbytes);
+			DELEGATE_CALL(vdg->public.fetch_data, vdg->A + vdg->vram_nbytes, nfetch, timing_only ? NULL : vdg->vram + vdg->vram_nbytes);
 			vdg->vram_nbytes = nbytes;
 		}
 	} else if (!vdg->is_32byte && beam_to >= (VDG_tHBNK + 32)) {
@@ -443,11 +454,14 @@ static void render_scanline(struct MC6847_private *vdg) {
 			nbytes = 22;
 		if (nbytes > vdg->vram_nbytes) {
 			unsigned nfetch = nbytes - vdg->vram_nbytes;
-			DELEGATE_CALL(vdg->public.fetch_data, vdg->A + vdg->vram_nbytes, nfetch, vdg->vram + vdg->vram_nbytes);
+			DELEGATE_CALL(vdg->public.fetch_data, vdg->A + vdg->vram_nbytes, nfetch, timing_only ? NULL : vdg->vram + vdg->vram_nbytes);
 			vdg->vram_nbytes = nbytes;
 		}
 	}
 
+	if (timing_only)
+		return;
+
 	if (beam_to < VDG_LEFT_BORDER_START)
 		return;
 	if (vdg->beam_pos >= beam_to)
@@ -645,6 +659,11 @@ void mc6847_set_inverted_text(struct MC6847 *vdgp, _Bool invert) {
 	vdg->inverted_text = invert;
 }
 
+void mc6847_set_timing_only(struct MC6847 *vdgp, _Bool timing_only) {
+	struct MC6847_private *vdg = (struct MC6847_private *)vdgp;
+	vdg->timing_only = timing_only;
+}
+
 // Render scanline up to current time
 void mc6847_update(void *sptr) {
 	struct MC6847_private *vdg = sptr;
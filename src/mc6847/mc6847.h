@@ -129,6 +129,11 @@ void mc6847_reset(struct MC6847 *);
 
 void mc6847_set_inverted_text(struct MC6847 *, _Bool);
 
+// While set, scanlines are not rendered: data fetches still happen (with a
+// NULL buffer, so external address counters advance), and all signal edges
+// are generated as normal.  Intended for skipped frames.
+void mc6847_set_timing_only(struct MC6847 *, _Bool);
+
 // Render scanline up to current time
 void mc6847_update(void *sptr);
 
@@ -482,6 +482,30 @@ void mc6883_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
 
 }
 
+// Further dummy cycles (reads from $FFFF) following one that went through
+// mc6883_mem_cycle().  Decode state is unchanged by these, so only the cycle
+// timing needs updating.  Performs up to n cycles, as many as fit in strictly
+// less than max_ticks, and returns the number performed.  Their total duration
+// is stored in *ticks.  The cpu_cycle delegate is not called: the caller is
+// responsible for accounting for the time.
+
+unsigned mc6883_nvma_cycles(struct MC6883 *samp, unsigned n, int max_ticks, int *ticks) {
+	struct MC6883_private *sam = (struct MC6883_private *)samp;
+	_Bool fast_cycle = sam->mpu_rate_fast || sam->mpu_rate_ad;
+	*ticks = 0;
+	// Only handle the steady state: a transition must be done properly
+	if (fast_cycle != sam->running_fast || max_ticks <= 0)
+		return 0;
+	int ncycles = fast_cycle ? EVENT_TICKS_14M31818(8) : EVENT_TICKS_14M31818(16);
+	unsigned max_n = (max_ticks - 1) / ncycles;
+	if (n > max_n)
+		n = max_n;
+	if (fast_cycle && (n & 1))
+		sam->extend_slow_cycle = !sam->extend_slow_cycle;
+	*ticks = n * ncycles;
+	return n;
+}
+
 // Just the address decode from mc6883_mem_cycle().  Used to verify that a
 // breakpoint refers to ROM.
 
@@ -496,6 +520,22 @@ unsigned mc6883_decode(struct MC6883 *samp, _Bool RnW, uint16_t A) {
 	return RnW ? 0 : data_S[A >> 13];
 }
 
+// Just the RAM address translation from mc6883_mem_cycle().  Returns true if
+// the address selects RAM, in which case bank (0 = RAS0, 1 = RAS1), row and
+// column are filled in.  Used by machines to build fast lookup tables.
+
+_Bool mc6883_decode_ram(struct MC6883 *samp, uint16_t A, unsigned *bank,
+			unsigned *row, unsigned *col) {
+	struct MC6883_private *sam = (struct MC6883_private *)samp;
+	if ((A >> 8) == 0xff || ((A & 0x8000) && !sam->TY)) {
+		return 0;
+	}
+	*bank = (A & sam->ram_ras1_bit) ? 1 : 0;
+	*row = RAM_TRANSLATE_ROW(A);
+	*col = RAM_TRANSLATE_COL(A);
+	return 1;
+}
+
 static void vcounter_set(struct MC6883_private *sam, int i, int val);
 
 static void vcounter_update(struct MC6883_private *sam, int i) {
@@ -44,6 +44,9 @@ struct MC6883 {
 void mc6883_reset(struct MC6883 *);
 void mc6883_mem_cycle(void *, _Bool RnW, uint16_t A);
 unsigned mc6883_decode(struct MC6883 *, _Bool RnW, uint16_t A);
+unsigned mc6883_nvma_cycles(struct MC6883 *, unsigned n, int max_ticks, int *ticks);
+_Bool mc6883_decode_ram(struct MC6883 *, uint16_t A, unsigned *bank,
+			unsigned *row, unsigned *col);
 void mc6883_vdg_hsync(struct MC6883 *, _Bool level);
 void mc6883_vdg_fsync(struct MC6883 *, _Bool level);
 int mc6883_vdg_bytes(struct MC6883 *, int nbytes);
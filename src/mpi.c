@@ -89,7 +89,7 @@ static const struct ser_struct_data mpi_ser_struct_data = {
 
 /* Protect against chained MPI initialisation */
 
-static _Bool mpi_active = 0;
+static VAR_ATTR_THREAD_LOCAL _Bool mpi_active = 0;
 
 /* Handle signals from cartridges */
 static void mpi_set_firq(void *, _Bool);
@@ -0,0 +1,219 @@
+/** \file
+ *
+ *  \brief File audio output module.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Writes mixed audio to the file named by the device option, or to standard
+ *  output if that is "-".  A filename ending in ".wav" gets a WAV header,
+ *  anything else is written as raw samples in the requested format.
+ *
+ *  With rate limiting enabled, output is paced in real time like any other
+ *  module.  Without (-no-ratelimit), audio is written as fast as it can be
+ *  generated, and nothing is skipped.
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "c-strcase.h"
+#include "pl-endian.h"
+#include "xalloc.h"
+
+#include "ao.h"
+#include "fs.h"
+#include "logging.h"
+#include "module.h"
+#include "sound.h"
+#include "wav.h"
+#include "xroar.h"
+
+static void *new(void *cfg);
+
+struct module ao_file_module = {
+	.name = "file", .description = "Write audio to file",
+	.new = new,
+};
+
+struct ao_file_interface {
+	struct ao_interface public;
+
+	FILE *f;
+	_Bool is_wav;
+	_Bool swap_float;  // WAV float data is little-endian
+	struct wav_header wav;
+
+	enum sound_fmt sample_fmt;
+	unsigned rate;
+	unsigned nchannels;
+	unsigned sample_nbytes;
+	unsigned fragment_nframes;
+	void *fragment_buffer;
+
+	uint32_t data_nbytes;
+	struct ao_clock clock;
+};
+
+static void ao_file_free(void *sptr);
+static void *ao_file_write_buffer(void *sptr, void *buffer);
+
+static void *new(void *cfg) {
+	(void)cfg;
+	const char *filename = xroar_cfg.ao.device;
+	if (!filename) {
+		LOG_ERROR("File audio: no filename given (use -ao-device)\n");
+		return NULL;
+	}
+
+	struct ao_file_interface *aofile = xmalloc(sizeof(*aofile));
+	*aofile = (struct ao_file_interface){0};
+	struct ao_interface *ao = &aofile->public;
+
+	ao->free = DELEGATE_AS0(void, ao_file_free, ao);
+
+	size_t len = strlen(filename);
+	aofile->is_wav = (len > 4 && c_strcasecmp(filename + len - 4, ".wav") == 0);
+
+	unsigned rate = (xroar_cfg.ao.rate > 0) ? xroar_cfg.ao.rate : 48000;
+	unsigned nchannels = 2;
+	if (xroar_cfg.ao.channels >= 1 && xroar_cfg.ao.channels <= 2)
+		nchannels = xroar_cfg.ao.channels;
+
+	// Default to 16-bit little-endian, so output doesn't depend on host
+	enum sound_fmt sample_fmt = xroar_cfg.ao.format;
+	if (sample_fmt == SOUND_FMT_NULL)
+		sample_fmt = SOUND_FMT_S16_LE;
+
+	if (aofile->is_wav) {
+		// WAV only has unsigned 8-bit, little-endian 16-bit and
+		// little-endian float
+		switch (sample_fmt) {
+		case SOUND_FMT_S8:
+			LOG_WARN("File audio: WAV 8-bit data is unsigned: writing u8\n");
+			sample_fmt = SOUND_FMT_U8;
+			break;
+		case SOUND_FMT_S16_BE:
+		case SOUND_FMT_S16_HE:
+		case SOUND_FMT_S16_SE:
+			sample_fmt = SOUND_FMT_S16_LE;
+			break;
+		case SOUND_FMT_FLOAT:
+			aofile->swap_float = (__BYTE_ORDER == __BIG_ENDIAN);
+			break;
+		default:
+			break;
+		}
+	}
+
+	switch (sample_fmt) {
+	case SOUND_FMT_U8:
+	case SOUND_FMT_S8:
+		aofile->sample_nbytes = 1;
+		break;
+	case SOUND_FMT_FLOAT:
+		aofile->sample_nbytes = 4;
+		break;
+	default:
+		aofile->sample_nbytes = 2;
+		break;
+	}
+
+	unsigned fragment_nframes = 1024;
+	if (xroar_cfg.ao.fragment_ms > 0) {
+		fragment_nframes = (rate * xroar_cfg.ao.fragment_ms) / 1000;
+	} else if (xroar_cfg.ao.fragment_nframes > 0) {
+		fragment_nframes = xroar_cfg.ao.fragment_nframes;
+	}
+	if (fragment_nframes < 1)
+		fragment_nframes = 1;
+
+	aofile->f = fs_open_output(filename);
+	if (!aofile->f) {
+		LOG_ERROR("File audio: can't open '%s'\n", filename);
+		free(aofile);
+		return NULL;
+	}
+
+	aofile->sample_fmt = sample_fmt;
+	aofile->rate = rate;
+	aofile->nchannels = nchannels;
+	aofile->fragment_nframes = fragment_nframes;
+	size_t fragment_nbytes = fragment_nframes * nchannels * aofile->sample_nbytes;
+	aofile->fragment_buffer = xmalloc(fragment_nbytes);
+	memset(aofile->fragment_buffer, 0, fragment_nbytes);
+
+	ao->sound_interface = sound_interface_new(aofile->fragment_buffer, sample_fmt, rate, nchannels, fragment_nframes);
+	if (!ao->sound_interface) {
+		LOG_ERROR("File audio: XRoar internal error\n");
+		fs_close_output(aofile->f);
+		free(aofile->fragment_buffer);
+		free(aofile);
+		return NULL;
+	}
+	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_file_write_buffer, ao);
+	// Output must be complete even when running as fast as possible
+	ao->sound_interface->render_all = 1;
+
+	// Lengths are patched when the file is closed, if it can be rewound
+	if (aofile->is_wav) {
+		aofile->wav = (struct wav_header){
+			.format = (sample_fmt == SOUND_FMT_FLOAT) ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM,
+			.nchannels = nchannels,
+			.rate = rate,
+			.sample_nbytes = aofile->sample_nbytes,
+		};
+		wav_write_header(aofile->f, &aofile->wav, WAV_DATA_NBYTES_UNKNOWN);
+	}
+
+	LOG_DEBUG(1, "\twriting %s to '%s'\n", aofile->is_wav ? "WAV" : "raw", filename);
+	return aofile;
+}
+
+static void ao_file_free(void *sptr) {
+	struct ao_file_interface *aofile = sptr;
+	sound_interface_free(aofile->public.sound_interface);
+	if (aofile->is_wav) {
+		wav_update_header(aofile->f, &aofile->wav, aofile->data_nbytes);
+	}
+	fs_close_output(aofile->f);
+	free(aofile->fragment_buffer);
+	free(aofile);
+}
+
+static void *ao_file_write_buffer(void *sptr, void *buffer) {
+	struct ao_file_interface *aofile = sptr;
+
+	if (aofile->public.sound_interface->ratelimit) {
+		ao_clock_wait(&aofile->clock, aofile->rate, aofile->fragment_nframes);
+	} else {
+		ao_clock_reset(&aofile->clock);
+	}
+
+	unsigned nsamples = aofile->fragment_nframes * aofile->nchannels;
+	if (aofile->swap_float) {
+		uint8_t *p = buffer;
+		for (unsigned i = 0; i < nsamples; i++, p += 4) {
+			uint8_t t = p[0]; p[0] = p[3]; p[3] = t;
+			t = p[1]; p[1] = p[2]; p[2] = t;
+		}
+	}
+	size_t nbytes = nsamples * aofile->sample_nbytes;
+	fwrite(buffer, 1, nbytes, aofile->f);
+	aofile->data_nbytes += nbytes;
+	return buffer;
+}
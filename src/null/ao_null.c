@@ -18,28 +18,16 @@
 
 #include "top-config.h"
 
-#ifndef HAVE_SDL2
-// for struct timespec, gettimeofday, nanosleep
-#define _POSIX_C_SOURCE 200112L
-#endif
-
 #include <signal.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-#ifdef HAVE_SDL2
-#include <SDL.h>
-#else
-#include <errno.h>
-#include <time.h>
-#include <sys/time.h>
-#endif
-
 #include "xalloc.h"
 
 #include "ao.h"
 #include "events.h"
+#include "host_clock.h"
 #include "logging.h"
 #include "module.h"
 #include "sound.h"
@@ -60,7 +48,6 @@ struct ao_null_interface {
 };
 
 static unsigned int current_time(void);
-static void sleep_ms(unsigned int ms);
 
 static void ao_null_free(void *sptr);
 static void *ao_null_write_buffer(void *sptr, void *buffer);
@@ -84,29 +71,10 @@ static void *new(void *cfg) {
 	return aonull;
 }
 
-static unsigned int current_time(void) {
-#ifdef HAVE_SDL2
-	return SDL_GetTicks();
-#else
-	struct timeval tp;
-	gettimeofday(&tp, NULL);
-	return (tp.tv_sec % 1000) * 1000 + (tp.tv_usec / 1000);
-#endif
-}
+// Host time in milliseconds.  Wraps, but only differences are used.
 
-static void sleep_ms(unsigned int ms) {
-#ifdef HAVE_SDL2
-	SDL_Delay(ms);
-#else
-	struct timespec elapsed, tv;
-	elapsed.tv_sec = (ms) / 1000;
-	elapsed.tv_nsec = ((ms) % 1000) * 1000000;
-	do {
-		errno = 0;
-		tv.tv_sec = elapsed.tv_sec;
-		tv.tv_nsec = elapsed.tv_nsec;
-	} while (nanosleep(&tv, &elapsed) && errno == EINTR);
-#endif
+static unsigned int current_time(void) {
+	return (unsigned int)(host_clock_us() / 1000);
 }
 
 static void ao_null_free(void *sptr) {
@@ -127,7 +95,7 @@ static void *ao_null_write_buffer(void *sptr, void *buffer) {
 			aonull->last_pause_ms = current_time();
 			aonull->last_pause_cycle = event_current_tick;
 		} else {
-			sleep_ms(difference_ms);
+			host_clock_sleep_us(difference_ms * 1000);
 			difference_ms = current_time() - aonull->last_pause_ms;
 			aonull->last_pause_ms += difference_ms;
 			aonull->last_pause_cycle += difference_ms * EVENT_MS(1);
@@ -22,6 +22,7 @@
 
 #include "xalloc.h"
 
+#include "logging.h"
 #include "module.h"
 #include "ui.h"
 #include "vo.h"
@@ -38,6 +39,19 @@ static struct module * const null_filereq_module_list[] = {
 	&filereq_null_module, NULL
 };
 
+static void *vo_null_new(void *cfg);
+
+struct module vo_null_module = {
+	.name = "null", .description = "No video",
+	.new = vo_null_new
+};
+
+extern struct module vo_hash_module;
+
+static struct module * const null_vo_module_list[] = {
+	&vo_null_module, &vo_hash_module, NULL
+};
+
 static void update_state(void *sptr, int tag, int value, const void *data);
 
 static void *new(void *cfg);
@@ -45,6 +59,7 @@ static void *new(void *cfg);
 struct ui_module ui_null_module = {
 	.common = { .name = "null", .description = "No UI", .new = new, },
 	.filereq_module_list = null_filereq_module_list,
+	.vo_module_list = null_vo_module_list,
 };
 
 /* */
@@ -59,28 +74,46 @@ static void null_free(void *sptr);
 static void null_render(void *sptr, unsigned burst, unsigned npixels, uint8_t const *data);
 
 static void *new(void *cfg) {
-	(void)cfg;
+	struct ui_cfg *ui_cfg = cfg;
+
+	// A video module named for another UI (e.g. from a config file) falls
+	// back to no video rather than failing.
+	struct module *vo_mod = module_select_by_arg(null_vo_module_list, ui_cfg->vo);
+	if (!vo_mod) {
+		vo_mod = &vo_null_module;
+		LOG_WARN("Video module `%s' not found: trying '%s'\n", ui_cfg->vo, vo_mod->name);
+	}
+	struct vo_interface *vo = module_init(vo_mod, cfg);
+	if (!vo) {
+		return NULL;
+	}
+
 	struct ui_interface *uinull = xmalloc(sizeof(*uinull));
 	*uinull = (struct ui_interface){0};
 
 	uinull->free = DELEGATE_AS0(void, null_free, uinull);
 	uinull->update_state = DELEGATE_AS3(void, int, int, cvoidp, update_state, uinull);
-
-	struct vo_interface *vo = xmalloc(sizeof(*vo));
 	uinull->vo_interface = vo;
-	*vo = (struct vo_interface){0};
-
-	vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, null_render, vo->renderer);
 
 	return uinull;
 }
 
 static void null_free(void *sptr) {
 	struct ui_interface *uinull = sptr;
-	free(uinull->vo_interface);
 	free(uinull);
 }
 
+static void *vo_null_new(void *cfg) {
+	(void)cfg;
+	struct vo_interface *vo = vo_interface_new(sizeof(*vo));
+	*vo = (struct vo_interface){0};
+
+	vo->free = DELEGATE_AS0(void, free, vo);
+	vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, null_render, vo->renderer);
+
+	return vo;
+}
+
 static void update_state(void *sptr, int tag, int value, const void *data) {
 	(void)sptr;
 	(void)tag;
@@ -0,0 +1,282 @@
+/** \file
+ *
+ *  \brief Frame hash video module.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Renders into memory and computes a 64-bit hash of every Nth frame, for
+ *  regression testing without a display.  Hashes are either printed, one
+ *  "FRAME HASH" pair per line, or compared against a golden list in the same
+ *  format.
+ *
+ *  The hash follows the structure of XXH64, but consumes whole 32-bit pixels
+ *  so that results don't depend on host byte order.  It is not compatible
+ *  with real XXH64 implementations.
+ */
+
+#include "top-config.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xalloc.h"
+
+#include "logging.h"
+#include "module.h"
+#include "ui.h"
+#include "vo.h"
+#include "vo_render.h"
+
+// Large enough for any viewport selectable with vo_set_viewport()
+#define MAX_VIEWPORT_WIDTH (800)
+#define MAX_VIEWPORT_HEIGHT (300)
+
+static void *new(void *cfg);
+
+struct module vo_hash_module = {
+	.name = "hash", .description = "Frame hash (no display)",
+	.new = new,
+};
+
+struct vo_hash_golden {
+	unsigned frame;
+	uint64_t hash;
+};
+
+struct vo_hash_interface {
+	struct vo_interface public;
+
+	uint32_t *pixels;
+
+	unsigned interval;
+	unsigned frame;
+
+	// Golden list, if comparing.  Entries are in file order, and are
+	// matched as frame numbers advance.
+	struct {
+		_Bool enabled;
+		struct vo_hash_golden *list;
+		unsigned nentries;
+		unsigned next;
+	} golden;
+
+	unsigned nhashed;
+	unsigned nchecked;
+	unsigned nmismatched;
+};
+
+static void vo_hash_free(void *sptr);
+static void set_viewport(void *sptr, int vp_w, int vp_h);
+static void vsync(void *sptr);
+
+static _Bool read_golden(struct vo_hash_interface *vohash, const char *filename);
+
+static void *new(void *cfg) {
+	struct ui_cfg *ui_cfg = cfg;
+	struct vo_cfg *vo_cfg = &ui_cfg->vo_cfg;
+
+	struct vo_hash_interface *vohash = vo_interface_new(sizeof(*vohash));
+	*vohash = (struct vo_hash_interface){0};
+	struct vo_interface *vo = &vohash->public;
+
+	vohash->interval = (vo_cfg->hash_interval > 0) ? vo_cfg->hash_interval : 1;
+	if (vo_cfg->hash_golden && !read_golden(vohash, vo_cfg->hash_golden)) {
+		free(vohash);
+		return NULL;
+	}
+
+	struct vo_render *vr = vo_render_new(VO_RENDER_FMT_RGBA8);
+	vr->cmp.colour_killer = vo_cfg->colour_killer;
+	vo_set_renderer(vo, vr);
+
+	size_t npixels = MAX_VIEWPORT_WIDTH * MAX_VIEWPORT_HEIGHT;
+	vohash->pixels = xmalloc(npixels * sizeof(uint32_t));
+	memset(vohash->pixels, 0, npixels * sizeof(uint32_t));
+	vo_render_set_buffer(vr, vohash->pixels);
+
+	vo->free = DELEGATE_AS0(void, vo_hash_free, vohash);
+	vo->set_viewport = DELEGATE_AS2(void, int, int, set_viewport, vohash);
+	vo->vsync = DELEGATE_AS0(void, vsync, vohash);
+
+	// Every frame is hashed, so must be rendered even if skipped for drawing
+	vo->render_all = 1;
+
+	vo_set_viewport(vo, VO_PICTURE_TITLE);
+
+	return vohash;
+}
+
+static void vo_hash_free(void *sptr) {
+	struct vo_hash_interface *vohash = sptr;
+	if (vohash->golden.enabled) {
+		if (vohash->nmismatched) {
+			LOG_WARN("vo hash: %u of %u frames checked did not match\n", vohash->nmismatched, vohash->nchecked);
+		} else {
+			LOG_PRINT("vo hash: %u of %u frames checked, all match\n", vohash->nchecked, vohash->nhashed);
+		}
+	}
+	vo_render_free(vohash->public.renderer);
+	free(vohash->golden.list);
+	free(vohash->pixels);
+	free(vohash);
+}
+
+static void set_viewport(void *sptr, int vp_w, int vp_h) {
+	struct vo_hash_interface *vohash = sptr;
+	struct vo_render *vr = vohash->public.renderer;
+
+	if (vp_w > MAX_VIEWPORT_WIDTH)
+		vp_w = MAX_VIEWPORT_WIDTH;
+	if (vp_h > MAX_VIEWPORT_HEIGHT)
+		vp_h = MAX_VIEWPORT_HEIGHT;
+
+	vo_render_set_viewport(vr, vp_w, vp_h);
+	vr->buffer_pitch = vr->viewport.w;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Hash
+
+#define PRIME64_1 UINT64_C(0x9e3779b185ebca87)
+#define PRIME64_2 UINT64_C(0xc2b2ae3d27d4eb4f)
+#define PRIME64_3 UINT64_C(0x165667b19e3779f9)
+#define PRIME64_4 UINT64_C(0x85ebca77c2b2ae63)
+#define PRIME64_5 UINT64_C(0x27d4eb2f165667c5)
+
+static inline uint64_t rotl64(uint64_t v, int r) {
+	return (v << r) | (v >> (64 - r));
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t v) {
+	acc += v * PRIME64_2;
+	acc = rotl64(acc, 31);
+	return acc * PRIME64_1;
+}
+
+static inline uint64_t hash_merge(uint64_t acc, uint64_t v) {
+	acc ^= hash_round(0, v);
+	return acc * PRIME64_1 + PRIME64_4;
+}
+
+// Two pixels per 64-bit lane, four lanes per round
+
+static uint64_t hash_pixels(uint32_t const *p, unsigned npixels, uint64_t seed) {
+	uint64_t h;
+	unsigned n = npixels;
+	if (n >= 8) {
+		uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+		uint64_t v2 = seed + PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME64_1;
+		for (; n >= 8; n -= 8, p += 8) {
+			v1 = hash_round(v1, (uint64_t)p[0] | ((uint64_t)p[1] << 32));
+			v2 = hash_round(v2, (uint64_t)p[2] | ((uint64_t)p[3] << 32));
+			v3 = hash_round(v3, (uint64_t)p[4] | ((uint64_t)p[5] << 32));
+			v4 = hash_round(v4, (uint64_t)p[6] | ((uint64_t)p[7] << 32));
+		}
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		h = hash_merge(h, v1);
+		h = hash_merge(h, v2);
+		h = hash_merge(h, v3);
+		h = hash_merge(h, v4);
+	} else {
+		h = seed + PRIME64_5;
+	}
+	h += (uint64_t)npixels * 4;
+	for (; n; n--, p++) {
+		h ^= (uint64_t)*p * PRIME64_1;
+		h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+	}
+	h ^= h >> 33;
+	h *= PRIME64_2;
+	h ^= h >> 29;
+	h *= PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Hash every frame, not just those drawn, so that numbering is unaffected by
+// frameskip (which is forced on when rate limiting is disabled).
+
+static void vsync(void *sptr) {
+	struct vo_hash_interface *vohash = sptr;
+	struct vo_render *vr = vohash->public.renderer;
+
+	unsigned frame = ++vohash->frame;
+	if ((frame % vohash->interval) != 0)
+		return;
+
+	// Seed with dimensions, so that a change in viewport always changes
+	// the hash
+	unsigned w = vr->viewport.w;
+	unsigned h = vr->viewport.h;
+	uint64_t hash = hash_pixels(vohash->pixels, w * h, ((uint64_t)w << 16) | h);
+	vohash->nhashed++;
+
+	if (!vohash->golden.enabled) {
+		LOG_PRINT("%u %016" PRIx64 "\n", frame, hash);
+		return;
+	}
+
+	// Skip golden entries for frames that have gone by
+	while (vohash->golden.next < vohash->golden.nentries &&
+	       vohash->golden.list[vohash->golden.next].frame < frame) {
+		vohash->golden.next++;
+	}
+	if (vohash->golden.next >= vohash->golden.nentries)
+		return;
+	struct vo_hash_golden *g = &vohash->golden.list[vohash->golden.next];
+	if (g->frame != frame)
+		return;
+	vohash->golden.next++;
+	vohash->nchecked++;
+	if (g->hash != hash) {
+		vohash->nmismatched++;
+		LOG_WARN("vo hash: frame %u: got %016" PRIx64 ", expected %016" PRIx64 "\n", frame, hash, g->hash);
+	}
+}
+
+// Read golden list.  Lines not of the form "FRAME HASH" are ignored, so the
+// output of a previous run can be used directly.
+
+static _Bool read_golden(struct vo_hash_interface *vohash, const char *filename) {
+	FILE *fd = fopen(filename, "r");
+	if (!fd) {
+		LOG_ERROR("vo hash: can't open golden list '%s'\n", filename);
+		return 0;
+	}
+	unsigned nalloc = 0;
+	char buf[128];
+	while (fgets(buf, sizeof(buf), fd)) {
+		unsigned frame;
+		uint64_t hash;
+		if (sscanf(buf, "%u %" SCNx64, &frame, &hash) != 2)
+			continue;
+		if (vohash->golden.nentries >= nalloc) {
+			nalloc = nalloc ? nalloc * 2 : 256;
+			vohash->golden.list = xrealloc(vohash->golden.list, nalloc * sizeof(*vohash->golden.list));
+		}
+		vohash->golden.list[vohash->golden.nentries++] = (struct vo_hash_golden){ .frame = frame, .hash = hash };
+	}
+	fclose(fd);
+	vohash->golden.enabled = 1;
+	LOG_DEBUG(1, "vo hash: %u golden hashes read from '%s'\n", vohash->golden.nentries, filename);
+	return 1;
+}
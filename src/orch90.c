@@ -92,6 +92,7 @@ static struct part *orch90_allocate(void) {
 	c->detach = orch90_detach;
 	c->has_interface = orch90_has_interface;
 	c->attach_interface = orch90_attach_interface;
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
@@ -69,9 +69,9 @@ static void *new(void *cfg) {
 
 	ao->free = DELEGATE_AS0(void, ao_oss_free, ao);
 
-	const char *device = xroar.cfg.ao.device;
+	const char *device = xroar_cfg.ao.device;
 	if (device) {
-		aooss->sound_fd = open(xroar.cfg.ao.device, O_WRONLY);
+		aooss->sound_fd = open(xroar_cfg.ao.device, O_WRONLY);
 	} else for (unsigned i = 0; i < NUM_DEFAULT_DEVICES; i++) {
 		device = default_devices[i];
 		aooss->sound_fd = open(device, O_WRONLY);
@@ -89,7 +89,7 @@ static void *new(void *cfg) {
 
 	// Find a supported format
 	int desired_format;
-	switch (xroar.cfg.ao.format) {
+	switch (xroar_cfg.ao.format) {
 	case SOUND_FMT_U8:
 		desired_format = AFMT_U8;
 		break;
@@ -151,7 +151,7 @@ static void *new(void *cfg) {
 	}
 
 	// Set stereo if desired
-	int nchannels = xroar.cfg.ao.channels - 1;
+	int nchannels = xroar_cfg.ao.channels - 1;
 	if (nchannels < 0 || nchannels > 1)
 		nchannels = 1;
 	if (ioctl(aooss->sound_fd, SNDCTL_DSP_STEREO, &nchannels) == -1) {
@@ -162,8 +162,8 @@ static void *new(void *cfg) {
 
 	// Set rate
 	unsigned rate = 48000;
-	if (xroar.cfg.ao.rate > 0)
-		rate = xroar.cfg.ao.rate;
+	if (xroar_cfg.ao.rate > 0)
+		rate = xroar_cfg.ao.rate;
 	if (ioctl(aooss->sound_fd, SNDCTL_DSP_SPEED, &rate) == -1) {
 		LOG_ERROR("AO/OSS: SNDCTL_DSP_SPEED failed\n");
 		goto failed;
@@ -176,19 +176,19 @@ static void *new(void *cfg) {
 	int buffer_nframes = 0;
 	int fragment_nframes = 0;
 
-	if (xroar.cfg.ao.fragments >= 2 && xroar.cfg.ao.fragments < 0x8000) {
-		nfragments = xroar.cfg.ao.fragments;
+	if (xroar_cfg.ao.fragments >= 2 && xroar_cfg.ao.fragments < 0x8000) {
+		nfragments = xroar_cfg.ao.fragments;
 	}
 
-	if (xroar.cfg.ao.fragment_ms > 0) {
-		fragment_nframes = (rate * xroar.cfg.ao.fragment_ms) / 1000;
-	} else if (xroar.cfg.ao.fragment_nframes > 0) {
-		fragment_nframes = xroar.cfg.ao.fragment_nframes;
+	if (xroar_cfg.ao.fragment_ms > 0) {
+		fragment_nframes = (rate * xroar_cfg.ao.fragment_ms) / 1000;
+	} else if (xroar_cfg.ao.fragment_nframes > 0) {
+		fragment_nframes = xroar_cfg.ao.fragment_nframes;
 	} else {
-		if (xroar.cfg.ao.buffer_ms > 0) {
-			buffer_nframes = (rate * xroar.cfg.ao.buffer_ms) / 1000;
-		} else if (xroar.cfg.ao.buffer_nframes > 0) {
-			buffer_nframes = xroar.cfg.ao.buffer_nframes;
+		if (xroar_cfg.ao.buffer_ms > 0) {
+			buffer_nframes = (rate * xroar_cfg.ao.buffer_ms) / 1000;
+		} else if (xroar_cfg.ao.buffer_nframes > 0) {
+			buffer_nframes = xroar_cfg.ao.buffer_nframes;
 		} else {
 			buffer_nframes = 1024;
 		}
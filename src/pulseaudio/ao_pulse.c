@@ -14,10 +14,15 @@
  *  See COPYING.GPL for redistribution conditions.
  *
  *  \endlicenseblock
+ *
+ *  The simple API only offers a blocking write, so that is done from a
+ *  separate thread.  Mixed audio is queued in the common audio ring (see
+ *  ao.h), and the writer thread reads a fragment at a time from it.
  */
 
 #include "top-config.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,10 +50,22 @@ struct ao_pulse_interface {
 	struct ao_interface public;
 
 	pa_simple *pa;
+	enum sound_fmt sample_fmt;
+	unsigned fragment_nframes;
 	size_t fragment_nbytes;
 	void *audio_buffer;
+
+	struct ao_ring *ring;
+	float *fragment_buffer;
+
+	pthread_t thread;
+	_Bool thread_running;
+	pthread_mutex_t quit_mutex;
+	_Bool quit;  // tells writer thread to exit
 };
 
+static void *writer_main(void *sptr);
+
 static void ao_pulse_free(void *sptr);
 static void *ao_pulse_write_buffer(void *sptr, void *buffer);
 
@@ -60,7 +77,7 @@ static void *new(void *cfg) {
 
 	ao->free = DELEGATE_AS0(void, ao_pulse_free, ao);
 
-	const char *device = xroar.cfg.ao.device;
+	const char *device = xroar_cfg.ao.device;
 	pa_sample_spec ss = {
 		.format = PA_SAMPLE_S16NE,
 	};
@@ -71,8 +88,8 @@ static void *new(void *cfg) {
 	};
 	int error;
 
-	unsigned rate = (xroar.cfg.ao.rate > 0) ? xroar.cfg.ao.rate : 48000;
-	unsigned nchannels = xroar.cfg.ao.channels;
+	unsigned rate = (xroar_cfg.ao.rate > 0) ? xroar_cfg.ao.rate : 48000;
+	unsigned nchannels = xroar_cfg.ao.channels;
 	if (nchannels < 1 || nchannels > 2)
 		nchannels = 2;
 	ss.rate = rate;
@@ -99,21 +116,21 @@ static void *new(void *cfg) {
 	 * into it.  Use any specified value as "tlength". */
 
 	int fragment_nframes;
-	if (xroar.cfg.ao.fragment_ms > 0) {
-		fragment_nframes = (rate * xroar.cfg.ao.fragment_ms) / 1000;
-	} else if (xroar.cfg.ao.fragment_nframes > 0) {
-		fragment_nframes = xroar.cfg.ao.fragment_nframes;
-	} else if (xroar.cfg.ao.buffer_ms > 0) {
-		fragment_nframes = (rate * xroar.cfg.ao.buffer_ms) / 1000;
-	} else if (xroar.cfg.ao.buffer_nframes > 0) {
-		fragment_nframes = xroar.cfg.ao.buffer_nframes;
+	if (xroar_cfg.ao.fragment_ms > 0) {
+		fragment_nframes = (rate * xroar_cfg.ao.fragment_ms) / 1000;
+	} else if (xroar_cfg.ao.fragment_nframes > 0) {
+		fragment_nframes = xroar_cfg.ao.fragment_nframes;
+	} else if (xroar_cfg.ao.buffer_ms > 0) {
+		fragment_nframes = (rate * xroar_cfg.ao.buffer_ms) / 1000;
+	} else if (xroar_cfg.ao.buffer_nframes > 0) {
+		fragment_nframes = xroar_cfg.ao.buffer_nframes;
 	} else {
 		fragment_nframes = 1024;
 	}
 
 	int nfragments = 2;
-	if (xroar.cfg.ao.fragments > 0) {
-		nfragments = xroar.cfg.ao.fragments;
+	if (xroar_cfg.ao.fragments > 0) {
+		nfragments = xroar_cfg.ao.fragments;
 	}
 	ba.tlength = fragment_nframes * nfragments * frame_nbytes;
 
@@ -124,21 +141,46 @@ static void *new(void *cfg) {
 		goto failed;
 	}
 
+	aopulse->sample_fmt = request_fmt;
+	aopulse->fragment_nframes = fragment_nframes;
 	aopulse->fragment_nbytes = fragment_nframes * sample_nbytes * nchannels;
 	aopulse->audio_buffer = xmalloc(aopulse->fragment_nbytes);
-	ao->sound_interface = sound_interface_new(aopulse->audio_buffer, request_fmt, rate, nchannels, fragment_nframes);
-	if (!ao->sound_interface) {
+
+	// The ring need only cover one fragment being written by the
+	// emulation and one by the writer thread: PulseAudio does the rest of
+	// the buffering.
+	aopulse->ring = ao_ring_new(nchannels, rate, fragment_nframes * 2);
+	aopulse->fragment_buffer = xmalloc(fragment_nframes * nchannels * sizeof(float));
+	memset(aopulse->fragment_buffer, 0, fragment_nframes * nchannels * sizeof(float));
+
+	ao->sound_interface = sound_interface_new(aopulse->fragment_buffer, SOUND_FMT_FLOAT, rate, nchannels, fragment_nframes);
+	if (!aopulse->ring || !ao->sound_interface) {
 		LOG_ERROR("Failed to initialise PulseAudio: XRoar internal error\n");
 		goto failed;
 	}
 	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_pulse_write_buffer, ao);
+
+	aopulse->quit = 0;
+	pthread_mutex_init(&aopulse->quit_mutex, NULL);
+	if (pthread_create(&aopulse->thread, NULL, writer_main, aopulse) != 0) {
+		LOG_ERROR("Failed to initialise PulseAudio: can't create writer thread\n");
+		pthread_mutex_destroy(&aopulse->quit_mutex);
+		goto failed;
+	}
+	aopulse->thread_running = 1;
+
 	LOG_DEBUG(1, "\t%d frags * %d frames/frag = %d frames buffer (%ums)\n", nfragments, fragment_nframes, nfragments * fragment_nframes, (nfragments * fragment_nframes * 1000) / rate);
 	return aopulse;
 
 failed:
 	if (aopulse) {
-		if (aopulse->audio_buffer)
-			free(aopulse->audio_buffer);
+		if (ao->sound_interface)
+			sound_interface_free(ao->sound_interface);
+		if (aopulse->pa)
+			pa_simple_free(aopulse->pa);
+		ao_ring_free(aopulse->ring);
+		free(aopulse->fragment_buffer);
+		free(aopulse->audio_buffer);
 		free(aopulse);
 	}
 	return NULL;
@@ -147,20 +189,48 @@ failed:
 static void ao_pulse_free(void *sptr) {
 	struct ao_pulse_interface *aopulse = sptr;
 
+	if (aopulse->thread_running) {
+		pthread_mutex_lock(&aopulse->quit_mutex);
+		aopulse->quit = 1;
+		pthread_mutex_unlock(&aopulse->quit_mutex);
+		pthread_join(aopulse->thread, NULL);
+		pthread_mutex_destroy(&aopulse->quit_mutex);
+	}
+
 	int error;
 	pa_simple_flush(aopulse->pa, &error);
 	pa_simple_free(aopulse->pa);
 	sound_interface_free(aopulse->public.sound_interface);
+	ao_ring_free(aopulse->ring);
+	free(aopulse->fragment_buffer);
 	free(aopulse->audio_buffer);
 	free(aopulse);
 }
 
 static void *ao_pulse_write_buffer(void *sptr, void *buffer) {
 	struct ao_pulse_interface *aopulse = sptr;
-
-	int error;
-	if (!aopulse->public.sound_interface->ratelimit)
-		return buffer;
-	pa_simple_write(aopulse->pa, buffer, aopulse->fragment_nbytes, &error);
+	ao_ring_write(aopulse->ring, buffer, aopulse->fragment_nframes, aopulse->public.sound_interface->ratelimit);
 	return buffer;
 }
+
+static _Bool writer_quit(struct ao_pulse_interface *aopulse) {
+	pthread_mutex_lock(&aopulse->quit_mutex);
+	_Bool quit = aopulse->quit;
+	pthread_mutex_unlock(&aopulse->quit_mutex);
+	return quit;
+}
+
+// Writer thread.  Blocks in pa_simple_write() until the server wants more.
+
+static void *writer_main(void *sptr) {
+	struct ao_pulse_interface *aopulse = sptr;
+	while (!writer_quit(aopulse)) {
+		ao_ring_read(aopulse->ring, aopulse->audio_buffer, aopulse->sample_fmt, aopulse->fragment_nframes);
+		int error;
+		if (pa_simple_write(aopulse->pa, aopulse->audio_buffer, aopulse->fragment_nbytes, &error) < 0) {
+			LOG_WARN("PulseAudio: write failed: %s\n", pa_strerror(error));
+			break;
+		}
+	}
+	return NULL;
+}
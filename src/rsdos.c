@@ -125,6 +125,7 @@ static struct part *rsdos_allocate(void) {
 	c->reset = rsdos_reset;
 	c->has_interface = rsdos_has_interface;
 	c->attach_interface = rsdos_attach_interface;
+	c->decode_p2r2_only = 1;
 
 	return p;
 }
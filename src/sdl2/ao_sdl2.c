@@ -15,19 +15,17 @@
  *
  *  \endlicenseblock
  *
- *  We now use SDL's queued audio interface.  When writing, we query how much
- *  is left in the queue, and if it's too much we wait a while for the queue to
- *  drain.
+ *  Uses SDL's callback interface.  Mixed audio is queued in the common audio
+ *  ring (see ao.h), and the callback reads from it, converting to whatever
+ *  format the device was opened with.
  */
 
 #include "top-config.h"
 
-#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <SDL.h>
-#include <SDL_thread.h>
 
 #include "c-strcase.h"
 #include "xalloc.h"
@@ -51,26 +49,20 @@ struct ao_sdl2_interface {
 	SDL_AudioDeviceID device;
 	SDL_AudioSpec audiospec;
 
-	void *callback_buffer;
-	_Bool shutting_down;
-
+	enum sound_fmt sample_fmt;
 	unsigned frame_nbytes;
 
 	unsigned nfragments;
-	unsigned fragment_nbytes;
+	unsigned fragment_nframes;
 
-	// Now that the WASAPI driver isn't causing issues in Windows, we
-	// can use SDL's queued audio interface for all builds.
-	void *fragment_buffer;
-	Uint32 qbytes_threshold;
-	unsigned qdelay_divisor;
+	struct ao_ring *ring;
+	float *fragment_buffer;
 };
 
+static void callback(void *userdata, Uint8 *stream, int len);
+
 static void ao_sdl2_free(void *sptr);
 static void *ao_sdl2_write_buffer(void *sptr, void *buffer);
-#ifndef HAVE_WASM
-static void *ao_sdl2_write_silence(void *sptr, void *buffer);
-#endif
 
 static void *new(void *cfg) {
 	(void)cfg;
@@ -107,32 +99,31 @@ static void *new(void *cfg) {
 	unsigned fragment_nframes;
 	unsigned buffer_nframes;
 	unsigned sample_nbytes;
-	enum sound_fmt sample_fmt;
 
-	if (xroar.cfg.ao.rate > 0)
-		rate = xroar.cfg.ao.rate;
+	if (xroar_cfg.ao.rate > 0)
+		rate = xroar_cfg.ao.rate;
 
-	if (xroar.cfg.ao.channels >= 1 && xroar.cfg.ao.channels <= 2)
-		nchannels = xroar.cfg.ao.channels;
+	if (xroar_cfg.ao.channels >= 1 && xroar_cfg.ao.channels <= 2)
+		nchannels = xroar_cfg.ao.channels;
 
 	aosdl->nfragments = 3;
-	if (xroar.cfg.ao.fragments >= 0 && xroar.cfg.ao.fragments <= 64)
-		aosdl->nfragments = xroar.cfg.ao.fragments;
+	if (xroar_cfg.ao.fragments >= 0 && xroar_cfg.ao.fragments <= 64)
+		aosdl->nfragments = xroar_cfg.ao.fragments;
 
 	if (aosdl->nfragments == 0)
 		aosdl->nfragments++;
 
 	unsigned buf_nfragments = aosdl->nfragments ? aosdl->nfragments : 1;
 
-	if (xroar.cfg.ao.fragment_ms > 0) {
-		fragment_nframes = (rate * xroar.cfg.ao.fragment_ms) / 1000;
-	} else if (xroar.cfg.ao.fragment_nframes > 0) {
-		fragment_nframes = xroar.cfg.ao.fragment_nframes;
+	if (xroar_cfg.ao.fragment_ms > 0) {
+		fragment_nframes = (rate * xroar_cfg.ao.fragment_ms) / 1000;
+	} else if (xroar_cfg.ao.fragment_nframes > 0) {
+		fragment_nframes = xroar_cfg.ao.fragment_nframes;
 	} else {
-		if (xroar.cfg.ao.buffer_ms > 0) {
-			buffer_nframes = (rate * xroar.cfg.ao.buffer_ms) / 1000;
-		} else if (xroar.cfg.ao.buffer_nframes > 0) {
-			buffer_nframes = xroar.cfg.ao.buffer_nframes;
+		if (xroar_cfg.ao.buffer_ms > 0) {
+			buffer_nframes = (rate * xroar_cfg.ao.buffer_ms) / 1000;
+		} else if (xroar_cfg.ao.buffer_nframes > 0) {
+			buffer_nframes = xroar_cfg.ao.buffer_nframes;
 		} else {
 			buffer_nframes = 1024 * buf_nfragments;
 		}
@@ -142,10 +133,10 @@ static void *new(void *cfg) {
 	desired.freq = rate;
 	desired.channels = nchannels;
 	desired.samples = fragment_nframes;
-	desired.callback = NULL;
+	desired.callback = callback;
 	desired.userdata = aosdl;
 
-	switch (xroar.cfg.ao.format) {
+	switch (xroar_cfg.ao.format) {
 	case SOUND_FMT_U8:
 		desired.format = AUDIO_U8;
 		break;
@@ -175,10 +166,10 @@ static void *new(void *cfg) {
 
 	// First allow format changes, if format not explicitly specified
 	int allowed_changes = 0;
-	if (xroar.cfg.ao.format == SOUND_FMT_NULL) {
+	if (xroar_cfg.ao.format == SOUND_FMT_NULL) {
 		allowed_changes = SDL_AUDIO_ALLOW_FORMAT_CHANGE;
 	}
-	aosdl->device = SDL_OpenAudioDevice(xroar.cfg.ao.device, 0, &desired, &aosdl->audiospec, allowed_changes);
+	aosdl->device = SDL_OpenAudioDevice(xroar_cfg.ao.device, 0, &desired, &aosdl->audiospec, allowed_changes);
 
 	// Check the format is supported
 	if (aosdl->device == 0) {
@@ -199,7 +190,7 @@ static void *new(void *cfg) {
 
 	// One last try, allowing any changes.  Check the format is sensible later.
 	if (aosdl->device == 0) {
-		aosdl->device = SDL_OpenAudioDevice(xroar.cfg.ao.device, 0, &desired, &aosdl->audiospec, SDL_AUDIO_ALLOW_ANY_CHANGE);
+		aosdl->device = SDL_OpenAudioDevice(xroar_cfg.ao.device, 0, &desired, &aosdl->audiospec, SDL_AUDIO_ALLOW_ANY_CHANGE);
 		if (aosdl->device == 0) {
 			LOG_ERROR("Couldn't open audio: %s\n", SDL_GetError());
 			SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -213,11 +204,11 @@ static void *new(void *cfg) {
 	fragment_nframes = aosdl->audiospec.samples;
 
 	switch (aosdl->audiospec.format) {
-		case AUDIO_U8: sample_fmt = SOUND_FMT_U8; sample_nbytes = 1; break;
-		case AUDIO_S8: sample_fmt = SOUND_FMT_S8; sample_nbytes = 1; break;
-		case AUDIO_S16LSB: sample_fmt = SOUND_FMT_S16_LE; sample_nbytes = 2; break;
-		case AUDIO_S16MSB: sample_fmt = SOUND_FMT_S16_BE; sample_nbytes = 2; break;
-		case AUDIO_F32SYS: sample_fmt = SOUND_FMT_FLOAT; sample_nbytes = 4; break;
+		case AUDIO_U8: aosdl->sample_fmt = SOUND_FMT_U8; sample_nbytes = 1; break;
+		case AUDIO_S8: aosdl->sample_fmt = SOUND_FMT_S8; sample_nbytes = 1; break;
+		case AUDIO_S16LSB: aosdl->sample_fmt = SOUND_FMT_S16_LE; sample_nbytes = 2; break;
+		case AUDIO_S16MSB: aosdl->sample_fmt = SOUND_FMT_S16_BE; sample_nbytes = 2; break;
+		case AUDIO_F32SYS: aosdl->sample_fmt = SOUND_FMT_FLOAT; sample_nbytes = 4; break;
 		default:
 			LOG_WARN("Unhandled audio format 0x%x.\n", aosdl->audiospec.format);
 			goto failed;
@@ -225,29 +216,29 @@ static void *new(void *cfg) {
 
 	buffer_nframes = fragment_nframes * buf_nfragments;
 	aosdl->frame_nbytes = nchannels * sample_nbytes;
-	aosdl->fragment_nbytes = fragment_nframes * aosdl->frame_nbytes;
-
-	// If any more than (n-1) fragments (measured in bytes) are in
-	// the queue, we will wait.
-	aosdl->qbytes_threshold = aosdl->fragment_nbytes * (aosdl->nfragments - 1);
-	aosdl->qdelay_divisor = aosdl->frame_nbytes * rate;
-
-	aosdl->shutting_down = 0;
-	aosdl->callback_buffer = NULL;
+	aosdl->fragment_nframes = fragment_nframes;
+
+	// The ring needs to hold at least one fragment from the emulation
+	// while the device holds another.
+	unsigned target_nframes = buffer_nframes;
+	if (target_nframes < fragment_nframes * 2)
+		target_nframes = fragment_nframes * 2;
+	aosdl->ring = ao_ring_new(nchannels, rate, target_nframes);
+	if (!aosdl->ring) {
+		LOG_ERROR("Failed to initialise SDL audio: XRoar internal error\n");
+		goto failed;
+	}
 
-	aosdl->fragment_buffer = xmalloc(aosdl->fragment_nbytes);
-	uint8_t zero = (aosdl->audiospec.format == AUDIO_U8) ? 0x80 : 0x00;
-	memset(aosdl->fragment_buffer, zero, aosdl->fragment_nbytes);
+	aosdl->fragment_buffer = xmalloc(fragment_nframes * nchannels * sizeof(float));
+	memset(aosdl->fragment_buffer, 0, fragment_nframes * nchannels * sizeof(float));
 
-	ao->sound_interface = sound_interface_new(NULL, sample_fmt, rate, nchannels, fragment_nframes);
+	// Emulation always mixes in float; the ring converts for the device
+	ao->sound_interface = sound_interface_new(aosdl->fragment_buffer, SOUND_FMT_FLOAT, rate, nchannels, fragment_nframes);
 	if (!ao->sound_interface) {
 		LOG_ERROR("Failed to initialise SDL audio: XRoar internal error\n");
 		goto failed;
 	}
 	ao->sound_interface->write_buffer = DELEGATE_AS1(voidp, voidp, ao_sdl2_write_buffer, ao);
-#ifndef HAVE_WASM
-	ao->sound_interface->write_silence = DELEGATE_AS1(voidp, voidp, ao_sdl2_write_silence, ao);
-#endif
 	LOG_DEBUG(1, "\t%u frags * %u frames/frag = %u frames buffer (%.1fms)\n", buf_nfragments, fragment_nframes, buffer_nframes, (float)(buffer_nframes * 1000) / rate);
 
 	SDL_PauseAudioDevice(aosdl->device, 0);
@@ -256,9 +247,8 @@ static void *new(void *cfg) {
 failed:
 	if (aosdl) {
 		SDL_CloseAudioDevice(aosdl->device);
-		if (aosdl->fragment_buffer) {
-			free(aosdl->fragment_buffer);
-		}
+		ao_ring_free(aosdl->ring);
+		free(aosdl->fragment_buffer);
 		free(aosdl);
 	}
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -267,7 +257,6 @@ failed:
 
 static void ao_sdl2_free(void *sptr) {
 	struct ao_sdl2_interface *aosdl = sptr;
-	aosdl->shutting_down = 1;
 
 	// no more audio
 	SDL_PauseAudioDevice(aosdl->device, 1);
@@ -276,51 +265,18 @@ static void ao_sdl2_free(void *sptr) {
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
 	sound_interface_free(aosdl->public.sound_interface);
-
-	if (aosdl->nfragments > 0) {
-		free(aosdl->fragment_buffer);
-	}
-
+	ao_ring_free(aosdl->ring);
+	free(aosdl->fragment_buffer);
 	free(aosdl);
 }
 
 static void *ao_sdl2_write_buffer(void *sptr, void *buffer) {
 	struct ao_sdl2_interface *aosdl = sptr;
-	(void)buffer;
-
-	if (!aosdl->public.sound_interface->ratelimit) {
-		return NULL;
-	}
-
-	// For WebAssembly, if there's too much audio already in the queue,
-	// just purge it - doesn't happen much, due to the way Wasm runs.
-	// Otherwise wait an appropriate amount of time for the queue to drain.
-
-	Uint32 qbytes = SDL_GetQueuedAudioSize(aosdl->device);
-	if (qbytes > aosdl->qbytes_threshold) {
-#ifndef HAVE_WASM
-		int ms = ((qbytes - aosdl->qbytes_threshold) * 1000) / aosdl->qdelay_divisor;
-		if (ms >= 10) {
-			SDL_Delay(ms);
-		}
-#else
-		return NULL;
-#endif
-	}
-	SDL_QueueAudio(aosdl->device, aosdl->fragment_buffer, aosdl->fragment_nbytes);
-	return aosdl->fragment_buffer;
-
+	ao_ring_write(aosdl->ring, buffer, aosdl->fragment_nframes, aosdl->public.sound_interface->ratelimit);
+	return buffer;
 }
 
-#ifndef HAVE_WASM
-static void *ao_sdl2_write_silence(void *sptr, void *buffer) {
-	struct ao_sdl2_interface *aosdl = sptr;
-	(void)buffer;
-
-	Uint32 qbytes = SDL_GetQueuedAudioSize(aosdl->device);
-	if (qbytes < aosdl->qbytes_threshold) {
-		SDL_QueueAudio(aosdl->device, aosdl->fragment_buffer, aosdl->fragment_nbytes);
-	}
-	return aosdl->fragment_buffer;
+static void callback(void *userdata, Uint8 *stream, int len) {
+	struct ao_sdl2_interface *aosdl = userdata;
+	ao_ring_read(aosdl->ring, stream, aosdl->sample_fmt, len / aosdl->frame_nbytes);
 }
-#endif
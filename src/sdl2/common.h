@@ -55,6 +55,9 @@ void ui_sdl_init(struct ui_sdl2_interface *, struct ui_cfg *ui_cfg);
 void ui_sdl_free(void *);
 void ui_sdl_run(void *);
 
+// Show effective frame rate in the window title (0 restores plain title)
+void ui_sdl_update_frame_rate(struct ui_sdl2_interface *, int fps);
+
 _Bool sdl_vo_init(struct ui_sdl2_interface *);
 void sdl_keyboard_init(struct ui_sdl2_interface *);
 
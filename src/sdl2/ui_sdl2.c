@@ -109,12 +109,25 @@ void ui_sdl_run(void *sptr) {
 	}
 }
 
+void ui_sdl_update_frame_rate(struct ui_sdl2_interface *uisdl2, int fps) {
+	if (!uisdl2->vo_window)
+		return;
+	if (fps > 0) {
+		char title[32];
+		snprintf(title, sizeof(title), "XRoar (%d fps)", fps);
+		SDL_SetWindowTitle(uisdl2->vo_window, title);
+	} else {
+		SDL_SetWindowTitle(uisdl2->vo_window, "XRoar");
+	}
+}
+
 static void ui_sdl_update_state(void *sptr, int tag, int value, const void *data) {
 	struct ui_sdl2_interface *uisdl2 = sptr;
-	(void)uisdl2;
-	(void)value;
 	(void)data;
 	switch (tag) {
+	case ui_tag_frame_rate:
+		ui_sdl_update_frame_rate(uisdl2, value);
+		break;
 	default:
 		break;
 	}
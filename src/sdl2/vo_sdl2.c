@@ -60,6 +60,10 @@ struct vo_sdl_interface {
 
 		// Pixel buffer
 		void *pixels;
+
+		// Set when the whole texture needs updating, not just the rows
+		// the renderer reports as changed
+		_Bool update_all;
 	} texture;
 
 	SDL_Renderer *sdl_renderer;
@@ -297,6 +301,7 @@ static void recreate_texture(struct ui_sdl2_interface *uisdl2) {
 	}
 
 	vr->buffer_pitch = vr->viewport.w;
+	vosdl->texture.update_all = 1;
 }
 
 // Update viewport based on requested dimensions and 60Hz scaling.
@@ -482,7 +487,36 @@ static void draw(void *sptr) {
 	struct vo_sdl_interface *vosdl = (struct vo_sdl_interface *)vo;
 	struct vo_render *vr = vo->renderer;
 
-	SDL_UpdateTexture(vosdl->texture.texture, NULL, vosdl->texture.pixels, vr->viewport.w * vosdl->texture.pixel_size);
+	// Only update rows that the renderer has changed since last time
+	int y0, y1;
+	vo_render_take_dirty(vr, &y0, &y1);
+	if (vosdl->texture.update_all) {
+		y0 = 0;
+		y1 = vr->viewport.h;
+		vosdl->texture.update_all = 0;
+	}
+	if (y1 > vr->viewport.h)
+		y1 = vr->viewport.h;
+
+	// Rows are copied into the locked texture rather than rendered there
+	// directly, as unchanged rows are not re-rendered, and the contents
+	// of a locked texture are undefined.
+	if (y0 < y1) {
+		SDL_Rect rect = { .x = 0, .y = y0, .w = vr->viewport.w, .h = y1 - y0 };
+		void *dest;
+		int dest_pitch;
+		if (SDL_LockTexture(vosdl->texture.texture, &rect, &dest, &dest_pitch) == 0) {
+			size_t src_pitch = vr->viewport.w * vosdl->texture.pixel_size;
+			uint8_t const *src = (uint8_t *)vosdl->texture.pixels + y0 * src_pitch;
+			for (int y = y0; y < y1; y++) {
+				memcpy(dest, src, src_pitch);
+				dest = (uint8_t *)dest + dest_pitch;
+				src += src_pitch;
+			}
+			SDL_UnlockTexture(vosdl->texture.texture);
+		}
+	}
+
 	SDL_RenderClear(vosdl->sdl_renderer);
 	SDL_RenderCopy(vosdl->sdl_renderer, vosdl->texture.texture, NULL, NULL);
 	SDL_RenderPresent(vosdl->sdl_renderer);
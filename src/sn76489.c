@@ -353,6 +353,10 @@ void sn76489_write(struct SN76489 *csg, uint32_t tick, uint8_t D) {
 	update_reg(csg_, reg_sel, reg_val);
 }
 
+// Maximum number of ticks filtered at once when processing a block
+
+#define BLOCK_NTICKS (256)
+
 float sn76489_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 	struct SN76489_private *csg_ = sptr;
 	struct SN76489 *csg = &csg_->public;
@@ -378,6 +382,73 @@ float sn76489_get_audio(void *sptr, uint32_t tick, int nframes, float *buf) {
 
 	while (nticks > 0) {
 
+		// Ticks until the next counter expiry.  Nothing changes state
+		// before then, so all the ticks up to it can be processed as a
+		// block with constant input to the filter.
+		unsigned run = csg_->counter[0];
+		if (csg_->counter[1] < run)
+			run = csg_->counter[1];
+		if (csg_->counter[2] < run)
+			run = csg_->counter[2];
+		if (!csg_->noise_tone3 && csg_->counter[3] < run)
+			run = csg_->counter[3];
+
+		if (run > 1) {
+			// Limit to the ticks remaining in this call.  Equivalent to
+			// the per-tick accounting below.
+			int64_t need = (int64_t)nticks * csg_->refrate - csg_->tickerror;
+			int64_t nleft = (need + csg_->tickrate - 1) / csg_->tickrate;
+			unsigned nidle = run - 1;
+			if (nleft < 1)
+				nleft = 1;
+			if (nleft < nidle)
+				nidle = nleft;
+
+			int64_t tickerror = csg_->tickerror + (int64_t)nidle * csg_->tickrate;
+			nticks -= tickerror / csg_->refrate;
+			csg_->tickerror = tickerror % csg_->refrate;
+
+			for (int c = 0; c < 3; c++) {
+				csg_->counter[c] -= nidle;
+			}
+			if (!csg_->noise_tone3) {
+				csg_->counter[3] -= nidle;
+			}
+
+			new_output = csg_->level[0] + csg_->level[1] +
+			             csg_->level[2] + csg_->level[3];
+
+			// Filter the block, then pick out output samples where they
+			// fall.  Each is the filter output from before the tick it
+			// falls on.
+			while (nidle > 0) {
+				float tick_output[BLOCK_NTICKS];
+				unsigned nblock = (nidle < BLOCK_NTICKS) ? nidle : BLOCK_NTICKS;
+				float prev_output = output;
+				output = filter_iir_apply_n(csg_->filter, new_output, nblock, tick_output);
+				for (unsigned i = 0; i < nblock; i++) {
+					csg_->frameerror += csg_->framerate;
+					if (csg_->frameerror >= csg_->refrate) {
+						csg_->frameerror -= csg_->refrate;
+						if (nframes > 0) {
+							if (buf) {
+								*(buf++) = i ? tick_output[i-1] : prev_output;
+							}
+							nframes--;
+						} else {
+							csg_->overrun = 1;
+						}
+					}
+				}
+				nidle -= nblock;
+			}
+
+			if (nticks <= 0)
+				break;
+		}
+
+		// Single tick in which at least one counter expires
+
 		// framerate will *always* be less than refrate, so this is a
 		// simple test.  allow for 1 overrun sample.
 		csg_->frameerror += csg_->framerate;
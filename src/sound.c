@@ -28,8 +28,10 @@
 
 #include "delegate.h"
 #include "pl-endian.h"
+#include "pl-once.h"
 #include "xalloc.h"
 
+#include "capture.h"
 #include "events.h"
 #include "logging.h"
 #include "module.h"
@@ -37,6 +39,24 @@
 #include "tape.h"
 #include "xroar.h"
 
+#ifndef M_PI
+# define M_PI 3.14159265358979323846
+#endif
+
+// Band-limited step synthesis.  Each change in a stepped level is spread
+// over BLEP_NTAPS output frames by a windowed sinc kernel, chosen from
+// BLEP_NPHASES sub-frame positions.
+#define BLEP_NTAPS (16)
+#define BLEP_NPHASES (32)
+#define BLEP_CUTOFF (0.45)
+
+// Levels are accumulated in fixed-point, so that the running sum can't drift
+#define BLEP_SCALE (1 << 20)
+
+static float blep_kernel[BLEP_NPHASES][BLEP_NTAPS];
+
+extern inline float sound_clip(float v);
+
 static void flush_buffer(void *sptr);
 
 struct sound_interface_private {
@@ -101,6 +121,20 @@ struct sound_interface_private {
 	// set_volume().  Defaults to -3 dBFS.
 	float gain;
 
+	// If set, each mixed buffer is also passed here
+	struct capture *capture;
+
+	// Changes in level to be summed into the output, one array per output
+	// channel.  Each covers the buffer plus the width of the step kernel.
+	// Stepped sources (DAC, tape, single-bit sound, external) insert a
+	// band-limited step when they change.  Per-frame sources (cartridge,
+	// AY, non-muxed) insert the difference between frames, delayed to
+	// match the centre of the step kernel.
+	int32_t *delta[2];
+	int32_t delta_sum[2];  // running sum at start of buffer
+	int32_t step_level[2];  // current level of stepped sources
+	int32_t frame_level;  // last level of per-frame sources
+
 };
 
 enum sound_source {
@@ -149,6 +183,37 @@ static const float source_offset_v[NUM_SOURCES][3] = {
 	{ 0.00/MAX_V, 0.00/MAX_V, 3.90/MAX_V }   // Single-bit
 };
 
+// Compute the step kernel.  Entry 'k' of each phase is the change in level
+// at output frame k after the step, with the step centred at BLEP_NTAPS/2.
+// Blackman-windowed sinc, normalised so each phase sums to 1.
+
+static void blep_kernel_compute(void) {
+	for (int p = 0; p < BLEP_NPHASES; p++) {
+		double f = (p + 0.5) / BLEP_NPHASES;
+		double h[BLEP_NTAPS];
+		double sum = 0.0;
+		for (int k = 0; k < BLEP_NTAPS; k++) {
+			double t = k + 1 - f;
+			double x = 2.0 * M_PI * BLEP_CUTOFF * (t - BLEP_NTAPS / 2);
+			double w = 0.42 - 0.5 * cos(2.0 * M_PI * t / BLEP_NTAPS) + 0.08 * cos(4.0 * M_PI * t / BLEP_NTAPS);
+			h[k] = ((x == 0.0) ? 1.0 : sin(x) / x) * w;
+			sum += h[k];
+		}
+		for (int k = 0; k < BLEP_NTAPS; k++) {
+			blep_kernel[p][k] = h[k] / sum;
+		}
+	}
+}
+
+// The kernel is shared by all sound interfaces, which may be created from
+// different threads, so it is computed exactly once.
+
+static pl_once_t blep_kernel_once = PL_ONCE_INIT;
+
+static void blep_kernel_init(void) {
+	pl_once(&blep_kernel_once, blep_kernel_compute);
+}
+
 struct sound_interface *sound_interface_new(void *buf, enum sound_fmt fmt, unsigned rate,
 					    unsigned nchannels, unsigned nframes) {
 	struct sound_interface_private *snd = xmalloc(sizeof(*snd));
@@ -242,6 +307,12 @@ struct sound_interface *sound_interface_new(void *buf, enum sound_fmt fmt, unsig
 		snd->non_muxed_output[j] = 0.0;
 	}
 
+	blep_kernel_init();
+	for (unsigned c = 0; c < nchannels; c++) {
+		snd->delta[c] = xmalloc((nframes + BLEP_NTAPS) * sizeof(int32_t));
+		memset(snd->delta[c], 0, (nframes + BLEP_NTAPS) * sizeof(int32_t));
+	}
+
 	snd->last_cycle = event_current_tick;
 
 	event_init(&snd->flush_event, DELEGATE_AS0(void, flush_buffer, snd));
@@ -262,36 +333,92 @@ void sound_interface_free(struct sound_interface *sndp) {
 	for (unsigned i = 0; i < 5; i++) {
 		free(snd->mux_input[i]);
 	}
+	for (int c = 0; c < snd->output_nchannels; c++) {
+		free(snd->delta[c]);
+	}
 	free(snd);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// Sum the first 'nframes' deltas into the mix buffer (if not NULL), then move
+// the rest to the start.
+
+static void integrate_deltas(struct sound_interface_private *snd, unsigned nframes, float *mix_buffer) {
+	int nchannels = snd->output_nchannels;
+	float scale = snd->gain / BLEP_SCALE;
+	for (int c = 0; c < nchannels; c++) {
+		int32_t *delta = snd->delta[c];
+		int32_t sum = snd->delta_sum[c];
+		if (mix_buffer) {
+			float *ptr = mix_buffer + c;
+			for (unsigned i = 0; i < nframes; i++) {
+				sum += delta[i];
+				*ptr = sum * scale;
+				ptr += nchannels;
+			}
+		} else {
+			for (unsigned i = 0; i < nframes; i++) {
+				sum += delta[i];
+			}
+		}
+		snd->delta_sum[c] = sum;
+		memmove(delta, delta + nframes, (snd->buffer_nframes + BLEP_NTAPS - nframes) * sizeof(int32_t));
+		memset(delta + snd->buffer_nframes + BLEP_NTAPS - nframes, 0, nframes * sizeof(int32_t));
+	}
+}
+
+// Insert a band-limited step to a new level for one output channel at the
+// current point in the buffer.  'phase' is the sub-frame position of the
+// step.  The last entry of the kernel absorbs rounding error, so the steps
+// always sum to exactly the change in level.
+
+static void insert_step(struct sound_interface_private *snd, int c, int32_t level, unsigned phase) {
+	int32_t dlevel = level - snd->step_level[c];
+	if (dlevel == 0)
+		return;
+	snd->step_level[c] = level;
+	int32_t *delta = snd->delta[c] + snd->buffer_frame;
+	float const *kernel = blep_kernel[phase];
+	int32_t sum = 0;
+	for (int k = 0; k < BLEP_NTAPS - 1; k++) {
+		int32_t d = lrintf(dlevel * kernel[k]);
+		delta[k] += d;
+		sum += d;
+	}
+	delta[BLEP_NTAPS - 1] += dlevel - sum;
+}
+
 // convert buffer to desired output format and send it to audio module
 static void send_buffer(struct sound_interface_private *snd) {
+	integrate_deltas(snd, snd->buffer_nframes,
+			 (snd->output_buffer || snd->capture) ? snd->mix_buffer : NULL);
 	int nsamples = snd->output_nchannels * snd->buffer_nframes;
+	if (snd->capture && snd->mix_buffer) {
+		capture_audio(snd->capture, snd->mix_buffer, snd->buffer_nframes, snd->output_nchannels, snd->public.framerate);
+	}
 	if (snd->output_buffer && snd->mix_buffer) {
 		float *input = snd->mix_buffer;
 		switch (snd->output_fmt) {
 		case SOUND_FMT_U8: {
 			int8_t *output = snd->output_buffer;
 			for (int i = nsamples; i; i--)
-				*(output++) = *(input++) * 0x7f + 0x80;
+				*(output++) = sound_clip(*(input++)) * 0x7f + 0x80;
 		} break;
 		case SOUND_FMT_S8: {
 			uint8_t *output = snd->output_buffer;
 			for (int i = nsamples; i; i--)
-				*(output++) = *(input++) * 0x7f;
+				*(output++) = sound_clip(*(input++)) * 0x7f;
 		} break;
 		case SOUND_FMT_S16_HE: {
 			int16_t *output = snd->output_buffer;
 			for (int i = nsamples; i; i--)
-				*(output++) = *(input++) * 0x7fff;
+				*(output++) = sound_clip(*(input++)) * 0x7fff;
 		} break;
 		case SOUND_FMT_S16_SE: {
 			uint8_t *output = snd->output_buffer;
 			for (int i = nsamples; i; i--) {
-				int16_t v = *(input++) * 0x7fff;
+				int16_t v = sound_clip(*(input++)) * 0x7fff;
 				*(output++) = *((uint8_t *)&v+1);
 				*(output++) = *(uint8_t *)&v;
 			}
@@ -351,6 +478,9 @@ void sound_send_silence(struct sound_interface *sndp) {
 		snd->output_buffer_is_silent = 1;
 	}
 
+	// Anything in the buffer so far is discarded
+	integrate_deltas(snd, snd->buffer_frame, NULL);
+
 	snd->output_buffer = DELEGATE_CALL(snd->public.write_silence, snd->output_buffer);
 	if (snd->output_fmt == SOUND_FMT_FLOAT) {
 		// No need to convert floats, point mix buffer at output buffer.
@@ -359,6 +489,21 @@ void sound_send_silence(struct sound_interface *sndp) {
 	snd->buffer_frame = 0;
 }
 
+// Sources that are generated per output frame, rather than being stepped
+// between levels.
+
+static _Bool mux_source_is_per_frame(struct sound_interface_private *snd, unsigned source) {
+	switch (source) {
+	case SOURCE_TAPE:
+		return DELEGATE_DEFINED(snd->public.get_tape_audio);
+	case SOURCE_CART:
+	case SOURCE_AY:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 // Fill sound buffer to current point in time, sending to audio module when full.
 
 void sound_update(struct sound_interface *sndp) {
@@ -384,10 +529,14 @@ void sound_update(struct sound_interface *sndp) {
 		mux_source = SOURCE_NONE;
 	}
 
+	// External sources are only rendered when audio is being played in real
+	// time, or captured, or the audio module asks for everything
+	_Bool generate = sndp->ratelimit || snd->capture || sndp->render_all;
+
 	// Always run external sources so they're up to date, even though we'll
 	// only use one of them.
 	if (DELEGATE_DEFINED(sndp->get_tape_audio)) {
-		if (mux_source == SOURCE_TAPE && sndp->ratelimit) {
+		if (mux_source == SOURCE_TAPE && generate) {
 			snd->mux_input_raw[SOURCE_TAPE] = DELEGATE_CALL(sndp->get_tape_audio, event_current_tick, nframes, snd->mux_input[SOURCE_TAPE]);
 		} else {
 			snd->mux_input_raw[SOURCE_TAPE] = DELEGATE_CALL(sndp->get_tape_audio, event_current_tick, nframes, NULL);
@@ -396,16 +545,12 @@ void sound_update(struct sound_interface *sndp) {
 			}
 		}
 	} else if (mux_source == SOURCE_TAPE) {
-		// Fill tape buffer.  This functionality should be pushed out into the
-		// get_tape_audio delegate.
-		for (unsigned i = 0; i < nframes; i++) {
-			snd->mux_input[SOURCE_TAPE][i] = snd->mux_input_raw[SOURCE_TAPE];
-		}
+		// Tape level is a stepped source, see below
 		snd->mux_input_raw[SOURCE_TAPE] = snd->tape_level;
 	}
 
 	if (DELEGATE_DEFINED(sndp->get_cart_audio)) {
-		if (mux_source == SOURCE_CART && sndp->ratelimit) {
+		if (mux_source == SOURCE_CART && generate) {
 			snd->mux_input_raw[SOURCE_CART] = DELEGATE_CALL(sndp->get_cart_audio, event_current_tick, nframes, snd->mux_input[SOURCE_CART]);
 		} else {
 			snd->mux_input_raw[SOURCE_CART] = DELEGATE_CALL(sndp->get_cart_audio, event_current_tick, nframes, NULL);
@@ -418,7 +563,7 @@ void sound_update(struct sound_interface *sndp) {
 	}
 
 	if (DELEGATE_DEFINED(sndp->get_ay_audio)) {
-		if (mux_source == SOURCE_AY && sndp->ratelimit) {
+		if (mux_source == SOURCE_AY && generate) {
 			snd->mux_input_raw[SOURCE_AY] = DELEGATE_CALL(sndp->get_ay_audio, event_current_tick, nframes, snd->mux_input[SOURCE_AY]);
 		} else {
 			snd->mux_input_raw[SOURCE_AY] = DELEGATE_CALL(sndp->get_ay_audio, event_current_tick, nframes, NULL);
@@ -436,18 +581,16 @@ void sound_update(struct sound_interface *sndp) {
 		DELEGATE_CALL(sndp->get_non_muxed_audio, event_current_tick, nframes, non_muxed_output);
 	}
 
-	// Only fill DAC buffer if it's selected
-	if (mux_source == SOURCE_DAC) {
-		for (unsigned i = 0; i < nframes; i++) {
-			snd->mux_input[SOURCE_DAC][i] = snd->mux_input_raw[SOURCE_DAC];
-		}
-	}
+	// DAC level is a stepped source, see below
 	snd->mux_input_raw[SOURCE_DAC] = snd->dac_level;
 
-	// Select appropriate mux output, or none
-	float *mux_output = snd->mux_input[mux_source];
+	// Per-frame mux output, if any
+	float *mux_output = NULL;
+	if (mux_source_is_per_frame(snd, mux_source)) {
+		mux_output = snd->mux_input[mux_source];
+	}
 
-	// Mix audio, send when buffer full
+	// Add per-frame sources to the deltas, send when buffer full
 	while (nframes > 0) {
 		int count;
 		if ((snd->buffer_frame + nframes) > snd->buffer_nframes)
@@ -455,17 +598,29 @@ void sound_update(struct sound_interface *sndp) {
 		else
 			count = nframes;
 		nframes -= count;
-		if (snd->output_buffer && snd->mix_buffer) {
-			float *ptr = (float *)snd->mix_buffer + snd->buffer_frame * snd->output_nchannels;
+		unsigned frame = snd->buffer_frame + BLEP_NTAPS / 2;
+		if (mux_output || non_muxed_output) {
+			int32_t level = snd->frame_level;
 			for (int i = 0; i < count; i++) {
-				float mix_sample = (*(mux_output++) * snd->mux_gain) + snd->bus_offset;
+				float mix_sample = 0.0;
+				if (mux_output) {
+					mix_sample = *(mux_output++) * snd->mux_gain;
+				}
 				if (non_muxed_output) {
 					mix_sample += *(non_muxed_output++);
 				}
-				for (int j = 0; j < snd->output_nchannels; j++) {
-					*(ptr++) = (mix_sample + snd->current.external[j]) * snd->gain;
+				int32_t new_level = lrintf(mix_sample * BLEP_SCALE);
+				for (int c = 0; c < snd->output_nchannels; c++) {
+					snd->delta[c][frame + i] += new_level - level;
 				}
+				level = new_level;
+			}
+			snd->frame_level = level;
+		} else if (snd->frame_level != 0) {
+			for (int c = 0; c < snd->output_nchannels; c++) {
+				snd->delta[c][frame] -= snd->frame_level;
 			}
+			snd->frame_level = 0;
 		}
 		snd->buffer_frame += count;
 		if (snd->buffer_frame >= snd->buffer_nframes) {
@@ -513,6 +668,17 @@ void sound_update(struct sound_interface *sndp) {
 	snd->bus_level = (mux_output_raw * snd->mux_gain) + snd->bus_offset;
 	DELEGATE_SAFE_CALL(snd->public.sbs_feedback, snd->current.sbs_enabled || snd->bus_level >= 0.3);
 
+	// Everything other than per-frame sources contributes a step at the
+	// current sub-frame position.
+	float step_level = snd->bus_offset;
+	if (snd->current.mux_enabled && !mux_source_is_per_frame(snd, snd->current.mux_source)) {
+		step_level = snd->bus_level;
+	}
+	unsigned phase = ((int64_t)snd->frameerror * BLEP_NPHASES) / EVENT_TICK_RATE;
+	for (int c = 0; c < snd->output_nchannels; c++) {
+		insert_step(snd, c, lrintf((step_level + snd->current.external[c]) * BLEP_SCALE), phase);
+	}
+
 }
 
 // Rate limit control
@@ -520,6 +686,12 @@ void sound_set_ratelimit(struct sound_interface *sndp, _Bool ratelimit) {
 	sndp->ratelimit = ratelimit;
 }
 
+// Capture mixed audio
+void sound_set_capture(struct sound_interface *sndp, struct capture *capture) {
+	struct sound_interface_private *snd = (struct sound_interface_private *)sndp;
+	snd->capture = capture;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 // Sets the overall gain applied after mixing sources.  Generally a negative
@@ -24,6 +24,8 @@
 
 #include "delegate.h"
 
+struct capture;
+
 enum sound_fmt {
 	SOUND_FMT_NULL,
 	SOUND_FMT_U8,
@@ -38,6 +40,7 @@ enum sound_fmt {
 struct sound_interface {
 	int framerate;  // output rate
 	_Bool ratelimit;  // ratelimit
+	_Bool render_all;  // render all sources even when not rate limited
 	DELEGATE_T1(void, bool) sbs_feedback;  // single-bit sound feedback
 	DELEGATE_T3(float, uint32, int, floatp) get_non_muxed_audio;
 	DELEGATE_T3(float, uint32, int, floatp) get_tape_audio;
@@ -61,6 +64,9 @@ void sound_send_silence(struct sound_interface *);
 // Rate limit control
 void sound_set_ratelimit(struct sound_interface *sndp, _Bool ratelimit);
 
+// Pass each mixed buffer to a capture (NULL to stop)
+void sound_set_capture(struct sound_interface *sndp, struct capture *capture);
+
 // Dragon/CoCo-specific manipulation
 void sound_set_sbs(struct sound_interface *sndp, _Bool enabled, _Bool level);
 void sound_set_mux_enabled(struct sound_interface *sndp, _Bool enabled);
@@ -70,4 +76,11 @@ void sound_set_tape_level(struct sound_interface *sndp, float level);
 void sound_set_external_left(struct sound_interface *sndp, float level);
 void sound_set_external_right(struct sound_interface *sndp, float level);
 
+// Band-limited steps can overshoot full scale slightly.  Clip a mixed sample
+// to [-1, 1] before converting it to an integer format.
+
+inline float sound_clip(float v) {
+	return (v < -1.0f) ? -1.0f : ((v > 1.0f) ? 1.0f : v);
+}
+
 #endif
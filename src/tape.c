@@ -116,8 +116,8 @@ struct tape_interface_private {
 	struct event flush_event;
 };
 
-static struct xroar_timeout *motoroff_timeout = NULL;
-static event_ticks motoron_time = 0;
+static VAR_ATTR_THREAD_LOCAL struct xroar_timeout *motoroff_timeout = NULL;
+static VAR_ATTR_THREAD_LOCAL event_ticks motoron_time = 0;
 
 static void waggle_bit(void *);
 static void flush_output(void *);
@@ -205,7 +205,7 @@ struct tape_interface *tape_interface_new(struct ui_interface *ui) {
 	tip->ui = ui;
 	tip->in_pulse = -1;
 	tip->ao_rate = 9600;
-	tip->rewrite.leader_count = xroar.cfg.tape.rewrite_leader;
+	tip->rewrite.leader_count = xroar_cfg.tape.rewrite_leader;
 	tip->rewrite.silence = 1;
 	tip->rewrite.bit0_pwt = 6403;
 	tip->rewrite.bit1_pwt = 3489;
@@ -287,7 +287,7 @@ int tape_seek(struct tape *t, long offset, int whence) {
 	// If seeking to beginning of tape, ensure any fake leader etc.
 	// is set up properly.
 	if (r >= 0 && t->offset == 0) {
-		tape_desync(tip, xroar.cfg.tape.rewrite_leader);
+		tape_desync(tip, xroar_cfg.tape.rewrite_leader);
 	}
 	return r;
 }
@@ -548,11 +548,11 @@ int tape_open_reading(struct tape_interface *ti, const char *filename) {
 		break;
 	}
 	if (ti->tape_input->module->set_panning)
-		ti->tape_input->module->set_panning(ti->tape_input, xroar.cfg.tape.pan);
+		ti->tape_input->module->set_panning(ti->tape_input, xroar_cfg.tape.pan);
 	if (ti->tape_input->module->set_hysteresis)
-		ti->tape_input->module->set_hysteresis(ti->tape_input, xroar.cfg.tape.hysteresis);
+		ti->tape_input->module->set_hysteresis(ti->tape_input, xroar_cfg.tape.hysteresis);
 
-	tape_desync(tip, xroar.cfg.tape.rewrite_leader);
+	tape_desync(tip, xroar_cfg.tape.rewrite_leader);
 	tape_set_playing(ti, !ti->default_paused, 1);
 	if (logging.level >= 1) {
 		LOG_PRINT("Tape: Attached '%s' for reading", filename);
@@ -737,14 +737,14 @@ void tape_set_motor(struct tape_interface *ti, _Bool motor) {
 		if (motor) {
 			motoron_time = event_current_tick;
 		}
-		if (!motor && xroar.cfg.debug.timeout_motoroff) {
+		if (!motor && xroar_cfg.debug.timeout_motoroff) {
 			int delta = event_tick_delta(event_current_tick, motoron_time);
 			if (delta < 0 || delta > 416) {
-				motoroff_timeout = xroar_set_timeout(xroar.cfg.debug.timeout_motoroff);
+				motoroff_timeout = xroar_set_timeout(xroar_cfg.debug.timeout_motoroff);
 			}
 		}
-		if (!motor && xroar.cfg.debug.snap_motoroff) {
-			write_snapshot(xroar.cfg.debug.snap_motoroff);
+		if (!motor && xroar_cfg.debug.snap_motoroff) {
+			write_snapshot(xroar_cfg.debug.snap_motoroff);
 		}
 		LOG_DEBUG(2, "Tape: motor %s\n", motor ? "ON" : "OFF");
 	}
@@ -839,7 +839,7 @@ static void update_motor(struct tape_interface_private *tip) {
 			ti->tape_output->module->motor_off(ti->tape_output);
 		}
 		if (tip->tape_rewrite) {
-			tape_desync(tip, xroar.cfg.tape.rewrite_leader);
+			tape_desync(tip, xroar_cfg.tape.rewrite_leader);
 		}
 	}
 	set_breakpoints(tip);
@@ -856,11 +856,11 @@ static void waggle_bit(void *sptr) {
 	case -1:
 		DELEGATE_CALL(ti->update_audio, 0.5);
 		event_dequeue(&tip->waggle_event);
-		if (!motoroff_timeout && xroar.cfg.debug.timeout_motoroff) {
-			motoroff_timeout = xroar_set_timeout(xroar.cfg.debug.timeout_motoroff);
+		if (!motoroff_timeout && xroar_cfg.debug.timeout_motoroff) {
+			motoroff_timeout = xroar_set_timeout(xroar_cfg.debug.timeout_motoroff);
 		}
-		if (xroar.cfg.debug.snap_motoroff) {
-			write_snapshot(xroar.cfg.debug.snap_motoroff);
+		if (xroar_cfg.debug.snap_motoroff) {
+			write_snapshot(xroar_cfg.debug.snap_motoroff);
 		}
 		if (ti->default_paused) {
 			tape_set_playing(ti, 0, 1);
@@ -914,8 +914,8 @@ static void advance_read_time(struct tape_interface_private *tip, int skip) {
 		tip->in_pulse = tape_pulse_in(ti->tape_input, &tip->in_pulse_width);
 		if (tip->in_pulse < 0) {
 			event_dequeue(&tip->waggle_event);
-			if (!motoroff_timeout && xroar.cfg.debug.timeout_motoroff) {
-				motoroff_timeout = xroar_set_timeout(xroar.cfg.debug.timeout_motoroff);
+			if (!motoroff_timeout && xroar_cfg.debug.timeout_motoroff) {
+				motoroff_timeout = xroar_set_timeout(xroar_cfg.debug.timeout_motoroff);
 			}
 			return;
 		}
@@ -1385,9 +1385,9 @@ static void rewrite_tape_on(void *sptr) {
 	struct tape_interface_private *tip = sptr;
 	struct tape_interface *ti = &tip->public;
 	/* desync with long leader */
-	tape_desync(tip, xroar.cfg.tape.rewrite_leader);
+	tape_desync(tip, xroar_cfg.tape.rewrite_leader);
 	if (tip->tape_rewrite && ti->tape_output) {
-		tape_sample_out(ti->tape_output, 0x80, EVENT_MS(xroar.cfg.tape.rewrite_gap_ms));
+		tape_sample_out(ti->tape_output, 0x80, EVENT_MS(xroar_cfg.tape.rewrite_gap_ms));
 		tip->rewrite.silence = 1;
 	}
 }
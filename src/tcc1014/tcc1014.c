@@ -136,7 +136,7 @@ struct TCC1014_private {
 	} timer;
 
 	// Output
-	int frame;  // frameskip counter
+	_Bool timing_only;  // frame is being skipped, see tcc1014_set_timing_only()
 
 	// A real GIME emits two sets of signals: composite video and RGB.  It
 	// generates very different signals for each from video data.  As we
@@ -221,6 +221,15 @@ struct TCC1014_private {
 	// $FFA8-$FFAF: MMU bank registers (task two)
 	uint8_t mmu_bank[16];
 
+	// Address decode below $FE00 for each 8K page of each task, indexed
+	// like mmu_bank[].  Recalculated when MMU bank registers, INIT0 or
+	// the SAM TY bit change.
+	struct {
+		unsigned S;
+		_Bool RAS;
+		uint32_t Z;
+	} mmu_cache[16];
+
 	// $FFB0-$FFBF: Colour palette registers
 	uint8_t palette_reg[16];
 
@@ -514,6 +523,8 @@ static void do_update_timer(void *);
 // Update state from register contents
 static void update_from_gime_registers(struct TCC1014_private *gime);
 static void update_from_sam_register(struct TCC1014_private *gime);
+static void update_mmu_cache(struct TCC1014_private *gime, unsigned i);
+static void update_mmu_cache_all(struct TCC1014_private *gime);
 
 #ifdef HAVE_GIME_DEBUG
 static inline unsigned l_dt(struct TCC1014_private *gime) { return event_current_tick - gime->scanline_start; }
@@ -668,7 +679,7 @@ void tcc1014_reset(struct TCC1014 *gimep) {
 
 	memset(gime->pixel_data, 0, sizeof(gime->pixel_data));
 	gime->horizontal.npixels = 0;
-	gime->frame = 0;
+	gime->timing_only = 0;
 	gime->scanline = 0;
 	gime->vertical.sync = 1;
 	gime->vertical.lcount = 0;
@@ -691,7 +702,13 @@ void tcc1014_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
 
 	// Address decoding
 
-	if (A < 0xff00) {
+	if (A < 0xfe00) {
+		unsigned i = gime->TR | (A >> 13);
+		gimep->S = gime->mmu_cache[i].S;
+		gimep->RAS = gime->mmu_cache[i].RAS;
+		gimep->Z = gime->mmu_cache[i].Z | (A & 0x1fff);
+
+	} else if (A < 0xff00) {
 		_Bool use_mmu = gime->MMUEN;
 
 		if (A >= 0xfe00) {
@@ -764,6 +781,7 @@ void tcc1014_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
 	} else if (A < 0xffb0) {
 		if (!RnW) {
 			gime->mmu_bank[A & 15] = *gimep->CPUD & 0x3f;
+			update_mmu_cache(gime, A & 15);
 		} else {
 			*gimep->CPUD = (*gimep->CPUD & ~0x3f) | gime->mmu_bank[A & 15];
 		}
@@ -801,13 +819,35 @@ void tcc1014_mem_cycle(void *sptr, _Bool RnW, uint16_t A) {
 	DELEGATE_CALL(gimep->cpu_cycle, ncycles, RnW, A);
 }
 
+// Further dummy cycles (reads from $FFFF) following one that went through
+// tcc1014_mem_cycle().  These change nothing but the time.  Performs up to n
+// cycles, as many as fit in strictly less than max_ticks, and returns the
+// number performed.  Their total duration is stored in *ticks.  The cpu_cycle
+// delegate is not called: the caller is responsible for accounting for the
+// time.
+
+unsigned tcc1014_nvma_cycles(struct TCC1014 *gimep, unsigned n, int max_ticks, int *ticks) {
+	struct TCC1014_private *gime = (struct TCC1014_private *)gimep;
+	*ticks = 0;
+	if (max_ticks <= 0)
+		return 0;
+	int ncycles = gime->R1 ? 8 : 16;
+	unsigned max_n = (max_ticks - 1) / ncycles;
+	if (n > max_n)
+		n = max_n;
+	*ticks = n * ncycles;
+	return n;
+}
+
 // Just the address decode from tcc1014_mem_cycle().  Used to verify that a
 // breakpoint refers to ROM.  Unlike SAM equivalent, RnW doesn't affect the
 // result.
 
 unsigned tcc1014_decode(struct TCC1014 *gimep, uint16_t A) {
 	struct TCC1014_private *gime = (struct TCC1014_private *)gimep;
-	if (A < 0xff00) {
+	if (A < 0xfe00) {
+		return gime->mmu_cache[gime->TR | (A >> 13)].S;
+	} else if (A < 0xff00) {
 		_Bool use_mmu = gime->MMUEN;
 
 		if (A >= 0xfe00) {
@@ -851,6 +891,11 @@ void tcc1014_set_inverted_text(struct TCC1014 *gimep, _Bool value) {
 	gime->inverted_text = value;
 }
 
+void tcc1014_set_timing_only(struct TCC1014 *gimep, _Bool value) {
+	struct TCC1014_private *gime = (struct TCC1014_private *)gimep;
+	gime->timing_only = value;
+}
+
 void tcc1014_notify_mode(struct TCC1014 *gimep) {
 	struct TCC1014_private *gime = (struct TCC1014_private *)gimep;
 	unsigned HR0 = gime->COCO ? 0 : (gime->HRES & 1);  // 0=512px, 1=640px mode
@@ -880,6 +925,7 @@ static void tcc1014_set_register(struct TCC1014_private *gime, unsigned reg, uns
 		gime->MC1 = val & 0x02;
 		gime->MC0 = val & 0x01;
 		GIME_DEBUG(1, "GIME INIT0 (%-3u+%-3u): COCO=%d MMUEN=%d IEN=%d FEN=%d MC3=%d MC2=%d MC1/0=%d\n", gime->scanline, l_dt(gime), (val>>7)&1, (val>>6)&1, (val>>5)&1, (val>>4)&1, (val>>3)&1,(val>>2)&1,val&3);
+		update_mmu_cache_all(gime);
 		update_from_gime_registers(gime);
 		break;
 
@@ -1186,7 +1232,7 @@ static void do_vb_irq(void *sptr) {
 			}
 			gime->vertical.active_area = 1;
 			gime->vertical.lcount = 0;
-		} else {
+		} else if (!gime->timing_only) {
 			memset(gime->pixel_data + gime->horizontal.tHS_LB, gime->border_colour, 888 - gime->horizontal.tHS_LB);
 		}
 
@@ -1236,8 +1282,9 @@ static uint8_t fetch_byte_vram(struct TCC1014_private *gime) {
 static void render_scanline(struct TCC1014_private *gime, event_ticks t) {
 	unsigned beam_to = t - gime->scanline_start;
 
-	// Don't bother if not in active area or frame skipping
-	if (!gime->vertical.active_area || gime->frame != 0)
+	// Don't bother if not in active area or frame skipping.  Video address
+	// only advances per row, so skipping the fetches doesn't affect timing.
+	if (!gime->vertical.active_area || gime->timing_only)
 		return;
 
 	// Don't start rendering until left border
@@ -1563,9 +1610,43 @@ static void update_from_gime_registers(struct TCC1014_private *gime) {
 // Interpret SAM compatibility register
 
 static void update_from_sam_register(struct TCC1014_private *gime) {
+	_Bool old_TY = gime->TY;
 	gime->TY = gime->SAM_register & 0x8000;
 	gime->R1 = gime->SAM_register & 0x1000;
 	gime->SAM_F = (gime->SAM_register >> 3) & 0x7f;
 	gime->SAM_V = gime->SAM_register & 0x7;
+	if (gime->TY != old_TY) {
+		update_mmu_cache_all(gime);
+	}
 	update_from_gime_registers(gime);
 }
+
+// Recalculate cached address decode for one MMU page.  'i' indexes
+// mmu_bank[], so includes the task select.  Mirrors the decode for addresses
+// below $FE00 in tcc1014_mem_cycle().
+
+static void update_mmu_cache(struct TCC1014_private *gime, unsigned i) {
+	unsigned bank = gime->MMUEN ? gime->mmu_bank[i] : (0x38 | (i & 7));
+	unsigned S = 7;
+	_Bool RAS = 0;
+
+	if (!gime->TY && bank >= 0x3c) {
+		if (!gime->MC1) {
+			S = (bank >= 0x3e) ? 1 : 0;
+		} else {
+			S = gime->MC0 ? 1 : 0;
+		}
+	} else {
+		RAS = 1;
+	}
+
+	gime->mmu_cache[i].S = S;
+	gime->mmu_cache[i].RAS = RAS;
+	gime->mmu_cache[i].Z = bank << 13;
+}
+
+static void update_mmu_cache_all(struct TCC1014_private *gime) {
+	for (unsigned i = 0; i < 16; i++) {
+		update_mmu_cache(gime, i);
+	}
+}
@@ -84,9 +84,14 @@ void tcc1014_reset(struct TCC1014 *gimep);
 void tcc1014_mem_cycle(void *sptr, _Bool RnW, uint16_t A);
 
 unsigned tcc1014_decode(struct TCC1014 *, uint16_t A);
+unsigned tcc1014_nvma_cycles(struct TCC1014 *, unsigned n, int max_ticks, int *ticks);
 void tcc1014_set_sam_register(struct TCC1014 *gimep, unsigned val);
 
 void tcc1014_set_inverted_text(struct TCC1014 *gimep, _Bool);
+
+// While set, scanlines are not rendered, but all timing (video address, signal
+// edges, interrupts) proceeds as normal.  Intended for skipped frames.
+void tcc1014_set_timing_only(struct TCC1014 *gimep, _Bool);
 void tcc1014_notify_mode(struct TCC1014 *gimep);
 void tcc1014_set_composite(struct TCC1014 *, _Bool);
 
@@ -97,6 +97,7 @@ enum ui_tag {
 	ui_tag_contrast,
 	ui_tag_saturation,
 	ui_tag_hue,
+	ui_tag_frame_rate,  // frames drawn per second with frameskip, else 0
 	// Audio
 	ui_tag_ratelimit,
 	ui_tag_gain,
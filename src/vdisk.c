@@ -46,7 +46,7 @@
 #define MAX_CYLINDERS (256)
 #define MAX_HEADS (2)
 
-static enum vdisk_err vdisk_errno;
+static VAR_ATTR_THREAD_LOCAL enum vdisk_err vdisk_errno;
 
 static struct vdisk *vdisk_load_vdk(const char *filename);
 static struct vdisk *vdisk_load_jvc(const char *filename);
@@ -129,7 +129,7 @@ struct vdisk *vdisk_new(unsigned track_length) {
 	for (unsigned i = 0; i < MAX_HEADS; i++)
 		disk->side_data[i] = NULL;
 	disk->filetype = FILETYPE_DMK;
-	disk->write_back = xroar.cfg.disk.write_back;
+	disk->write_back = xroar_cfg.disk.write_back;
 	disk->track_length = track_length;
 	return disk;
 }
@@ -558,7 +558,7 @@ static struct vdisk *do_load_jvc(const char *filename, _Bool auto_os9) {
 	if ((file_size % bytes_per_cyl) >= bytes_per_sector) {
 		ncyls++;
 	}
-	if (xroar.cfg.disk.auto_sd && nsectors == 10)
+	if (xroar_cfg.disk.auto_sd && nsectors == 10)
 		double_density = 0;
 
 	struct vdisk *disk = vdisk_new(VDISK_TRACK_LENGTH_DD300);
@@ -605,7 +605,7 @@ static struct vdisk *do_load_jvc(const char *filename, _Bool auto_os9) {
 }
 
 static struct vdisk *vdisk_load_jvc(const char *filename) {
-	return do_load_jvc(filename, xroar.cfg.disk.auto_os9);
+	return do_load_jvc(filename, xroar_cfg.disk.auto_os9);
 }
 
 static struct vdisk *vdisk_load_os9(const char *filename) {
@@ -18,11 +18,15 @@
 
 #include "top-config.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "delegate.h"
 #include "xalloc.h"
 
+#include "events.h"
+#include "host_clock.h"
+#include "logging.h"
 #include "module.h"
 #include "vo.h"
 #include "vo_render.h"
@@ -189,7 +193,7 @@ void vo_set_renderer(struct vo_interface *vo, struct vo_render *vr) {
 	vo->set_cmp_phase_offset = DELEGATE_AS1(void, int, vo_render_set_cmp_phase_offset, vr);
 
 	// Used by machine to render video
-	vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr);
+	vo->render_line = vo_render_thread_line_delegate(vr, DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -201,36 +205,168 @@ static void update_render_parameters(struct vo_interface *vo) {
 	if (!vr)
 		return;
 
-	// RGB is always palette-based
+	DELEGATE_T3(void, unsigned, unsigned, uint8cp) render_line;
+
 	if (vo->signal == VO_SIGNAL_RGB) {
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_rgb_palette, vr);
-		return;
+		// RGB is always palette-based
+		render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_rgb_palette, vr);
+
+	} else if (vo->signal == VO_SIGNAL_SVIDEO) {
+		// As is S-Video, though it uses the composite palette
+		render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr);
+
+	} else {
+		// Composite video has more options
+		switch (vo->cmp_ccr) {
+		case VO_CMP_CCR_PALETTE:
+		default:
+			render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr);
+			break;
+		case VO_CMP_CCR_2BIT:
+			render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_2bit, vr);
+			break;
+		case VO_CMP_CCR_5BIT:
+			render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_5bit, vr);
+			break;
+		case VO_CMP_CCR_PARTIAL:
+			render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vo_render_cmp_partial, vr);
+			break;
+		case VO_CMP_CCR_SIMULATED:
+			render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vo_render_cmp_simulated, vr);
+			break;
+		}
 	}
 
-	// As is S-Video, though it uses the composite palette
-	if (vo->signal == VO_SIGNAL_SVIDEO) {
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr);
+	// Lines are queued for a worker thread if one is running
+	vo->render_line = vo_render_thread_line_delegate(vr, render_line);
+}
+
+// Enable or disable rendering in a separate thread
+
+void vo_set_render_thread(struct vo_interface *vo, _Bool enable) {
+	vo_render_set_threaded(vo->renderer, enable);
+	update_render_parameters(vo);
+}
+
+// Capture completed frames
+
+void vo_set_capture(struct vo_interface *vo, struct capture *capture) {
+	vo_render_set_capture(vo->renderer, capture);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Frameskip
+
+// Automatic frameskip starts skipping once emulation falls this far behind
+// real time
+#define FRAMESKIP_AUTO_LAG_US (20000)
+
+// Beyond this, give up trying to catch up (e.g. after a pause)
+#define FRAMESKIP_AUTO_RESET_US (1000000)
+
+// Lag decays by 1/2^this per frame.  Stops small differences between the
+// host clock and the rate at which the audio device consumes samples from
+// accumulating into a false indication that emulation is behind.
+#define FRAMESKIP_AUTO_DECAY_SHIFT (6)
+
+void vo_set_frameskip(struct vo_interface *vo, unsigned nframes, _Bool automatic) {
+	if (!vo)
 		return;
+	vo->frameskip.nframes = nframes;
+	vo->frameskip.automatic = automatic;
+	vo->frameskip.frame = 0;
+	vo->frameskip.nauto = 0;
+	vo->frameskip.timing_valid = 0;
+	// Frame rate is only reported while frameskip is enabled
+	if (!nframes && !automatic && vo->frameskip.fps != 0) {
+		vo->frameskip.fps = 0;
+		if (xroar.ui_interface) {
+			DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_frame_rate, 0, NULL);
+		}
 	}
+}
 
-	// Composite video has more options
-	switch (vo->cmp_ccr) {
-	case VO_CMP_CCR_PALETTE:
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_palette, vr);
-		break;
-	case VO_CMP_CCR_2BIT:
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_2bit, vr);
-		break;
-	case VO_CMP_CCR_5BIT:
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vr->render_cmp_5bit, vr);
-		break;
-	case VO_CMP_CCR_PARTIAL:
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vo_render_cmp_partial, vr);
-		break;
-	case VO_CMP_CCR_SIMULATED:
-		vo->render_line = DELEGATE_AS3(void, unsigned, unsigned, uint8cp, vo_render_cmp_simulated, vr);
-		break;
+// Track how far emulated time has fallen behind host time.  Returns true if
+// emulation is far enough behind that frames should be skipped.
+
+static _Bool frameskip_behind(struct vo_interface *vo, int64_t now) {
+	if (!vo->frameskip.timing_valid) {
+		vo->frameskip.timing_valid = 1;
+		vo->frameskip.last_host_us = now;
+		vo->frameskip.last_tick = event_current_tick;
+		vo->frameskip.lag_us = 0;
+		return 0;
+	}
+	int64_t host_us = now - vo->frameskip.last_host_us;
+	event_ticks ticks = event_current_tick - vo->frameskip.last_tick;
+	int64_t emu_us = ((int64_t)ticks * 1000000) / (int64_t)EVENT_TICK_RATE;
+	vo->frameskip.last_host_us = now;
+	vo->frameskip.last_tick += (event_ticks)((emu_us * (int64_t)EVENT_TICK_RATE) / 1000000);
+
+	int64_t lag = vo->frameskip.lag_us + host_us - emu_us;
+	lag -= lag >> FRAMESKIP_AUTO_DECAY_SHIFT;
+	// Being ahead is fine: that's just rate limiting.  And if a skipped
+	// frame didn't run faster than real time, either the rate limiter has
+	// caught up with us, or skipping isn't helping.  Either way, time lost
+	// so far can't be recovered.
+	if (lag < 0 || lag > FRAMESKIP_AUTO_RESET_US)
+		lag = 0;
+	if (vo->frameskip.skip && host_us >= emu_us)
+		lag = 0;
+	vo->frameskip.lag_us = lag;
+	return lag > FRAMESKIP_AUTO_LAG_US;
+}
+
+void vo_frameskip_update(struct vo_interface *vo) {
+	int64_t now = (int64_t)host_clock_us();
+
+	// Count frames drawn for reporting effective frame rate
+	if (!vo->frameskip.skip)
+		vo->frameskip.ndrawn++;
+	int64_t elapsed = now - vo->frameskip.rate_host_us;
+	if (elapsed >= 1000000 || elapsed < 0) {
+		_Bool enabled = vo->frameskip.nframes || vo->frameskip.automatic;
+		if (enabled && elapsed > 0 && elapsed < 2000000) {
+			int fps = (vo->frameskip.ndrawn * INT64_C(1000000) + elapsed / 2) / elapsed;
+			if (fps != vo->frameskip.fps) {
+				vo->frameskip.fps = fps;
+				LOG_DEBUG(2, "Effective frame rate: %d fps\n", fps);
+				if (xroar.ui_interface) {
+					DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_frame_rate, fps, NULL);
+				}
+			}
+		}
+		vo->frameskip.rate_host_us = now;
+		vo->frameskip.ndrawn = 0;
+	}
+
+	// Fixed frameskip
+	_Bool skip = 0;
+	if (vo->frameskip.frame > 0) {
+		vo->frameskip.frame--;
+		skip = 1;
+	} else {
+		vo->frameskip.frame = vo->frameskip.nframes;
 	}
+
+	// Automatic frameskip.  Always draws at least one frame in every
+	// VO_FRAMESKIP_AUTO_MAX+1.
+	if (vo->frameskip.automatic) {
+		_Bool behind = frameskip_behind(vo, now);
+		if (!skip) {
+			if (behind && vo->frameskip.nauto < VO_FRAMESKIP_AUTO_MAX) {
+				vo->frameskip.nauto++;
+				vo->frameskip.frame = 0;
+				skip = 1;
+			} else {
+				vo->frameskip.nauto = 0;
+			}
+		}
+	}
+
+	vo->frameskip.skip = skip;
+	vo->skip_render = skip && !vo->render_all && !(vo->renderer && vo->renderer->capture);
 }
 
 // Select input signal
@@ -308,7 +444,7 @@ extern inline void vo_set_cmp_fsc(struct vo_interface *vo, _Bool notify, int val
 extern inline void vo_set_cmp_system(struct vo_interface *vo, _Bool notify, int value);
 extern inline void vo_set_cmp_colour_killer(struct vo_interface *vo, _Bool notify, _Bool value);
 
-extern inline void vo_vsync(struct vo_interface *vo, _Bool draw);
+extern inline void vo_vsync(struct vo_interface *vo);
 extern inline void vo_refresh(struct vo_interface *vo);
 
 // Zoom helpers
@@ -37,6 +37,7 @@
 
 #include "delegate.h"
 
+#include "events.h"
 #include "vo_render.h"
 #include "xconfig.h"
 
@@ -80,6 +81,9 @@ struct vo_cfg {
 	int pixel_fmt;
 	_Bool fullscreen;
 	_Bool colour_killer;
+	// Frame hash module (null UI)
+	int hash_interval;
+	char *hash_golden;
 };
 
 // Window Area is the obvious top level.  Defined in host screen pixels, and
@@ -140,6 +144,35 @@ struct vo_interface {
 		_Bool button[3];
 	} mouse;
 
+	// Frameskip state, see vo_set_frameskip()
+	struct {
+		unsigned nframes;  // fixed no. of frames to skip after each drawn
+		_Bool automatic;   // also skip while running behind real time
+		unsigned frame;    // frames left to skip
+		unsigned nauto;    // consecutive frames skipped automatically
+		_Bool skip;        // current frame will not be drawn
+
+		// Emulated time against host time
+		_Bool timing_valid;
+		int64_t last_host_us;
+		event_ticks last_tick;
+		int64_t lag_us;
+
+		// Effective frame rate, reported to UI
+		int64_t rate_host_us;
+		unsigned ndrawn;
+		int fps;
+	} frameskip;
+
+	// Set while scanline data for the current frame is not needed.
+	// Machines pass NULL data to render_line instead, which only advances
+	// the renderer's scanline count.
+	_Bool skip_render;
+
+	// Set by modules that need every frame rendered even when not drawn
+	// (e.g. for hashing).
+	_Bool render_all;
+
 	// Called by vo_free before freeing the struct to handle
 	// module-specific allocations
 	DELEGATE_T0(void) free;
@@ -228,6 +261,10 @@ struct vo_interface {
 
 	// Draw the current buffer.  Called by vo_vsync() and vo_refresh().
 	DELEGATE_T0(void) draw;
+
+	// Optional.  Called by vo_vsync() for every frame, including those
+	// skipped for drawing, once the buffer is complete.
+	DELEGATE_T0(void) vsync;
 };
 
 // Geometry handling
@@ -288,6 +325,27 @@ inline void vo_set_ntsc_scaling(struct vo_interface *vo, _Bool notify, _Bool val
 
 void vo_set_cmp_ccr(struct vo_interface *vo, _Bool notify, int value);
 
+// Enable or disable rendering scanlines in a separate thread
+
+void vo_set_render_thread(struct vo_interface *vo, _Bool enable);
+
+// Pass each completed frame to a capture (NULL to stop)
+
+void vo_set_capture(struct vo_interface *vo, struct capture *capture);
+
+// Frameskip.  A fixed frameskip draws one frame, then skips 'nframes'.  With
+// 'automatic' set, further frames are skipped while emulation is running
+// behind real time.  While either is in effect, the number of frames actually
+// drawn per second is passed to the UI as ui_tag_frame_rate (0 when disabled).
+
+#define VO_FRAMESKIP_AUTO_MAX (10)
+
+void vo_set_frameskip(struct vo_interface *vo, unsigned nframes, _Bool automatic);
+
+// Called at the end of vo_vsync() to decide whether the next frame is skipped
+
+void vo_frameskip_update(struct vo_interface *vo);
+
 // Configure composite video
 
 inline void vo_set_cmp_fs(struct vo_interface *vo, _Bool notify, int value) {
@@ -306,20 +364,24 @@ inline void vo_set_cmp_colour_killer(struct vo_interface *vo, _Bool notify, _Boo
 	vo_render_set_cmp_colour_killer(vo->renderer, notify, value);
 }
 
-// Vertical sync.  Calls any module-specific draw function if requested, then
-// vo_render_vsync().  Called with draw=0 during frameskip, as we still want to
-// count scanlines.
+// Vertical sync.  Calls any module-specific draw function unless the frame is
+// being skipped, then vo_render_vsync().  Still called for skipped frames, as
+// we want to count scanlines.
 
-inline void vo_vsync(struct vo_interface *vo, _Bool draw) {
-	if (draw)
+inline void vo_vsync(struct vo_interface *vo) {
+	vo_render_sync(vo->renderer);
+	DELEGATE_SAFE_CALL(vo->vsync);
+	if (!vo->frameskip.skip)
 		DELEGATE_SAFE_CALL(vo->draw);
 	vo_render_vsync(vo->renderer);
+	vo_frameskip_update(vo);
 }
 
 // Refresh the display by calling draw().  Useful while single-stepping, where
 // the usual render functions won't be called.
 
 inline void vo_refresh(struct vo_interface *vo) {
+	vo_render_sync(vo->renderer);
 	DELEGATE_SAFE_CALL(vo->draw);
 }
 
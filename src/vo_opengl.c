@@ -99,6 +99,10 @@ void vo_opengl_free(void *sptr) {
 	struct vo_render *vr = vo->renderer;
 	vo_render_free(vr);
 	glDeleteTextures(1, &vogl->texture.num);
+#ifdef GL_PIXEL_UNPACK_BUFFER
+	if (vogl->texture.pbo)
+		glDeleteBuffers(1, &vogl->texture.pbo);
+#endif
 	glDeleteFramebuffers(1, &vogl->blit_fbo);
 	free(vogl->texture.pixels);
 }
@@ -229,6 +233,7 @@ static void update_viewport(struct vo_opengl_interface *vogl) {
 			vogl->texture.buf_format, vogl->texture.buf_type, vogl->texture.pixels);
 
 	vr->buffer_pitch = vp_w;
+	vogl->texture.update_all = 1;
 }
 
 void vo_opengl_set_viewport(struct vo_opengl_interface *vogl, int vp_w, int vp_h) {
@@ -242,11 +247,56 @@ void vo_opengl_set_frame_rate(struct vo_opengl_interface *vogl, _Bool is_60hz) {
 	update_viewport(vogl);
 }
 
+// Pixel buffer objects are core in OpenGL 2.1.  Version strings for OpenGL ES
+// start with "OpenGL ES", so won't match here.
+
+static _Bool have_pbo(void) {
+#ifdef GL_PIXEL_UNPACK_BUFFER
+	const char *version = (const char *)glGetString(GL_VERSION);
+	int major, minor;
+	if (!version || sscanf(version, "%d.%d", &major, &minor) != 2)
+		return 0;
+	return major > 2 || (major == 2 && minor >= 1);
+#else
+	return 0;
+#endif
+}
+
 void vo_opengl_setup_context(struct vo_opengl_interface *vogl) {
+#ifdef GL_PIXEL_UNPACK_BUFFER
+	if (!vogl->texture.pbo && have_pbo()) {
+		glGenBuffers(1, &vogl->texture.pbo);
+	}
+#endif
 	// Create textures, etc.
 	update_viewport(vogl);
 }
 
+// Upload a range of rows from the pixel buffer to the texture.  Through a
+// pixel buffer object if available: the data is copied into memory owned by
+// the driver, which can then transfer it to the texture asynchronously.
+
+static void upload_rows(struct vo_opengl_interface *vogl, int w, int y0, int y1) {
+	size_t pitch = w * vogl->texture.pixel_size;
+	uint8_t *src = (uint8_t *)vogl->texture.pixels + y0 * pitch;
+
+#ifdef GL_PIXEL_UNPACK_BUFFER
+	if (vogl->texture.pbo) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, vogl->texture.pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, (y1 - y0) * pitch, src, GL_STREAM_DRAW);
+		glTexSubImage2D(GL_TEXTURE_2D, 0,
+				0, y0, w, y1 - y0,
+				vogl->texture.buf_format, vogl->texture.buf_type, NULL);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return;
+	}
+#endif
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0,
+			0, y0, w, y1 - y0,
+			vogl->texture.buf_format, vogl->texture.buf_type, src);
+}
+
 void vo_opengl_draw(void *sptr) {
 	struct vo_opengl_interface *vogl = sptr;
 	struct vo_interface *vo = &vogl->vo;
@@ -254,10 +304,21 @@ void vo_opengl_draw(void *sptr) {
 
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	// Only upload rows that the renderer has changed since last time
+	int y0, y1;
+	vo_render_take_dirty(vr, &y0, &y1);
+	if (vogl->texture.update_all) {
+		y0 = 0;
+		y1 = vr->viewport.h;
+		vogl->texture.update_all = 0;
+	}
+	if (y1 > vr->viewport.h)
+		y1 = vr->viewport.h;
+
 	glBindTexture(GL_TEXTURE_2D, vogl->texture.num);
-	glTexSubImage2D(GL_TEXTURE_2D, 0,
-			0, 0, vr->viewport.w, vr->viewport.h,
-			vogl->texture.buf_format, vogl->texture.buf_type, vogl->texture.pixels);
+	if (y0 < y1) {
+		upload_rows(vogl, vr->viewport.w, y0, y1);
+	}
 
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, vogl->blit_fbo);
 	glBlitFramebuffer(0, vr->viewport.h, vr->viewport.w, 0,
@@ -60,6 +60,13 @@ struct vo_opengl_interface {
 
 		// Pixel buffer
 		void *pixels;
+
+		// Pixel buffer object used to stream updates, if supported
+		GLuint pbo;
+
+		// Set when the whole texture needs uploading, not just the
+		// rows the renderer reports as changed
+		_Bool update_all;
 	} texture;
 
 	struct vo_viewport viewport;
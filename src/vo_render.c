@@ -26,6 +26,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifndef M_PI
 # define M_PI 3.14159265358979323846
@@ -36,10 +37,12 @@
 #include "pl-endian.h"
 #include "xalloc.h"
 
+#include "capture.h"
 #include "colourspace.h"
 #include "filter.h"
 #include "ntsc.h"
 #include "vo_render.h"
+#include "vo_render_simd.h"
 #include "xroar.h"
 
 #define MAX_FILTER_ORDER (15)
@@ -88,6 +91,22 @@ static const double vo_render_fs_mhz[NUM_VO_RENDER_FS] = {
         14.31818, 14.218, 14.23753
 };
 
+// Line rendering modes, recorded for dirty line tracking
+
+enum {
+	LINE_CMP_PALETTE,
+	LINE_CMP_MONO,
+	LINE_RGB_PALETTE,
+	LINE_CMP_2BIT,
+	LINE_CMP_5BIT,
+	LINE_CMP_PARTIAL,
+	LINE_CMP_SIMULATED,
+};
+
+static _Bool check_line(struct vo_render *vr, int mode, unsigned burstn, unsigned t,
+			int vswitch, uint8_t const *data, int lo, int hi);
+static void mark_line(struct vo_render *vr, _Bool dirty);
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #define VR_PTYPE uint8_t
@@ -122,16 +141,19 @@ static int_xyz unmap_abgr8(uint32_t s);
 static int_xyz unmap_rgba4(uint16_t s);
 static int_xyz unmap_rgb565(uint16_t s);
 
-static void render_rgba8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
-static void render_argb8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
-static void render_bgra8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
-static void render_abgr8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
-static void render_rgba4(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
-static void render_rgb565(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels);
+static void render_rgba8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
+static void render_argb8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
+static void render_bgra8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
+static void render_abgr8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
+static void render_rgba4(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
+static void render_rgb565(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void update_gamma_table(struct vo_render *vr);
+static void update_stale_chroma(struct vo_render *vr);
+static void invalidate_lines(struct vo_render *vr);
+static void update_line_records(struct vo_render *vr);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -177,6 +199,8 @@ struct vo_render *vo_render_new(int fmt) {
 	if (!vr)
 		return NULL;
 
+	vo_render_simd_init();
+
 	// Sensible defaults
 	vo_render_set_cmp_fs(vr, 1, VO_RENDER_FS_14_31818);
 	vo_render_set_cmp_fsc(vr, 1, VO_RENDER_FSC_4_43361875);
@@ -219,6 +243,8 @@ struct vo_render *vo_render_new(int fmt) {
 // Free renderer
 
 void vo_render_free(struct vo_render *vr) {
+	vo_render_set_threaded(vr, 0);
+	free(vr->dirty.line);
 	free(vr->cmp.burst);
 	if (vr->cmp.mod.ufilter.coeff) {
 		free(vr->cmp.mod.ufilter.coeff - MAX_FILTER_ORDER);
@@ -239,6 +265,7 @@ void vo_render_free(struct vo_render *vr) {
 }
 
 extern inline void vo_render_set_buffer(struct vo_render *vr, void *buffer);
+extern inline _Bool vo_render_take_dirty(struct vo_render *vr, int *y0, int *y1);
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -292,67 +319,31 @@ static int_xyz unmap_rgb565(uint16_t s) {
 	return (int_xyz){.x = (s >> 8) & 0xf8, .y = (s >> 3) & 0xfc, .z = (s >> 3) & 0xf8};
 }
 
-// Render a line of RGB data into a particular pixel format.  The calls to
-// map_* (defined above) should get inlined, as they are usually trivial.
+// Render a line of planar R'G'B' data into a particular pixel format.  Gamma
+// correction and packing are done by the vector kernels.
 
-static void render_rgba8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint32_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_rgba8(R, G, B);
-	}
+static void render_rgba8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack32(dest, r, g, b, vr->ungamma, 24, 16, 8, 0xff, npixels);
 }
 
-static void render_argb8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint32_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_argb8(R, G, B);
-	}
+static void render_argb8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack32(dest, r, g, b, vr->ungamma, 16, 8, 0, 0xff000000, npixels);
 }
 
-static void render_bgra8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint32_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_bgra8(R, G, B);
-	}
+static void render_bgra8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack32(dest, r, g, b, vr->ungamma, 8, 16, 24, 0xff, npixels);
 }
 
-static void render_abgr8(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint32_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_abgr8(R, G, B);
-	}
+static void render_abgr8(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack32(dest, r, g, b, vr->ungamma, 0, 8, 16, 0xff000000, npixels);
 }
 
-static void render_rgba4(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint16_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_rgba4(R, G, B);
-	}
+static void render_rgba4(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack_rgba4(dest, r, g, b, vr->ungamma, npixels);
 }
 
-static void render_rgb565(struct vo_render *vr, int_xyz *src, void *dest, unsigned npixels) {
-	uint16_t *d = dest;
-	for (; npixels; src++, npixels--) {
-		int R = vr->ungamma[int_clamp_u8(src->x)];
-		int G = vr->ungamma[int_clamp_u8(src->y)];
-		int B = vr->ungamma[int_clamp_u8(src->z)];
-		*(d++) = map_rgb565(R, G, B);
-	}
+static void render_rgb565(struct vo_render *vr, uint8_t const *r, uint8_t const *g, uint8_t const *b, void *dest, unsigned npixels) {
+	vo_render_kernels.pack_rgb565(dest, r, g, b, vr->ungamma, npixels);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -505,6 +496,16 @@ static void update_cmp_burst(struct vo_render *vr, unsigned burstn) {
 		}
 	}
 
+	// Repeat to fill the rest of each table
+	for (unsigned t = tmax; t < VO_RENDER_PHASE_TABLE_LEN; t++) {
+		burst->mod.u[t] = burst->mod.u[t - tmax];
+		burst->mod.v[0][t] = burst->mod.v[0][t - tmax];
+		burst->mod.v[1][t] = burst->mod.v[1][t - tmax];
+		burst->demod.u[t] = burst->demod.u[t - tmax];
+		burst->demod.v[0][t] = burst->demod.v[0][t - tmax];
+		burst->demod.v[1][t] = burst->demod.v[1][t - tmax];
+	}
+
 	ntsc_burst_set(vr, burstn);
 }
 
@@ -636,6 +637,8 @@ static void update_viewport(struct vo_render *vr) {
 //     int w, h;  // dimensions
 
 void vo_render_set_viewport(struct vo_render *vr, int w, int h) {
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	vr->viewport.w = w;
 	vr->viewport.h = h;
 	update_viewport(vr);
@@ -646,6 +649,7 @@ void vo_render_set_viewport(struct vo_render *vr, int w, int h) {
 //     _Bool enabled;
 
 void vo_render_set_ntsc_scaling(struct vo_render *vr, _Bool notify, _Bool enabled) {
+	vo_render_sync(vr);
 	if (!vr)
 		return;
 	vr->ntsc_scaling = enabled;
@@ -654,11 +658,25 @@ void vo_render_set_ntsc_scaling(struct vo_render *vr, _Bool notify, _Bool enable
 	}
 }
 
+// Set capture to receive completed frames
+//
+//     struct capture *capture;  // or NULL to stop
+
+void vo_render_set_capture(struct vo_render *vr, struct capture *capture) {
+	vo_render_sync(vr);
+	if (!vr)
+		return;
+	vr->capture = capture;
+	vr->capture_synced = 0;
+}
+
 // Set brightness
 //     int brightness;  // 0-100
 
 void vo_render_set_brightness(void *sptr, int value) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	if (value < 0) value = 0;
 	if (value > 100) value = 100;
 	vr->brightness = value;
@@ -677,6 +695,8 @@ void vo_render_set_brightness(void *sptr, int value) {
 
 void vo_render_set_contrast(void *sptr, int value) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	if (value < 0) value = 0;
 	if (value > 100) value = 100;
 	vr->contrast = value;
@@ -695,6 +715,8 @@ void vo_render_set_contrast(void *sptr, int value) {
 
 void vo_render_set_saturation(void *sptr, int value) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	if (value < 0) value = 0;
 	if (value > 100) value = 100;
 	vr->saturation = value;
@@ -712,6 +734,8 @@ void vo_render_set_saturation(void *sptr, int value) {
 
 void vo_render_set_hue(void *sptr, int value) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	value = ((value + 179) % 360) - 179;
 	vr->hue = value;
 	for (unsigned c = 0; c < 256; c++) {
@@ -730,6 +754,8 @@ void vo_render_set_hue(void *sptr, int value) {
 
 void vo_render_set_cmp_phase(void *sptr, int value) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	vr->cmp.phase = value;
 	update_phase_offset(vr);
 }
@@ -744,6 +770,7 @@ void vo_render_set_cmp_phase(void *sptr, int value) {
 
 void vo_render_set_active_area(void *sptr, int x, int y, int w, int h) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
 	vr->active_area.x = x;
 	vr->active_area.y = y;
 	vr->active_area.w = w;
@@ -754,8 +781,10 @@ void vo_render_set_active_area(void *sptr, int x, int y, int w, int h) {
 // Set sampling frequency (equal to pixel rate) to one of VO_RENDER_FS_*
 
 void vo_render_set_cmp_fs(struct vo_render *vr, _Bool notify, int fs) {
+	vo_render_sync(vr);
 	if (!vr)
 		return;
+	invalidate_lines(vr);
 	if (fs < 0 || fs >= NUM_VO_RENDER_FS) {
 		fs = VO_RENDER_FS_14_31818;
 	}
@@ -769,8 +798,10 @@ void vo_render_set_cmp_fs(struct vo_render *vr, _Bool notify, int fs) {
 // Set chroma subcarrier frequency to one of VO_RENDER_FSC_*
 
 void vo_render_set_cmp_fsc(struct vo_render *vr, _Bool notify, int fsc) {
+	vo_render_sync(vr);
 	if (!vr)
 		return;
+	invalidate_lines(vr);
 	if (fsc < 0 || fsc >= NUM_VO_RENDER_FSC) {
 		fsc = VO_RENDER_FSC_4_43361875;
 	}
@@ -784,8 +815,10 @@ void vo_render_set_cmp_fsc(struct vo_render *vr, _Bool notify, int fsc) {
 // Set colour system to one of VO_RENDER_SYSTEM_*
 
 void vo_render_set_cmp_system(struct vo_render *vr, _Bool notify, int system) {
+	vo_render_sync(vr);
 	if (!vr)
 		return;
+	invalidate_lines(vr);
 	if (system < 0 || system >= NUM_VO_RENDER_SYSTEM) {
 		system = VO_RENDER_SYSTEM_PAL_I;
 	}
@@ -800,8 +833,10 @@ void vo_render_set_cmp_system(struct vo_render *vr, _Bool notify, int system) {
 // (where supported)
 
 void vo_render_set_cmp_colour_killer(struct vo_render *vr, _Bool notify, _Bool value) {
+	vo_render_sync(vr);
 	if (!vr)
 		return;
+	invalidate_lines(vr);
 	vr->cmp.colour_killer = value;
 	if (notify && xroar.ui_interface) {
 		DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_cmp_colour_killer, (int)value, NULL);
@@ -814,6 +849,8 @@ void vo_render_set_cmp_colour_killer(struct vo_render *vr, _Bool notify, _Bool v
 
 void vo_render_set_cmp_lead_lag(void *sptr, float chb_phase, float cha_phase) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	(void)chb_phase;
 	vr->cmp.cha_phase = (cha_phase * 2. * M_PI) / 360.;
 	for (unsigned c = 0; c < 256; c++) {
@@ -825,6 +862,8 @@ void vo_render_set_cmp_lead_lag(void *sptr, float chb_phase, float cha_phase) {
 
 void vo_render_set_cmp_palette(void *sptr, uint8_t c, float y, float pb, float pr) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	vr->cmp.colour[c].y = y;
 	vr->cmp.colour[c].pb = pb;
 	vr->cmp.colour[c].pr = pr;
@@ -835,6 +874,8 @@ void vo_render_set_cmp_palette(void *sptr, uint8_t c, float y, float pb, float p
 
 void vo_render_set_rgb_palette(void *sptr, uint8_t c, float r, float g, float b) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
         vr->rgb.colour[c].r = r;
         vr->rgb.colour[c].g = g;
         vr->rgb.colour[c].b = b;
@@ -847,6 +888,8 @@ void vo_render_set_rgb_palette(void *sptr, uint8_t c, float r, float g, float b)
 
 void vo_render_set_cmp_burst(void *sptr, unsigned burstn, int offset) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	if (burstn >= vr->cmp.nbursts) {
 		unsigned nbursts = burstn + 1;
 		vr->cmp.burst = xrealloc(vr->cmp.burst, nbursts * sizeof(*(vr->cmp.burst)));
@@ -863,6 +906,8 @@ void vo_render_set_cmp_burst(void *sptr, unsigned burstn, int offset) {
 
 void vo_render_set_cmp_burst_br(void *sptr, unsigned burstn, float b_y, float r_y) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 
 	// Adjust according to chroma phase configuration
 	double mu = b_y - (r_y / tan(vr->cmp.cha_phase));
@@ -879,6 +924,8 @@ void vo_render_set_cmp_burst_br(void *sptr, unsigned burstn, float b_y, float r_
 
 void vo_render_set_cmp_phase_offset(void *sptr, int offset) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
+	invalidate_lines(vr);
 	vr->cmp.phase_offset = offset;
 	update_phase_offset(vr);
 }
@@ -891,9 +938,11 @@ void vo_render_set_cmp_phase_offset(void *sptr, int offset) {
 
 void vo_render_vsync(void *sptr) {
 	struct vo_render *vr = sptr;
+	vo_render_sync(vr);
 	if (!vr)
 		return;
 	vr->pixel = vr->buffer;
+	vr->dirty.row = 0;
 
 	_Bool is_60hz = vr->ntsc_scaling && (vr->scanline < 288);
 	if (is_60hz != vr->is_60hz) {
@@ -901,10 +950,19 @@ void vo_render_vsync(void *sptr) {
 		DELEGATE_SAFE_CALL(vr->notify_frame_rate, is_60hz);
 	}
 
+	if (vr->capture) {
+		// Skip the frame in progress when capture started, so that
+		// frame rate is taken from a complete frame.
+		if (vr->capture_synced)
+			capture_video_frame(vr->capture, vr, vr->scanline < 288);
+		vr->capture_synced = 1;
+	}
+
 	vr->scanline = 0;
 	vr->viewport.x = vr->viewport.new_x;
 	vr->viewport.y = vr->viewport.new_y;
 	vr->cmp.vswitch = !(vr->cmp.system == VO_RENDER_SYSTEM_NTSC || vr->cmp.phase == 0);
+	update_line_records(vr);
 }
 
 // NTSC partial composite video simulation
@@ -927,6 +985,13 @@ void vo_render_cmp_partial(void *sptr, unsigned burstn, unsigned npixels, uint8_
 	if (!burstn && !vr->cmp.colour_killer)
 		burstn = 1;
 
+	if (check_line(vr, LINE_CMP_PARTIAL, burstn, 0, 0, data, vr->viewport.x - 3, vr->viewport.x + vr->viewport.w + 3)) {
+		mark_line(vr, 0);
+		vr->next_line(vr, npixels);
+		return;
+	}
+	mark_line(vr, 1);
+
 	struct ntsc_burst *burst = &vr->cmp.burst[burstn].ntsc_burst;
 	const unsigned tmax = NTSC_NPHASES;
 
@@ -939,22 +1004,18 @@ void vo_render_cmp_partial(void *sptr, unsigned burstn, unsigned npixels, uint8_
 		*(ntsc_dest++) = np->byphase[i % tmax][c];
 	}
 
-	// Decode into intermediate RGB buffer
+	// Decode into intermediate R'G'B' planes
 	uint8_t const *src = (uint8_t *)vr->cmp.demod.fubuf[0];
-	int_xyz rgb[912];
-	int_xyz *idest = rgb;
-	if (burstn) {
-		for (int i = vr->viewport.x; i < (vr->viewport.x + vr->viewport.w); i++) {
-			*(idest++) = ntsc_decode(burst, src++, i);
-		}
-	} else {
-		for (int i = vr->viewport.w; i; i--) {
-			*(idest++) = ntsc_decode_mono(src++);
-		}
+	uint8_t r[VO_RENDER_MAX_LINE], g[VO_RENDER_MAX_LINE], b[VO_RENDER_MAX_LINE];
+	for (int i = 0; i < vr->viewport.w; i++) {
+		int_xyz rgb = burstn ? ntsc_decode(burst, src++, vr->viewport.x + i) : ntsc_decode_mono(src++);
+		r[i] = int_clamp_u8(rgb.x);
+		g[i] = int_clamp_u8(rgb.y);
+		b[i] = int_clamp_u8(rgb.z);
 	}
 
-	// Render from intermediate RGB buffer
-	vr->render_rgb(vr, rgb, vr->pixel, vr->viewport.w);
+	// Render from intermediate planes
+	vr->render_rgb(vr, r, g, b, vr->pixel, vr->viewport.w);
 	vr->next_line(vr, npixels);
 }
 
@@ -962,6 +1023,110 @@ void vo_render_cmp_partial(void *sptr, unsigned burstn, unsigned npixels, uint8_
 //
 // Uses render_rgb(), so doesn't need to be duplicated per-type
 
+// Modulate and demodulate a line, leaving filtered chroma in the line delay
+// buffers selected by 'vswitch'.  If 'fybuf' is not NULL, also store
+// filtered luma there.
+
+static void cmp_simulated_demod(struct vo_render *vr, unsigned burstn, unsigned t,
+				int vswitch, uint8_t const *data, unsigned x0, unsigned w,
+				int *fybuf) {
+	// Temporary buffers
+	int pybuf[VO_RENDER_MAX_LINE];  // Y' from palette
+	int pubuf[VO_RENDER_MAX_LINE];  // U from palette
+	int pvbuf[VO_RENDER_MAX_LINE];  // V from palette
+	int mubuf[VO_RENDER_MAX_LINE];  // U, optionally lowpassed
+	int mvbuf[VO_RENDER_MAX_LINE];  // V, optionally lowpassed
+	int mbuf[VO_RENDER_MAX_LINE];  // Y' + U sin(ωt) + V cos(ωt)
+	int ubuf[VO_RENDER_MAX_LINE];  // mbuf * 2 sin(ωt) (lowpass to recover U)
+	int vbuf[VO_RENDER_MAX_LINE];  // mbuf * 2 cos(ωt) (lowpass to recover V)
+
+	struct vo_render_burst *burst = &vr->cmp.burst[burstn];
+
+	int corder = vr->cmp.mod.corder;
+	unsigned mx0 = x0 - vr->cmp.demod.morder;
+	unsigned mw = w + 2 * vr->cmp.demod.morder;
+
+	// Palette lookups.  U and V are needed further out if they are to be
+	// filtered.
+	for (unsigned i = mx0 - corder; i < mx0 + mw + corder; i++) {
+		int c = data[i];
+		pubuf[i] = vr->cmp.palette.u[c];
+		pvbuf[i] = vr->cmp.palette.v[c];
+	}
+	for (unsigned i = mx0; i < mx0 + mw; i++) {
+		pybuf[i] = vr->cmp.palette.y[data[i]];
+	}
+
+	// Optionally apply lowpass filters to U and V.
+	int *fubuf = pubuf;
+	int *fvbuf = pvbuf;
+	if (corder) {
+		vo_render_kernels.fir(mubuf + mx0, pubuf + mx0, vr->cmp.mod.ufilter.coeff, corder, 15, mw);
+		vo_render_kernels.fir(mvbuf + mx0, pvbuf + mx0, vr->cmp.mod.vfilter.coeff, corder, 15, mw);
+		fubuf = mubuf;
+		fvbuf = mvbuf;
+	}
+
+	// Phase tables are long enough that a whole line can be indexed
+	// linearly from any starting phase.
+	unsigned p = (mx0 + t) % vr->tmax;
+	int const *mod_u = burst->mod.u + p;
+	int const *mod_v = burst->mod.v[vswitch] + p;
+	int const *demod_u = burst->demod.u + p;
+	int const *demod_v = burst->demod.v[vswitch] + p;
+
+	// Modulate results.
+	for (unsigned k = 0; k < mw; k++) {
+		unsigned i = mx0 + k;
+		int fu_sin_wt = (fubuf[i] * mod_u[k]) >> 9;
+		int fv_cos_wt = (fvbuf[i] * mod_v[k]) >> 9;
+		mbuf[i] = pybuf[i] + fu_sin_wt + fv_cos_wt;
+	}
+
+	// Multiply results by 2sin(wt)/2cos(wt), preempting demodulation:
+	if (burstn) {
+		for (unsigned k = 0; k < mw; k++) {
+			unsigned i = mx0 + k;
+			ubuf[i] = (mbuf[i] * demod_u[k]) >> 9;
+			vbuf[i] = (mbuf[i] * demod_v[k]) >> 9;
+		}
+	}
+
+	int *fubuf0 = vr->cmp.demod.fubuf[vswitch];
+	int *fvbuf0 = vr->cmp.demod.fvbuf[vswitch];
+
+	// Lowpass to recover Y', U and V.  fy won't be multiplied by
+	// [rgb]_conv, so is shifted less.
+	if (fybuf) {
+		vo_render_kernels.fir(fybuf + x0, mbuf + x0, vr->cmp.demod.yfilter.coeff, vr->cmp.demod.yfilter.order, 15-9, w);
+	}
+	if (burstn) {
+		vo_render_kernels.fir(fubuf0 + x0, ubuf + x0, vr->cmp.demod.ufilter.coeff, vr->cmp.demod.corder, 15, w);
+		vo_render_kernels.fir(fvbuf0 + x0, vbuf + x0, vr->cmp.demod.vfilter.coeff, vr->cmp.demod.corder, 15, w);
+	} else {
+		for (unsigned i = x0; i < x0 + w; i++) {
+			fubuf0[i] = fvbuf0[i] = 0;
+		}
+	}
+}
+
+// If the filtered chroma for the last line was skipped, regenerate it from
+// that line's record.  Needed before the line delay buffers are used to
+// average chroma with a new line, or before anything is changed that would
+// affect the result.
+
+static void update_stale_chroma(struct vo_render *vr) {
+	if (!vr->dirty.chroma_stale)
+		return;
+	vr->dirty.chroma_stale = 0;
+	if (vr->dirty.chroma_row >= vr->dirty.nlines)
+		return;
+	struct vo_render_line *line = &vr->dirty.line[vr->dirty.chroma_row];
+	if (line->mode != LINE_CMP_SIMULATED)
+		return;
+	cmp_simulated_demod(vr, line->burstn, line->t, line->vswitch, line->data, line->x, line->w, NULL);
+}
+
 void vo_render_cmp_simulated(void *sptr, unsigned burstn, unsigned npixels, uint8_t const *data) {
 	struct vo_render *vr = sptr;
 
@@ -973,105 +1138,136 @@ void vo_render_cmp_simulated(void *sptr, unsigned burstn, unsigned npixels, uint
 		return;
 	}
 
-	// Temporary buffers
-	int mbuf[1024];  // Y' + U sin(ωt) + V cos(ωt), U/V optionally lowpassed
-	int ubuf[1024];  // mbuf * 2 sin(ωt) (lowpass to recover U)
-	int vbuf[1024];  // mbuf * 2 cos(ωt) (lowpass to recover V)
-
 	if (!burstn && !vr->cmp.colour_killer)
 		burstn = 1;
 
-	struct vo_render_burst *burst = &vr->cmp.burst[burstn];
-	unsigned tmax = vr->tmax;
-	unsigned t = vr->t % tmax;
-
 	int vswitch = vr->cmp.vswitch;
 	if (vr->cmp.average_chroma)
 		vr->cmp.vswitch = !vswitch;
 
-	// Optionally apply lowpass filters to U and V.  Modulate results.
-	for (unsigned i = vr->viewport.x - vr->cmp.demod.morder; i < (unsigned)(vr->viewport.x + vr->viewport.w + vr->cmp.demod.morder); i++) {
-		int c = data[i];
-		int py = vr->cmp.palette.y[c];
-
-		int fu, fv;
-		if (vr->cmp.mod.corder) {
-			fu = fv = 0;
-			for (int ft = -vr->cmp.mod.corder; ft <= vr->cmp.mod.corder; ft++) {
-				int ct = data[i+ft];
-				fu += vr->cmp.palette.u[ct] * vr->cmp.mod.ufilter.coeff[ft];
-				fv += vr->cmp.palette.v[ct] * vr->cmp.mod.vfilter.coeff[ft];
-			}
-			fu >>= 15;
-			fv >>= 15;
-		} else {
-			fu = vr->cmp.palette.u[c];
-			fv = vr->cmp.palette.v[c];
-		}
-
-		int fu_sin_wt = (fu * burst->mod.u[(i+t) % tmax]) >> 9;
-		int fv_cos_wt = (fv * burst->mod.v[vswitch][(i+t) % tmax]) >> 9;
+	int corder = vr->cmp.mod.corder;
+	int morder = vr->cmp.demod.morder;
 
-		mbuf[i] = py + fu_sin_wt + fv_cos_wt;
+	// The viewport can briefly be offset too far left to apply the
+	// filters.  Leave such lines alone.
+	if (vr->viewport.x < morder + corder) {
+		mark_line(vr, 0);
+		vr->next_line(vr, npixels);
+		return;
+	}
 
-		// Multiply results by 2sin(wt)/2cos(wt), preempting
-		// demodulation:
-		if (burstn) {
-			ubuf[i] = (mbuf[i] * burst->demod.u[(i+t) % tmax]) >> 9;
-			vbuf[i] = (mbuf[i] * burst->demod.v[vswitch][(i+t) % tmax]) >> 9;
-		}
+	unsigned x0 = vr->viewport.x;
+	unsigned w = vr->viewport.w;
+
+	// A line can be skipped if it is unchanged and, when chroma is
+	// averaged, so was the line before it.
+	unsigned row = vr->dirty.row;
+	_Bool prev_match = vr->dirty.chroma_match;
+	_Bool match = check_line(vr, LINE_CMP_SIMULATED, burstn, vr->t, vswitch, data,
+				 x0 - morder - corder, x0 + w + morder + corder);
+	vr->dirty.chroma_match = match;
+	if (match && (prev_match || !vr->cmp.average_chroma)) {
+		vr->dirty.chroma_stale = 1;
+		vr->dirty.chroma_row = row;
+		mark_line(vr, 0);
+		vr->next_line(vr, npixels);
+		return;
 	}
+	mark_line(vr, 1);
+
+	if (vr->cmp.average_chroma)
+		update_stale_chroma(vr);
+	vr->dirty.chroma_stale = 0;
+	vr->dirty.chroma_row = row;
+
+	int fybuf[VO_RENDER_MAX_LINE];  // lowpassed luma
+	cmp_simulated_demod(vr, burstn, vr->t, vswitch, data, x0, w, fybuf);
 
 	int *fubuf0 = vr->cmp.demod.fubuf[vswitch];
 	int *fvbuf0 = vr->cmp.demod.fvbuf[vswitch];
 	int *fubuf1 = vr->cmp.demod.fubuf[vr->cmp.vswitch];
 	int *fvbuf1 = vr->cmp.demod.fvbuf[vr->cmp.vswitch];
 
-	int_xyz rgb[1024];
+	// Convert to clamped R'G'B' planes, averaging chroma with previous
+	// line.  At one byte per component these stay in L1 on their way to
+	// the pack kernel.
+	uint8_t r[VO_RENDER_MAX_LINE], g[VO_RENDER_MAX_LINE], b[VO_RENDER_MAX_LINE];
+	vo_render_kernels.convert(vr, r + x0, g + x0, b + x0, fybuf + x0, fubuf0 + x0, fvbuf0 + x0, fubuf1 + x0, fvbuf1 + x0, w);
 
-	for (unsigned i = vr->viewport.x; i < (unsigned)(vr->viewport.x + vr->viewport.w); i++) {
-		int fy = 0;
-		int yorder = vr->cmp.demod.yfilter.order;
-		for (int ft = -yorder; ft <= yorder; ft++) {
-			fy += vr->cmp.demod.yfilter.coeff[ft] * mbuf[i+ft];
-		}
-		fy >>= (15-9);  // fy won't be multiplied by [rgb]_conv
-
-		int fu0 = 0, fv0 = 0;
-		if (burstn) {
-			int corder = vr->cmp.demod.corder;
-			for (int ft = -corder; ft <= corder; ft++) {
-				fu0 += vr->cmp.demod.ufilter.coeff[ft] * ubuf[i+ft];
-				fv0 += vr->cmp.demod.vfilter.coeff[ft] * vbuf[i+ft];
-			}
-			fu0 >>= 15;
-			fv0 >>= 15;
-		}
-		fubuf0[i] = fu0;
-		fvbuf0[i] = fv0;
-
-		int fu1 = fubuf1[i];
-		int fu = (fu0 + fu1) >> 1;
-		int fv1 = fvbuf1[i];
-		int fv = (fv0 + fv1) >> 1;
-
-		// Apply saturation control
-		int ru = (fu * vr->cmp.demod.saturation) >> 9;
-                int rv = (fv * vr->cmp.demod.saturation) >> 9;
-
-		// Limits on chroma values
-		if (ru < vr->cmp.demod.ulimit.lower) ru = vr->cmp.demod.ulimit.lower;
-		if (ru > vr->cmp.demod.ulimit.upper) ru = vr->cmp.demod.ulimit.upper;
-		if (rv < vr->cmp.demod.vlimit.lower) rv = vr->cmp.demod.vlimit.lower;
-		if (rv > vr->cmp.demod.vlimit.upper) rv = vr->cmp.demod.vlimit.upper;
-
-		// Convert to R'G'B' in supplied output buffer
-		rgb[i].x = (fy + ru*vr->cmp.demod.rconv.umul + rv*vr->cmp.demod.rconv.vmul) >> 10;
-		rgb[i].y = (fy + ru*vr->cmp.demod.gconv.umul + rv*vr->cmp.demod.gconv.vmul) >> 10;
-		rgb[i].z = (fy + ru*vr->cmp.demod.bconv.umul + rv*vr->cmp.demod.bconv.vmul) >> 10;
+	// Gamma correct and pack into output
+	int vx = vr->viewport.x;
+	vr->render_rgb(vr, r + vx, g + vx, b + vx, vr->pixel, vr->viewport.w);
+	vr->next_line(vr, npixels);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Dirty line tracking
+
+// Compare a line against the record of what was last rendered into the
+// current row, updating the record.  Returns true if they match.
+
+static _Bool check_line(struct vo_render *vr, int mode, unsigned burstn, unsigned t,
+			int vswitch, uint8_t const *data, int lo, int hi) {
+	if (vr->dirty.row >= vr->dirty.nlines || lo < 0 || hi > VO_RENDER_MAX_LINE)
+		return 0;
+	struct vo_render_line *line = &vr->dirty.line[vr->dirty.row];
+	if (line->generation == vr->dirty.generation &&
+	    line->mode == mode && line->burstn == burstn &&
+	    line->t == t && line->vswitch == vswitch &&
+	    line->x == vr->viewport.x && line->w == vr->viewport.w &&
+	    line->lo == lo && line->hi == hi &&
+	    memcmp(line->data + lo, data + lo, hi - lo) == 0) {
+		return 1;
 	}
+	line->generation = vr->dirty.generation;
+	line->mode = mode;
+	line->burstn = burstn;
+	line->t = t;
+	line->vswitch = vswitch;
+	line->x = vr->viewport.x;
+	line->w = vr->viewport.w;
+	line->lo = lo;
+	line->hi = hi;
+	memcpy(line->data + lo, data + lo, hi - lo);
+	return 0;
+}
 
-	// Render from intermediate RGB buffer
-	vr->render_rgb(vr, rgb + vr->viewport.x, vr->pixel, vr->viewport.w);
-	vr->next_line(vr, npixels);
+// Advance to the next row, noting whether the current one was modified
+
+static void mark_line(struct vo_render *vr, _Bool dirty) {
+	int row = vr->dirty.row++;
+	if (!dirty)
+		return;
+	if (vr->dirty.y0 >= vr->dirty.y1) {
+		vr->dirty.y0 = row;
+		vr->dirty.y1 = row + 1;
+		return;
+	}
+	if (row < vr->dirty.y0)
+		vr->dirty.y0 = row;
+	if (row >= vr->dirty.y1)
+		vr->dirty.y1 = row + 1;
+}
+
+// Forget all line records.  Called before anything changes that might affect
+// rendered output.
+
+static void invalidate_lines(struct vo_render *vr) {
+	update_stale_chroma(vr);
+	vr->dirty.generation++;
+}
+
+// Resize line records to match the viewport
+
+static void update_line_records(struct vo_render *vr) {
+	if (vr->viewport.h < 0 || (unsigned)vr->viewport.h == vr->dirty.nlines)
+		return;
+	update_stale_chroma(vr);
+	vr->dirty.generation++;
+	vr->dirty.nlines = vr->viewport.h;
+	vr->dirty.line = xrealloc(vr->dirty.line, vr->dirty.nlines * sizeof(*vr->dirty.line));
+	for (unsigned i = 0; i < vr->dirty.nlines; i++) {
+		vr->dirty.line[i].generation = vr->dirty.generation - 1;
+	}
 }
@@ -40,6 +40,9 @@
 
 #include "ntsc.h"
 
+struct capture;
+struct vo_render_thread;
+
 // Window Area, Draw Area and Picture Area defined in vo.h.
 
 // Viewport defines the region of the emulated video output that is to be
@@ -148,6 +151,13 @@ extern const char *vo_render_system_name[NUM_VO_RENDER_SYSTEM];
 // Largest value of 'tmax' (and thus 't')
 #define VO_RENDER_MAX_T (228)
 
+// Longest scanline, in samples, handled by the composite renderers
+#define VO_RENDER_MAX_LINE (1024)
+
+// Modulation tables repeat their first 'tmax' entries to this length, so a
+// whole scanline can be indexed linearly from any starting phase
+#define VO_RENDER_PHASE_TABLE_LEN (VO_RENDER_MAX_T + VO_RENDER_MAX_LINE)
+
 // Composite Video simulation
 //
 // The supported signals are defined as:
@@ -176,15 +186,15 @@ struct vo_render_burst {
 
 	// Values to multiply U and V at time 't' when modulating
 	struct {
-		int u[VO_RENDER_MAX_T];     // typically  sin ωt
-		int v[2][VO_RENDER_MAX_T];  // typically ±cos ωt
+		int u[VO_RENDER_PHASE_TABLE_LEN];     // typically  sin ωt
+		int v[2][VO_RENDER_PHASE_TABLE_LEN];  // typically ±cos ωt
 	} mod;
 
 	// Multiplied against signal and then low-pass filtered to
 	// extract U and V
 	struct {
-		int u[VO_RENDER_MAX_T];     // typically  2 sin ωt
-		int v[2][VO_RENDER_MAX_T];  // typically ±2 cos ωt
+		int u[VO_RENDER_PHASE_TABLE_LEN];     // typically  2 sin ωt
+		int v[2][VO_RENDER_PHASE_TABLE_LEN];  // typically ±2 cos ωt
 	} demod;
 
 	// Data for the 'partial' renderer
@@ -199,6 +209,27 @@ struct vo_render_filter {
 	int *coeff;
 };
 
+// Record of the line last rendered into a row of the output buffer.  If the
+// next line destined for that row has the same data and rendering state, it
+// need not be converted again.
+
+struct vo_render_line {
+	// Matches vo_render's dirty.generation while record is valid
+	unsigned generation;
+
+	// Rendering state that affects output
+	int mode;
+	unsigned burstn;
+	unsigned t;
+	int vswitch;
+	int x, w;
+
+	// Extent of source data that contributes to the output.  Data is stored
+	// at the same offsets as in the source line.
+	int lo, hi;
+	uint8_t data[VO_RENDER_MAX_LINE];
+};
+
 struct vo_render {
 	struct {
 		// Record values for recalculation
@@ -263,8 +294,8 @@ struct vo_render {
 			int morder;  // max of corder, yfilter.order
 
 			// Filter chroma line delay.  Used in PAL averaging.
-			int fubuf[2][1024];
-			int fvbuf[2][1024];
+			int fubuf[2][VO_RENDER_MAX_LINE];
+			int fvbuf[2][VO_RENDER_MAX_LINE];
 
 			// Saturation converted to integer
 			int saturation;
@@ -337,6 +368,32 @@ struct vo_render {
 	// Amount to advance pixel pointer each line
 	int buffer_pitch;
 
+	// Dirty line tracking
+	struct {
+		// Incremented to invalidate all line records
+		unsigned generation;
+
+		// One record per row of the viewport
+		unsigned nlines;
+		struct vo_render_line *line;
+
+		// Current row in output buffer
+		unsigned row;
+
+		// Range of rows modified since last fetched with
+		// vo_render_take_dirty().  Empty if y0 >= y1.
+		int y0, y1;
+
+		// PAL chroma averaging makes a line depend on the previous
+		// one.  Track whether the previous line was unchanged, and
+		// whether its filtered chroma was skipped and so will need
+		// recalculating from its record before the next line can be
+		// rendered.
+		_Bool chroma_match;
+		_Bool chroma_stale;
+		unsigned chroma_row;
+	} dirty;
+
 	// Display adjustments
 	int brightness;
 	int contrast;
@@ -367,9 +424,12 @@ struct vo_render {
 	void (*render_cmp_2bit)(void *, unsigned, unsigned, uint8_t const *);
 	void (*render_cmp_5bit)(void *, unsigned, unsigned, uint8_t const *);
 
-	// Helper for render_line implementations that generate an intermediate
-	// array of RGB values
-	void (*render_rgb)(struct vo_render *, int_xyz *, void *, unsigned);
+	// Helper for render_line implementations that generate intermediate
+	// planes of clamped R'G'B' values
+	//     uint8_t const *r, *g, *b;  // R'G'B' planes
+	//     void *dest;                // output pixels
+	//     unsigned npixels;
+	void (*render_rgb)(struct vo_render *, uint8_t const *, uint8_t const *, uint8_t const *, void *, unsigned);
 
 	// Advance to next line
 	//     unsigned npixels;  // elapsed time in pixels
@@ -377,6 +437,14 @@ struct vo_render {
 
 	// Convert line into RGB (uint8s in that order) for screenshots
 	void (*line_to_rgb)(struct vo_render *, int, uint8_t *);
+
+	// Worker thread, if rendering is pipelined
+	struct vo_render_thread *thread;
+
+	// Completed frames are passed to this at vsync, if set
+	struct capture *capture;
+	// Cleared when capture starts: the first vsync ends a partial frame
+	_Bool capture_synced;
 };
 
 // Create a new renderer for the specified pixel format
@@ -390,12 +458,24 @@ void vo_render_free(struct vo_render *vr);
 // Set buffer to render into
 inline void vo_render_set_buffer(struct vo_render *vr, void *buffer) {
 	vr->pixel = vr->buffer = buffer;
+	vr->dirty.generation++;
+}
+
+// Fetch and reset the range of rows modified since the last call.  Video
+// modules may use this in their draw() function to avoid updating unchanged
+// areas.  Returns false if no rows were modified.
+inline _Bool vo_render_take_dirty(struct vo_render *vr, int *y0, int *y1) {
+	*y0 = vr->dirty.y0;
+	*y1 = vr->dirty.y1;
+	vr->dirty.y0 = vr->dirty.y1 = 0;
+	return *y0 < *y1;
 }
 
 // Used by UI to adjust viewing parameters
 
 void vo_render_set_viewport(struct vo_render *, int w, int h);
 void vo_render_set_ntsc_scaling(struct vo_render *, _Bool notify, _Bool enabled);
+void vo_render_set_capture(struct vo_render *, struct capture *);
 void vo_render_set_brightness(void *, int value);
 void vo_render_set_contrast(void *, int value);
 void vo_render_set_saturation(void *, int value);
@@ -422,4 +502,24 @@ void vo_render_vsync(void *);
 void vo_render_cmp_partial(void *, unsigned burstn, unsigned npixels, uint8_t const *data);
 void vo_render_cmp_simulated(void *, unsigned burstn, unsigned npixels, uint8_t const *data);
 
+// Rendering in a worker thread (vo_render_thread.c)
+
+// Start or stop a worker thread.  While running, the video module's
+// render_line delegate should be passed through
+// vo_render_thread_line_delegate().
+void vo_render_set_threaded(struct vo_render *, _Bool threaded);
+
+// If there is a worker thread, return a delegate that queues lines for it
+// to pass to 'render_line'.  Otherwise, returns 'render_line'.
+DELEGATE_T3(void, unsigned, unsigned, uint8cp) vo_render_thread_line_delegate(struct vo_render *, DELEGATE_T3(void, unsigned, unsigned, uint8cp) render_line);
+
+void vo_render_thread_sync(struct vo_render_thread *);
+
+// Wait for any worker thread to finish rendering queued lines.  Must be
+// called before accessing renderer state from outside the worker.
+inline void vo_render_sync(struct vo_render *vr) {
+	if (vr && vr->thread)
+		vo_render_thread_sync(vr->thread);
+}
+
 #endif
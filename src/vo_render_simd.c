@@ -0,0 +1,626 @@
+/** \file
+ *
+ *  \brief Video renderer vector kernels.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  All arithmetic is 32-bit integer, so vector versions only need to match
+ *  the generic code in operation order where results are shifted or clamped.
+ *  Sums are unaffected by the order in which terms are accumulated.
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "intfuncs.h"
+#include "pl-once.h"
+
+#include "logging.h"
+#include "vo_render.h"
+#include "vo_render_simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VO_RENDER_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define VO_RENDER_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+static void fir_generic(int *dest, int const *src, int const *coeff, int order,
+			int shift, int n);
+static void convert_generic(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			    int const *fy, int const *fu0, int const *fv0,
+			    int const *fu1, int const *fv1, int n);
+static void pack32_generic(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+			   uint8_t const *b, uint8_t const *lut,
+			   int rshift, int gshift, int bshift, uint32_t alpha, int n);
+static void pack_rgba4_generic(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			       uint8_t const *b, uint8_t const *lut, int n);
+static void pack_rgb565_generic(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+				uint8_t const *b, uint8_t const *lut, int n);
+
+struct vo_render_kernels vo_render_kernels = {
+	.name = "generic",
+	.fir = fir_generic,
+	.convert = convert_generic,
+	.pack32 = pack32_generic,
+	.pack_rgba4 = pack_rgba4_generic,
+	.pack_rgb565 = pack_rgb565_generic,
+};
+
+// Vector packing works on chunks of this many pixels.  The gamma lookup for
+// each chunk is done first, a byte at a time, into a small buffer.
+
+#define PACK_CHUNK (16)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Generic
+
+static void fir_generic(int *dest, int const *src, int const *coeff, int order,
+			int shift, int n) {
+	for (int i = 0; i < n; i++) {
+		int f = 0;
+		for (int ft = -order; ft <= order; ft++) {
+			f += coeff[ft] * src[i+ft];
+		}
+		dest[i] = f >> shift;
+	}
+}
+
+static inline int_xyz convert_one(struct vo_render *vr, int fy, int fu0, int fv0, int fu1, int fv1) {
+	int fu = (fu0 + fu1) >> 1;
+	int fv = (fv0 + fv1) >> 1;
+
+	// Apply saturation control
+	int ru = (fu * vr->cmp.demod.saturation) >> 9;
+	int rv = (fv * vr->cmp.demod.saturation) >> 9;
+
+	// Limits on chroma values
+	if (ru < vr->cmp.demod.ulimit.lower) ru = vr->cmp.demod.ulimit.lower;
+	if (ru > vr->cmp.demod.ulimit.upper) ru = vr->cmp.demod.ulimit.upper;
+	if (rv < vr->cmp.demod.vlimit.lower) rv = vr->cmp.demod.vlimit.lower;
+	if (rv > vr->cmp.demod.vlimit.upper) rv = vr->cmp.demod.vlimit.upper;
+
+	// Convert to R'G'B'
+	int_xyz rgb;
+	rgb.x = (fy + ru*vr->cmp.demod.rconv.umul + rv*vr->cmp.demod.rconv.vmul) >> 10;
+	rgb.y = (fy + ru*vr->cmp.demod.gconv.umul + rv*vr->cmp.demod.gconv.vmul) >> 10;
+	rgb.z = (fy + ru*vr->cmp.demod.bconv.umul + rv*vr->cmp.demod.bconv.vmul) >> 10;
+	return rgb;
+}
+
+static void convert_generic(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			    int const *fy, int const *fu0, int const *fv0,
+			    int const *fu1, int const *fv1, int n) {
+	for (int i = 0; i < n; i++) {
+		int_xyz rgb = convert_one(vr, fy[i], fu0[i], fv0[i], fu1[i], fv1[i]);
+		r[i] = int_clamp_u8(rgb.x);
+		g[i] = int_clamp_u8(rgb.y);
+		b[i] = int_clamp_u8(rgb.z);
+	}
+}
+
+static void pack32_generic(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+			   uint8_t const *b, uint8_t const *lut,
+			   int rshift, int gshift, int bshift, uint32_t alpha, int n) {
+	for (int i = 0; i < n; i++) {
+		dest[i] = ((uint32_t)lut[r[i]] << rshift) | ((uint32_t)lut[g[i]] << gshift) |
+			  ((uint32_t)lut[b[i]] << bshift) | alpha;
+	}
+}
+
+static void pack_rgba4_generic(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			       uint8_t const *b, uint8_t const *lut, int n) {
+	for (int i = 0; i < n; i++) {
+		int R = lut[r[i]], G = lut[g[i]], B = lut[b[i]];
+		dest[i] = ((R & 0xf0) << 8) | ((G & 0xf0) << 4) | (B & 0xf0) | 0x0f;
+	}
+}
+
+static void pack_rgb565_generic(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+				uint8_t const *b, uint8_t const *lut, int n) {
+	for (int i = 0; i < n; i++) {
+		int R = lut[r[i]], G = lut[g[i]], B = lut[b[i]];
+		dest[i] = ((R & 0xf8) << 8) | ((G & 0xfc) << 3) | ((B & 0xf8) >> 3);
+	}
+}
+
+// Gamma lookup for one chunk, used by the vector pack kernels
+
+static inline void lookup_chunk(uint8_t (*t)[PACK_CHUNK], uint8_t const *r,
+				uint8_t const *g, uint8_t const *b,
+				uint8_t const *lut) {
+	for (int j = 0; j < PACK_CHUNK; j++) {
+		t[0][j] = lut[r[j]];
+		t[1][j] = lut[g[j]];
+		t[2][j] = lut[b[j]];
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifdef VO_RENDER_SIMD_X86
+
+// SSE2 has no 32-bit multiply (low) or signed 32-bit min/max, so those are
+// built from what it does have.
+
+__attribute__((target("sse2")))
+static inline __m128i mullo_sse2(__m128i a, __m128i b) {
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+				  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i clamp_sse2(__m128i a, __m128i lower, __m128i upper) {
+	__m128i lt = _mm_cmplt_epi32(a, lower);
+	a = _mm_or_si128(_mm_and_si128(lt, lower), _mm_andnot_si128(lt, a));
+	__m128i gt = _mm_cmpgt_epi32(a, upper);
+	return _mm_or_si128(_mm_and_si128(gt, upper), _mm_andnot_si128(gt, a));
+}
+
+__attribute__((target("sse2")))
+static void fir_sse2(int *dest, int const *src, int const *coeff, int order,
+		     int shift, int n) {
+	__m128i vshift = _mm_cvtsi32_si128(shift);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i f = _mm_setzero_si128();
+		for (int ft = -order; ft <= order; ft++) {
+			__m128i s = _mm_loadu_si128((__m128i const *)(src + i + ft));
+			f = _mm_add_epi32(f, mullo_sse2(_mm_set1_epi32(coeff[ft]), s));
+		}
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_sra_epi32(f, vshift));
+	}
+	fir_generic(dest + i, src + i, coeff, order, shift, n - i);
+}
+
+// Saturating packs clamp 32-bit values to 0-255, same as int_clamp_u8().
+// Stores the low four bytes.
+
+__attribute__((target("sse2")))
+static inline void store4_u8_sse2(uint8_t *dest, __m128i a) {
+	__m128i p = _mm_packus_epi16(_mm_packs_epi32(a, a), a);
+	uint32_t v = (uint32_t)_mm_cvtsi128_si32(p);
+	memcpy(dest, &v, 4);
+}
+
+__attribute__((target("sse2")))
+static void convert_sse2(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			 int const *fy, int const *fu0, int const *fv0,
+			 int const *fu1, int const *fv1, int n) {
+	__m128i sat = _mm_set1_epi32(vr->cmp.demod.saturation);
+	__m128i ulower = _mm_set1_epi32(vr->cmp.demod.ulimit.lower);
+	__m128i uupper = _mm_set1_epi32(vr->cmp.demod.ulimit.upper);
+	__m128i vlower = _mm_set1_epi32(vr->cmp.demod.vlimit.lower);
+	__m128i vupper = _mm_set1_epi32(vr->cmp.demod.vlimit.upper);
+	__m128i rumul = _mm_set1_epi32(vr->cmp.demod.rconv.umul);
+	__m128i rvmul = _mm_set1_epi32(vr->cmp.demod.rconv.vmul);
+	__m128i gumul = _mm_set1_epi32(vr->cmp.demod.gconv.umul);
+	__m128i gvmul = _mm_set1_epi32(vr->cmp.demod.gconv.vmul);
+	__m128i bumul = _mm_set1_epi32(vr->cmp.demod.bconv.umul);
+	__m128i bvmul = _mm_set1_epi32(vr->cmp.demod.bconv.vmul);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i y = _mm_loadu_si128((__m128i const *)(fy + i));
+		__m128i u = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((__m128i const *)(fu0 + i)),
+							 _mm_loadu_si128((__m128i const *)(fu1 + i))), 1);
+		__m128i v = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((__m128i const *)(fv0 + i)),
+							 _mm_loadu_si128((__m128i const *)(fv1 + i))), 1);
+		u = clamp_sse2(_mm_srai_epi32(mullo_sse2(u, sat), 9), ulower, uupper);
+		v = clamp_sse2(_mm_srai_epi32(mullo_sse2(v, sat), 9), vlower, vupper);
+		store4_u8_sse2(r + i, _mm_srai_epi32(_mm_add_epi32(y, _mm_add_epi32(mullo_sse2(u, rumul), mullo_sse2(v, rvmul))), 10));
+		store4_u8_sse2(g + i, _mm_srai_epi32(_mm_add_epi32(y, _mm_add_epi32(mullo_sse2(u, gumul), mullo_sse2(v, gvmul))), 10));
+		store4_u8_sse2(b + i, _mm_srai_epi32(_mm_add_epi32(y, _mm_add_epi32(mullo_sse2(u, bumul), mullo_sse2(v, bvmul))), 10));
+	}
+	convert_generic(vr, r + i, g + i, b + i, fy + i, fu0 + i, fv0 + i, fu1 + i, fv1 + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i pack4_32_sse2(__m128i r, __m128i g, __m128i b,
+				    __m128i rshift, __m128i gshift, __m128i bshift,
+				    __m128i alpha) {
+	return _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, rshift), _mm_sll_epi32(g, gshift)),
+			    _mm_or_si128(_mm_sll_epi32(b, bshift), alpha));
+}
+
+__attribute__((target("sse2")))
+static void pack32_sse2(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+			uint8_t const *b, uint8_t const *lut,
+			int rshift, int gshift, int bshift, uint32_t alpha, int n) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i vrshift = _mm_cvtsi32_si128(rshift);
+	__m128i vgshift = _mm_cvtsi32_si128(gshift);
+	__m128i vbshift = _mm_cvtsi32_si128(bshift);
+	__m128i valpha = _mm_set1_epi32((int)alpha);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		__m128i R = _mm_loadu_si128((__m128i const *)t[0]);
+		__m128i G = _mm_loadu_si128((__m128i const *)t[1]);
+		__m128i B = _mm_loadu_si128((__m128i const *)t[2]);
+		__m128i R16[2] = { _mm_unpacklo_epi8(R, zero), _mm_unpackhi_epi8(R, zero) };
+		__m128i G16[2] = { _mm_unpacklo_epi8(G, zero), _mm_unpackhi_epi8(G, zero) };
+		__m128i B16[2] = { _mm_unpacklo_epi8(B, zero), _mm_unpackhi_epi8(B, zero) };
+		for (int k = 0; k < 2; k++) {
+			__m128i *d = (__m128i *)(dest + i + k*8);
+			_mm_storeu_si128(d, pack4_32_sse2(_mm_unpacklo_epi16(R16[k], zero),
+							  _mm_unpacklo_epi16(G16[k], zero),
+							  _mm_unpacklo_epi16(B16[k], zero),
+							  vrshift, vgshift, vbshift, valpha));
+			_mm_storeu_si128(d + 1, pack4_32_sse2(_mm_unpackhi_epi16(R16[k], zero),
+							      _mm_unpackhi_epi16(G16[k], zero),
+							      _mm_unpackhi_epi16(B16[k], zero),
+							      vrshift, vgshift, vbshift, valpha));
+		}
+	}
+	pack32_generic(dest + i, r + i, g + i, b + i, lut, rshift, gshift, bshift, alpha, n - i);
+}
+
+__attribute__((target("sse2")))
+static void pack_rgba4_sse2(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			    uint8_t const *b, uint8_t const *lut, int n) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i mask = _mm_set1_epi16(0xf0);
+	__m128i alpha = _mm_set1_epi16(0x0f);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		__m128i R = _mm_loadu_si128((__m128i const *)t[0]);
+		__m128i G = _mm_loadu_si128((__m128i const *)t[1]);
+		__m128i B = _mm_loadu_si128((__m128i const *)t[2]);
+		for (int k = 0; k < 2; k++) {
+			__m128i R16 = k ? _mm_unpackhi_epi8(R, zero) : _mm_unpacklo_epi8(R, zero);
+			__m128i G16 = k ? _mm_unpackhi_epi8(G, zero) : _mm_unpacklo_epi8(G, zero);
+			__m128i B16 = k ? _mm_unpackhi_epi8(B, zero) : _mm_unpacklo_epi8(B, zero);
+			__m128i p = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(R16, mask), 8),
+						 _mm_slli_epi16(_mm_and_si128(G16, mask), 4));
+			p = _mm_or_si128(p, _mm_or_si128(_mm_and_si128(B16, mask), alpha));
+			_mm_storeu_si128((__m128i *)(dest + i + k*8), p);
+		}
+	}
+	pack_rgba4_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+__attribute__((target("sse2")))
+static void pack_rgb565_sse2(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			     uint8_t const *b, uint8_t const *lut, int n) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i rmask = _mm_set1_epi16(0xf8);
+	__m128i gmask = _mm_set1_epi16(0xfc);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		__m128i R = _mm_loadu_si128((__m128i const *)t[0]);
+		__m128i G = _mm_loadu_si128((__m128i const *)t[1]);
+		__m128i B = _mm_loadu_si128((__m128i const *)t[2]);
+		for (int k = 0; k < 2; k++) {
+			__m128i R16 = k ? _mm_unpackhi_epi8(R, zero) : _mm_unpacklo_epi8(R, zero);
+			__m128i G16 = k ? _mm_unpackhi_epi8(G, zero) : _mm_unpacklo_epi8(G, zero);
+			__m128i B16 = k ? _mm_unpackhi_epi8(B, zero) : _mm_unpacklo_epi8(B, zero);
+			__m128i p = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(R16, rmask), 8),
+						 _mm_slli_epi16(_mm_and_si128(G16, gmask), 3));
+			p = _mm_or_si128(p, _mm_srli_epi16(B16, 3));
+			_mm_storeu_si128((__m128i *)(dest + i + k*8), p);
+		}
+	}
+	pack_rgb565_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+__attribute__((target("avx2")))
+static void fir_avx2(int *dest, int const *src, int const *coeff, int order,
+		     int shift, int n) {
+	__m128i vshift = _mm_cvtsi32_si128(shift);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i f = _mm256_setzero_si256();
+		for (int ft = -order; ft <= order; ft++) {
+			__m256i s = _mm256_loadu_si256((__m256i const *)(src + i + ft));
+			f = _mm256_add_epi32(f, _mm256_mullo_epi32(_mm256_set1_epi32(coeff[ft]), s));
+		}
+		_mm256_storeu_si256((__m256i *)(dest + i), _mm256_sra_epi32(f, vshift));
+	}
+	fir_generic(dest + i, src + i, coeff, order, shift, n - i);
+}
+
+// Saturating packs operate within each 128-bit half, so the low four bytes of
+// each half hold the results.
+
+__attribute__((target("avx2")))
+static inline void store8_u8_avx2(uint8_t *dest, __m256i a) {
+	__m256i p = _mm256_packus_epi16(_mm256_packs_epi32(a, a), a);
+	uint32_t lo = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(p));
+	uint32_t hi = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(p, 1));
+	memcpy(dest, &lo, 4);
+	memcpy(dest + 4, &hi, 4);
+}
+
+__attribute__((target("avx2")))
+static void convert_avx2(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			 int const *fy, int const *fu0, int const *fv0,
+			 int const *fu1, int const *fv1, int n) {
+	__m256i sat = _mm256_set1_epi32(vr->cmp.demod.saturation);
+	__m256i ulower = _mm256_set1_epi32(vr->cmp.demod.ulimit.lower);
+	__m256i uupper = _mm256_set1_epi32(vr->cmp.demod.ulimit.upper);
+	__m256i vlower = _mm256_set1_epi32(vr->cmp.demod.vlimit.lower);
+	__m256i vupper = _mm256_set1_epi32(vr->cmp.demod.vlimit.upper);
+	__m256i rumul = _mm256_set1_epi32(vr->cmp.demod.rconv.umul);
+	__m256i rvmul = _mm256_set1_epi32(vr->cmp.demod.rconv.vmul);
+	__m256i gumul = _mm256_set1_epi32(vr->cmp.demod.gconv.umul);
+	__m256i gvmul = _mm256_set1_epi32(vr->cmp.demod.gconv.vmul);
+	__m256i bumul = _mm256_set1_epi32(vr->cmp.demod.bconv.umul);
+	__m256i bvmul = _mm256_set1_epi32(vr->cmp.demod.bconv.vmul);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i y = _mm256_loadu_si256((__m256i const *)(fy + i));
+		__m256i u = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((__m256i const *)(fu0 + i)),
+							       _mm256_loadu_si256((__m256i const *)(fu1 + i))), 1);
+		__m256i v = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((__m256i const *)(fv0 + i)),
+							       _mm256_loadu_si256((__m256i const *)(fv1 + i))), 1);
+		u = _mm256_srai_epi32(_mm256_mullo_epi32(u, sat), 9);
+		u = _mm256_min_epi32(_mm256_max_epi32(u, ulower), uupper);
+		v = _mm256_srai_epi32(_mm256_mullo_epi32(v, sat), 9);
+		v = _mm256_min_epi32(_mm256_max_epi32(v, vlower), vupper);
+		store8_u8_avx2(r + i, _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(u, rumul), _mm256_mullo_epi32(v, rvmul))), 10));
+		store8_u8_avx2(g + i, _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(u, gumul), _mm256_mullo_epi32(v, gvmul))), 10));
+		store8_u8_avx2(b + i, _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(u, bumul), _mm256_mullo_epi32(v, bvmul))), 10));
+	}
+	convert_generic(vr, r + i, g + i, b + i, fy + i, fu0 + i, fv0 + i, fu1 + i, fv1 + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void pack32_avx2(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+			uint8_t const *b, uint8_t const *lut,
+			int rshift, int gshift, int bshift, uint32_t alpha, int n) {
+	__m128i vrshift = _mm_cvtsi32_si128(rshift);
+	__m128i vgshift = _mm_cvtsi32_si128(gshift);
+	__m128i vbshift = _mm_cvtsi32_si128(bshift);
+	__m256i valpha = _mm256_set1_epi32((int)alpha);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		for (int k = 0; k < PACK_CHUNK; k += 8) {
+			__m256i R = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)(t[0] + k)));
+			__m256i G = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)(t[1] + k)));
+			__m256i B = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)(t[2] + k)));
+			__m256i p = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(R, vrshift), _mm256_sll_epi32(G, vgshift)),
+						    _mm256_or_si256(_mm256_sll_epi32(B, vbshift), valpha));
+			_mm256_storeu_si256((__m256i *)(dest + i + k), p);
+		}
+	}
+	pack32_generic(dest + i, r + i, g + i, b + i, lut, rshift, gshift, bshift, alpha, n - i);
+}
+
+__attribute__((target("avx2")))
+static void pack_rgba4_avx2(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			    uint8_t const *b, uint8_t const *lut, int n) {
+	__m256i mask = _mm256_set1_epi16(0xf0);
+	__m256i alpha = _mm256_set1_epi16(0x0f);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		__m256i R = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[0]));
+		__m256i G = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[1]));
+		__m256i B = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[2]));
+		__m256i p = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(R, mask), 8),
+					    _mm256_slli_epi16(_mm256_and_si256(G, mask), 4));
+		p = _mm256_or_si256(p, _mm256_or_si256(_mm256_and_si256(B, mask), alpha));
+		_mm256_storeu_si256((__m256i *)(dest + i), p);
+	}
+	pack_rgba4_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+__attribute__((target("avx2")))
+static void pack_rgb565_avx2(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			     uint8_t const *b, uint8_t const *lut, int n) {
+	__m256i rmask = _mm256_set1_epi16(0xf8);
+	__m256i gmask = _mm256_set1_epi16(0xfc);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		__m256i R = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[0]));
+		__m256i G = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[1]));
+		__m256i B = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)t[2]));
+		__m256i p = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(R, rmask), 8),
+					    _mm256_slli_epi16(_mm256_and_si256(G, gmask), 3));
+		p = _mm256_or_si256(p, _mm256_srli_epi16(B, 3));
+		_mm256_storeu_si256((__m256i *)(dest + i), p);
+	}
+	pack_rgb565_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifdef VO_RENDER_SIMD_NEON
+
+static void fir_neon(int *dest, int const *src, int const *coeff, int order,
+		     int shift, int n) {
+	int32x4_t vshift = vdupq_n_s32(-shift);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		int32x4_t f = vdupq_n_s32(0);
+		for (int ft = -order; ft <= order; ft++) {
+			f = vmlaq_n_s32(f, vld1q_s32(src + i + ft), coeff[ft]);
+		}
+		vst1q_s32(dest + i, vshlq_s32(f, vshift));
+	}
+	fir_generic(dest + i, src + i, coeff, order, shift, n - i);
+}
+
+// Saturating narrows clamp 32-bit values to 0-255, same as int_clamp_u8().
+// Stores four bytes.
+
+static inline void store4_u8_neon(uint8_t *dest, int32x4_t a) {
+	int16x4_t a16 = vqmovn_s32(a);
+	uint8x8_t p = vqmovun_s16(vcombine_s16(a16, a16));
+	uint32_t v = vget_lane_u32(vreinterpret_u32_u8(p), 0);
+	memcpy(dest, &v, 4);
+}
+
+static void convert_neon(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			 int const *fy, int const *fu0, int const *fv0,
+			 int const *fu1, int const *fv1, int n) {
+	int sat = vr->cmp.demod.saturation;
+	int32x4_t ulower = vdupq_n_s32(vr->cmp.demod.ulimit.lower);
+	int32x4_t uupper = vdupq_n_s32(vr->cmp.demod.ulimit.upper);
+	int32x4_t vlower = vdupq_n_s32(vr->cmp.demod.vlimit.lower);
+	int32x4_t vupper = vdupq_n_s32(vr->cmp.demod.vlimit.upper);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		int32x4_t y = vld1q_s32(fy + i);
+		int32x4_t u = vshrq_n_s32(vaddq_s32(vld1q_s32(fu0 + i), vld1q_s32(fu1 + i)), 1);
+		int32x4_t v = vshrq_n_s32(vaddq_s32(vld1q_s32(fv0 + i), vld1q_s32(fv1 + i)), 1);
+		u = vshrq_n_s32(vmulq_n_s32(u, sat), 9);
+		u = vminq_s32(vmaxq_s32(u, ulower), uupper);
+		v = vshrq_n_s32(vmulq_n_s32(v, sat), 9);
+		v = vminq_s32(vmaxq_s32(v, vlower), vupper);
+		store4_u8_neon(r + i, vshrq_n_s32(vmlaq_n_s32(vmlaq_n_s32(y, u, vr->cmp.demod.rconv.umul), v, vr->cmp.demod.rconv.vmul), 10));
+		store4_u8_neon(g + i, vshrq_n_s32(vmlaq_n_s32(vmlaq_n_s32(y, u, vr->cmp.demod.gconv.umul), v, vr->cmp.demod.gconv.vmul), 10));
+		store4_u8_neon(b + i, vshrq_n_s32(vmlaq_n_s32(vmlaq_n_s32(y, u, vr->cmp.demod.bconv.umul), v, vr->cmp.demod.bconv.vmul), 10));
+	}
+	convert_generic(vr, r + i, g + i, b + i, fy + i, fu0 + i, fv0 + i, fu1 + i, fv1 + i, n - i);
+}
+
+static void pack32_neon(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+			uint8_t const *b, uint8_t const *lut,
+			int rshift, int gshift, int bshift, uint32_t alpha, int n) {
+	int32x4_t vrshift = vdupq_n_s32(rshift);
+	int32x4_t vgshift = vdupq_n_s32(gshift);
+	int32x4_t vbshift = vdupq_n_s32(bshift);
+	uint32x4_t valpha = vdupq_n_u32(alpha);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		for (int k = 0; k < PACK_CHUNK; k += 8) {
+			uint16x8_t R = vmovl_u8(vld1_u8(t[0] + k));
+			uint16x8_t G = vmovl_u8(vld1_u8(t[1] + k));
+			uint16x8_t B = vmovl_u8(vld1_u8(t[2] + k));
+			uint32x4_t lo = vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(R)), vrshift),
+							    vshlq_u32(vmovl_u16(vget_low_u16(G)), vgshift)),
+						  vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(B)), vbshift), valpha));
+			uint32x4_t hi = vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(R)), vrshift),
+							    vshlq_u32(vmovl_u16(vget_high_u16(G)), vgshift)),
+						  vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(B)), vbshift), valpha));
+			vst1q_u32(dest + i + k, lo);
+			vst1q_u32(dest + i + k + 4, hi);
+		}
+	}
+	pack32_generic(dest + i, r + i, g + i, b + i, lut, rshift, gshift, bshift, alpha, n - i);
+}
+
+static void pack_rgba4_neon(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			    uint8_t const *b, uint8_t const *lut, int n) {
+	uint16x8_t mask = vdupq_n_u16(0xf0);
+	uint16x8_t alpha = vdupq_n_u16(0x0f);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		for (int k = 0; k < PACK_CHUNK; k += 8) {
+			uint16x8_t R = vmovl_u8(vld1_u8(t[0] + k));
+			uint16x8_t G = vmovl_u8(vld1_u8(t[1] + k));
+			uint16x8_t B = vmovl_u8(vld1_u8(t[2] + k));
+			uint16x8_t p = vorrq_u16(vshlq_n_u16(vandq_u16(R, mask), 8),
+						 vshlq_n_u16(vandq_u16(G, mask), 4));
+			p = vorrq_u16(p, vorrq_u16(vandq_u16(B, mask), alpha));
+			vst1q_u16(dest + i + k, p);
+		}
+	}
+	pack_rgba4_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+static void pack_rgb565_neon(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			     uint8_t const *b, uint8_t const *lut, int n) {
+	uint16x8_t rmask = vdupq_n_u16(0xf8);
+	uint16x8_t gmask = vdupq_n_u16(0xfc);
+	int i = 0;
+	for (; i + PACK_CHUNK <= n; i += PACK_CHUNK) {
+		uint8_t t[3][PACK_CHUNK];
+		lookup_chunk(t, r + i, g + i, b + i, lut);
+		for (int k = 0; k < PACK_CHUNK; k += 8) {
+			uint16x8_t R = vmovl_u8(vld1_u8(t[0] + k));
+			uint16x8_t G = vmovl_u8(vld1_u8(t[1] + k));
+			uint16x8_t B = vmovl_u8(vld1_u8(t[2] + k));
+			uint16x8_t p = vorrq_u16(vshlq_n_u16(vandq_u16(R, rmask), 8),
+						 vshlq_n_u16(vandq_u16(G, gmask), 3));
+			p = vorrq_u16(p, vshrq_n_u16(B, 3));
+			vst1q_u16(dest + i + k, p);
+		}
+	}
+	pack_rgb565_generic(dest + i, r + i, g + i, b + i, lut, n - i);
+}
+
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Kernels are chosen into a local copy and the table is then published in one
+// assignment, only ever once.
+
+static void select_kernels(void) {
+	struct vo_render_kernels k = vo_render_kernels;
+
+#ifdef VO_RENDER_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		k.name = "AVX2";
+		k.fir = fir_avx2;
+		k.convert = convert_avx2;
+		k.pack32 = pack32_avx2;
+		k.pack_rgba4 = pack_rgba4_avx2;
+		k.pack_rgb565 = pack_rgb565_avx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		k.name = "SSE2";
+		k.fir = fir_sse2;
+		k.convert = convert_sse2;
+		k.pack32 = pack32_sse2;
+		k.pack_rgba4 = pack_rgba4_sse2;
+		k.pack_rgb565 = pack_rgb565_sse2;
+	}
+#endif
+
+#ifdef VO_RENDER_SIMD_NEON
+	k.name = "NEON";
+	k.fir = fir_neon;
+	k.convert = convert_neon;
+	k.pack32 = pack32_neon;
+	k.pack_rgba4 = pack_rgba4_neon;
+	k.pack_rgb565 = pack_rgb565_neon;
+#endif
+
+	vo_render_kernels = k;
+	LOG_DEBUG(1, "Video renderer kernels: %s\n", vo_render_kernels.name);
+}
+
+static pl_once_t select_kernels_once = PL_ONCE_INIT;
+
+void vo_render_simd_init(void) {
+	pl_once(&select_kernels_once, select_kernels);
+}
@@ -0,0 +1,72 @@
+/** \file
+ *
+ *  \brief Video renderer vector kernels.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Inner loops of the fully simulated composite renderer, and packing of
+ *  R'G'B' into output pixel formats.  Generic versions are always available;
+ *  SSE2, AVX2 and NEON versions are selected at runtime where supported.  All
+ *  versions produce identical results.
+ */
+
+#ifndef XROAR_VO_RENDER_SIMD_H_
+#define XROAR_VO_RENDER_SIMD_H_
+
+#include <stdint.h>
+
+struct vo_render;
+
+struct vo_render_kernels {
+	// Name of the selected implementation, for logging
+	const char *name;
+
+	// FIR filter.  'coeff' points to the centre tap, so is indexed from
+	// -order to +order.  'src' must be readable from -order to
+	// n-1+order.
+	//
+	//     dest[i] = (Σ coeff[ft] * src[i+ft]) >> shift
+	void (*fir)(int *dest, int const *src, int const *coeff, int order,
+		    int shift, int n);
+
+	// Average filtered chroma with that of the previous line, apply
+	// saturation and limits, and convert with filtered luma to R'G'B'.
+	// Results are clamped to 0-255 and written to separate planes.
+	void (*convert)(struct vo_render *vr, uint8_t *r, uint8_t *g, uint8_t *b,
+			int const *fy, int const *fu0, int const *fv0,
+			int const *fu1, int const *fv1, int n);
+
+	// Gamma correct planar R'G'B' through 'lut' and pack into 32-bit
+	// pixels:
+	//
+	//     dest[i] = (R << rshift) | (G << gshift) | (B << bshift) | alpha
+	void (*pack32)(uint32_t *dest, uint8_t const *r, uint8_t const *g,
+		       uint8_t const *b, uint8_t const *lut,
+		       int rshift, int gshift, int bshift, uint32_t alpha, int n);
+
+	// As pack32(), but for the 16-bit formats
+	void (*pack_rgba4)(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			   uint8_t const *b, uint8_t const *lut, int n);
+	void (*pack_rgb565)(uint16_t *dest, uint8_t const *r, uint8_t const *g,
+			    uint8_t const *b, uint8_t const *lut, int n);
+};
+
+extern struct vo_render_kernels vo_render_kernels;
+
+// Select the best kernels for the host CPU.  Safe to call more than once, and
+// from more than one thread.
+
+void vo_render_simd_init(void);
+
+#endif
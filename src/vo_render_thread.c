@@ -0,0 +1,254 @@
+/** \file
+ *
+ *  \brief Video renderer worker thread.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Optionally moves scanline rendering off the emulation thread.  Each line
+ *  of palettised data passed to the render_line delegate is copied into a
+ *  single-producer, single-consumer ring, and a worker thread calls the real
+ *  line renderer.
+ *
+ *  Anything that reads or modifies renderer state from the emulation thread
+ *  must first call vo_render_sync() to wait for the worker to finish all
+ *  queued lines.  The public vo_render_set_*() functions and vo_vsync() do
+ *  this, so a vertical sync acts as a frame fence.
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_PTHREADS) && !defined(__STDC_NO_ATOMICS__)
+#define VO_RENDER_THREAD
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+#include "delegate.h"
+#include "xalloc.h"
+
+#include "logging.h"
+#include "vo_render.h"
+
+extern inline void vo_render_sync(struct vo_render *vr);
+
+#ifdef VO_RENDER_THREAD
+
+// Number of lines that can be queued.  Enough for most of a frame.
+#define RING_NLINES (256)
+
+// Times to poll for new work before sleeping
+#define WORKER_SPIN (1000)
+
+// A sleeping worker is only woken once this many lines are queued (or on
+// sync).  Waking it for every line costs more than rendering the line.
+#define WAKE_BATCH (16)
+
+struct vo_render_thread_line {
+	unsigned burstn;
+	unsigned npixels;
+	_Bool has_data;
+	uint8_t data[VO_RENDER_MAX_LINE];
+};
+
+struct vo_render_thread {
+	struct vo_render *vr;
+
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cv;  // worker waits on this for new lines
+	pthread_cond_t done_cv;  // emulation waits on this for free space
+
+	// Ring indices.  Only the emulation thread advances 'head', and only
+	// the worker advances 'tail'.
+	atomic_uint head;
+	atomic_uint tail;
+
+	// Set while the respective thread is (about to be) waiting on its
+	// condition variable, so the other knows to signal it.
+	atomic_bool worker_waiting;
+	atomic_bool producer_waiting;
+
+	atomic_bool quit;
+
+	// The real line renderer
+	DELEGATE_T3(void, unsigned, unsigned, uint8cp) render_line;
+
+	struct vo_render_thread_line ring[RING_NLINES];
+};
+
+static void *worker_main(void *sptr);
+
+// Wait until no more than 'nqueued' lines remain in the ring
+
+static void wait_for_worker(struct vo_render_thread *rt, unsigned nqueued) {
+	unsigned head = atomic_load(&rt->head);
+	if ((head - atomic_load(&rt->tail)) <= nqueued)
+		return;
+	pthread_mutex_lock(&rt->mutex);
+	atomic_store(&rt->producer_waiting, 1);
+	while ((head - atomic_load(&rt->tail)) > nqueued) {
+		pthread_cond_wait(&rt->done_cv, &rt->mutex);
+	}
+	atomic_store(&rt->producer_waiting, 0);
+	pthread_mutex_unlock(&rt->mutex);
+}
+
+static void wake_worker(struct vo_render_thread *rt) {
+	if (atomic_load(&rt->worker_waiting)) {
+		pthread_mutex_lock(&rt->mutex);
+		pthread_cond_signal(&rt->work_cv);
+		pthread_mutex_unlock(&rt->mutex);
+	}
+}
+
+static void *worker_main(void *sptr) {
+	struct vo_render_thread *rt = sptr;
+	unsigned tail = atomic_load(&rt->tail);
+	for (;;) {
+		unsigned head = atomic_load(&rt->head);
+		for (int i = 0; head == tail && i < WORKER_SPIN; i++) {
+			head = atomic_load(&rt->head);
+		}
+		if (head == tail) {
+			pthread_mutex_lock(&rt->mutex);
+			atomic_store(&rt->worker_waiting, 1);
+			while ((head = atomic_load(&rt->head)) == tail && !atomic_load(&rt->quit)) {
+				pthread_cond_wait(&rt->work_cv, &rt->mutex);
+			}
+			atomic_store(&rt->worker_waiting, 0);
+			pthread_mutex_unlock(&rt->mutex);
+			if (head == tail)
+				break;
+		}
+
+		while (tail != head) {
+			struct vo_render_thread_line *line = &rt->ring[tail % RING_NLINES];
+			DELEGATE_CALL(rt->render_line, line->burstn, line->npixels, line->has_data ? line->data : NULL);
+			tail++;
+			atomic_store(&rt->tail, tail);
+			if (atomic_load(&rt->producer_waiting)) {
+				pthread_mutex_lock(&rt->mutex);
+				pthread_cond_signal(&rt->done_cv);
+				pthread_mutex_unlock(&rt->mutex);
+			}
+		}
+	}
+	return NULL;
+}
+
+// Replaces the render_line delegate while the worker is running
+
+static void queue_line(void *sptr, unsigned burstn, unsigned npixels, uint8_t const *data) {
+	struct vo_render_thread *rt = sptr;
+	wait_for_worker(rt, RING_NLINES - 1);
+
+	unsigned head = atomic_load(&rt->head);
+	struct vo_render_thread_line *line = &rt->ring[head % RING_NLINES];
+	line->burstn = burstn;
+	line->npixels = npixels;
+	line->has_data = (data != NULL);
+	if (data) {
+		memcpy(line->data, data, (npixels < VO_RENDER_MAX_LINE) ? npixels : VO_RENDER_MAX_LINE);
+	}
+
+	head++;
+	atomic_store(&rt->head, head);
+	if ((head - atomic_load(&rt->tail)) >= WAKE_BATCH)
+		wake_worker(rt);
+}
+
+void vo_render_thread_sync(struct vo_render_thread *rt) {
+	wake_worker(rt);
+	wait_for_worker(rt, 0);
+}
+
+void vo_render_set_threaded(struct vo_render *vr, _Bool threaded) {
+	if (!vr)
+		return;
+
+	if (threaded && !vr->thread) {
+		struct vo_render_thread *rt = xmalloc(sizeof(*rt));
+		*rt = (struct vo_render_thread){0};
+		rt->vr = vr;
+		atomic_init(&rt->head, 0);
+		atomic_init(&rt->tail, 0);
+		atomic_init(&rt->worker_waiting, 0);
+		atomic_init(&rt->producer_waiting, 0);
+		atomic_init(&rt->quit, 0);
+		pthread_mutex_init(&rt->mutex, NULL);
+		pthread_cond_init(&rt->work_cv, NULL);
+		pthread_cond_init(&rt->done_cv, NULL);
+		if (pthread_create(&rt->thread, NULL, worker_main, rt) != 0) {
+			LOG_WARN("Failed to create video render thread\n");
+			pthread_cond_destroy(&rt->done_cv);
+			pthread_cond_destroy(&rt->work_cv);
+			pthread_mutex_destroy(&rt->mutex);
+			free(rt);
+			return;
+		}
+		vr->thread = rt;
+		LOG_DEBUG(1, "Video rendering in worker thread\n");
+		return;
+	}
+
+	if (!threaded && vr->thread) {
+		struct vo_render_thread *rt = vr->thread;
+		vo_render_thread_sync(rt);
+		pthread_mutex_lock(&rt->mutex);
+		atomic_store(&rt->quit, 1);
+		pthread_cond_signal(&rt->work_cv);
+		pthread_mutex_unlock(&rt->mutex);
+		pthread_join(rt->thread, NULL);
+		pthread_cond_destroy(&rt->done_cv);
+		pthread_cond_destroy(&rt->work_cv);
+		pthread_mutex_destroy(&rt->mutex);
+		free(rt);
+		vr->thread = NULL;
+	}
+}
+
+DELEGATE_T3(void, unsigned, unsigned, uint8cp) vo_render_thread_line_delegate(struct vo_render *vr, DELEGATE_T3(void, unsigned, unsigned, uint8cp) render_line) {
+	struct vo_render_thread *rt = vr ? vr->thread : NULL;
+	if (!rt)
+		return render_line;
+	vo_render_thread_sync(rt);
+	rt->render_line = render_line;
+	return DELEGATE_AS3(void, unsigned, unsigned, uint8cp, queue_line, rt);
+}
+
+#else
+
+// No thread support: everything runs synchronously
+
+void vo_render_thread_sync(struct vo_render_thread *rt) {
+	(void)rt;
+}
+
+void vo_render_set_threaded(struct vo_render *vr, _Bool threaded) {
+	(void)vr;
+	if (threaded) {
+		LOG_WARN("Video render thread not supported in this build\n");
+	}
+}
+
+DELEGATE_T3(void, unsigned, unsigned, uint8cp) vo_render_thread_line_delegate(struct vo_render *vr, DELEGATE_T3(void, unsigned, unsigned, uint8cp) render_line) {
+	(void)vr;
+	return render_line;
+}
+
+#endif
@@ -132,7 +132,7 @@ static void TNAME(set_palette_entry)(void *sptr, int palette, int index,
 
 // Render line using a palette
 
-static void TNAME(do_render_palette)(struct TNAME(vo_render) *vrt, unsigned npixels,
+static void TNAME(do_render_palette)(struct TNAME(vo_render) *vrt, int mode, unsigned npixels,
 				     VR_PTYPE *palette, uint8_t const *data) {
 	struct vo_render *vr = &vrt->generic;
 
@@ -144,6 +144,13 @@ static void TNAME(do_render_palette)(struct TNAME(vo_render) *vrt, unsigned npix
 		return;
 	}
 
+	if (check_line(vr, mode, 0, 0, 0, data, vr->viewport.x, vr->viewport.x + vr->viewport.w)) {
+		mark_line(vr, 0);
+		TNAME(next_line)(vr, npixels);
+		return;
+	}
+	mark_line(vr, 1);
+
 	uint8_t const *src = data + vr->viewport.x;
 	VR_PTYPE *dest = vr->pixel;
 	for (int i = vr->viewport.w >> 2; i; i--) {
@@ -172,8 +179,11 @@ static void TNAME(render_cmp_palette)(void *sptr, unsigned burstn, unsigned npix
 	struct vo_render *vr = &vrt->generic;
 	if (!burstn && !vr->cmp.colour_killer)
 		burstn = 1;
-	VR_PTYPE *palette = burstn ? vrt->cmp.palette : vrt->cmp.mono_palette;
-	TNAME(do_render_palette)(vrt, npixels, palette, data);
+	if (burstn) {
+		TNAME(do_render_palette)(vrt, LINE_CMP_PALETTE, npixels, vrt->cmp.palette, data);
+	} else {
+		TNAME(do_render_palette)(vrt, LINE_CMP_MONO, npixels, vrt->cmp.mono_palette, data);
+	}
 }
 
 // Render line using RGB palette
@@ -181,7 +191,7 @@ static void TNAME(render_cmp_palette)(void *sptr, unsigned burstn, unsigned npix
 static void TNAME(render_rgb_palette)(void *sptr, unsigned burstn, unsigned npixels, uint8_t const *data) {
 	struct TNAME(vo_render) *vrt = sptr;
 	(void)burstn;
-	TNAME(do_render_palette)(vrt, npixels, vrt->rgb.palette, data);
+	TNAME(do_render_palette)(vrt, LINE_RGB_PALETTE, npixels, vrt->rgb.palette, data);
 }
 
 // Render artefact colours using simple 2-bit LUT.
@@ -204,6 +214,13 @@ static void TNAME(render_cmp_2bit)(void *sptr, unsigned burstn, unsigned npixels
 		return;
 	}
 
+	if (check_line(vr, LINE_CMP_2BIT, 0, 0, 0, data, vr->viewport.x, vr->viewport.x + vr->viewport.w)) {
+		mark_line(vr, 0);
+		TNAME(next_line)(vr, npixels);
+		return;
+	}
+	mark_line(vr, 1);
+
 	uint8_t const *src = data + vr->viewport.x;
 	VR_PTYPE *dest = vr->pixel;
 	unsigned p = (vr->cmp.phase == 0);
@@ -255,6 +272,14 @@ static void TNAME(render_cmp_5bit)(void *sptr, unsigned burstn, unsigned npixels
 		return;
 	}
 
+	// Artefact colours depend on a few pixels either side
+	if (check_line(vr, LINE_CMP_5BIT, 0, 0, 0, data, vr->viewport.x - 6, vr->viewport.x + vr->viewport.w + 3)) {
+		mark_line(vr, 0);
+		TNAME(next_line)(vr, npixels);
+		return;
+	}
+	mark_line(vr, 1);
+
 	uint8_t const *src = data + vr->viewport.x;
 	VR_PTYPE *dest = vr->pixel;
 	unsigned p = (vr->cmp.phase == 0);
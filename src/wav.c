@@ -0,0 +1,56 @@
+/** \file
+ *
+ *  \brief WAV file output.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ *
+ *  Shared by the file audio module and audio capture.  Only the canonical
+ *  44-byte header is written: a "fmt " chunk followed directly by "data".
+ */
+
+#include "top-config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fs.h"
+#include "wav.h"
+
+extern inline void wav_put_le16(uint8_t *p, unsigned v);
+extern inline void wav_put_le32(uint8_t *p, uint32_t v);
+
+void wav_write_header(FILE *f, struct wav_header const *hdr, uint32_t data_nbytes) {
+	unsigned frame_nbytes = hdr->nchannels * hdr->sample_nbytes;
+	uint8_t buf[44];
+	memcpy(buf, "RIFF", 4);
+	wav_put_le32(buf + 4, data_nbytes + 36);
+	memcpy(buf + 8, "WAVEfmt ", 8);
+	wav_put_le32(buf + 16, 16);
+	wav_put_le16(buf + 20, hdr->format);
+	wav_put_le16(buf + 22, hdr->nchannels);
+	wav_put_le32(buf + 24, hdr->rate);
+	wav_put_le32(buf + 28, hdr->rate * frame_nbytes);
+	wav_put_le16(buf + 32, frame_nbytes);
+	wav_put_le16(buf + 34, hdr->sample_nbytes * 8);
+	memcpy(buf + 36, "data", 4);
+	wav_put_le32(buf + 40, data_nbytes);
+	fwrite(buf, 1, sizeof(buf), f);
+}
+
+void wav_update_header(FILE *f, struct wav_header const *hdr, uint32_t data_nbytes) {
+	if (fs_output_is_stdout(f) || fseek(f, 0, SEEK_SET) != 0)
+		return;
+	wav_write_header(f, hdr, data_nbytes);
+}
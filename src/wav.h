@@ -0,0 +1,65 @@
+/** \file
+ *
+ *  \brief WAV file output.
+ *
+ *  \copyright Copyright 2024 Ciaran Anscomb
+ *
+ *  \licenseblock This file is part of XRoar, a Dragon/Tandy CoCo emulator.
+ *
+ *  XRoar is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation, either version 3 of the License, or (at your option) any later
+ *  version.
+ *
+ *  See COPYING.GPL for redistribution conditions.
+ *
+ *  \endlicenseblock
+ */
+
+#ifndef XROAR_WAV_H_
+#define XROAR_WAV_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Sample formats for the WAV header
+
+#define WAV_FORMAT_PCM (1)
+#define WAV_FORMAT_IEEE_FLOAT (3)
+
+// Data length to write in the header while the real length is unknown.  Kept
+// as large as possible while leaving the RIFF length in range.
+
+#define WAV_DATA_NBYTES_UNKNOWN (0xffffffff - 36)
+
+struct wav_header {
+	unsigned format;  // WAV_FORMAT_*
+	unsigned nchannels;
+	unsigned rate;
+	unsigned sample_nbytes;
+};
+
+// Store little-endian values into a buffer.
+
+inline void wav_put_le16(uint8_t *p, unsigned v) {
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+inline void wav_put_le32(uint8_t *p, uint32_t v) {
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+// Write a 44-byte WAV header at the current file position.
+
+void wav_write_header(FILE *f, struct wav_header const *hdr, uint32_t data_nbytes);
+
+// Rewind and rewrite the header with the final data length.  Does nothing if
+// the file can't be rewound (e.g. writing to stdout).
+
+void wav_update_header(FILE *f, struct wav_header const *hdr, uint32_t data_nbytes);
+
+#endif
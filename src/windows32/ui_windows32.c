@@ -612,6 +612,10 @@ static void windows32_ui_update_state(void *sptr, int tag, int value, const void
 		CheckMenuRadioItem(uiw32->top_menu, TAGV(tag, 0), TAGV(tag, 3), TAGV(tag, value), MF_BYCOMMAND);
 		break;
 
+	case ui_tag_frame_rate:
+		ui_sdl_update_frame_rate(&uiw32->ui_sdl2_interface, value);
+		break;
+
 	case ui_tag_tv_dialog:
 	case ui_tag_gain:
 	case ui_tag_brightness:
@@ -44,6 +44,7 @@
 #include "ao.h"
 #include "auto_kbd.h"
 #include "becker.h"
+#include "capture.h"
 #include "cart.h"
 #include "crclist.h"
 #include "dkbd.h"
@@ -78,21 +79,25 @@
 #include "windows32/common_windows32.h"
 #endif
 
+// Configuration directives
+
+static struct xroar_cfg const xroar_cfg_defaults = {
+	.ao.fragments = -1,
+	.tape.pan = 0.5,
+	.tape.hysteresis = 1.0,
+	.tape.rewrite_gap_ms = 500,
+	.tape.rewrite_leader = 256,
+	.disk.write_back = 1,
+	.disk.auto_os9 = 1,
+	.disk.auto_sd = 1,
+	.debug.idle_skip = 1,
+};
+
+struct xroar_cfg xroar_cfg;
+
 // Global emulator state
 
-struct xroar xroar = {
-	// Configuration directives
-	.cfg = {
-		.ao.fragments = -1,
-		.tape.pan = 0.5,
-		.tape.hysteresis = 1.0,
-		.tape.rewrite_gap_ms = 500,
-		.tape.rewrite_leader = 256,
-		.disk.write_back = 1,
-		.disk.auto_os9 = 1,
-		.disk.auto_sd = 1,
-	},
-};
+VAR_ATTR_THREAD_LOCAL struct xroar xroar;
 
 // Private
 
@@ -168,10 +173,13 @@ struct private_cfg {
 	// Video
 	struct {
 		int frameskip;
+		_Bool frameskip_auto;
 		int ccr;
 		_Bool vdg_inverted_text;
 		int picture;
 		_Bool ntsc_scaling;
+		_Bool render_thread;
+		char *capture;
 		int brightness;
 		int contrast;
 		int saturation;
@@ -183,6 +191,7 @@ struct private_cfg {
 	struct {
 		int volume;
 		double gain;
+		char *capture;
 	} ao;
 
 	// Joysticks
@@ -217,7 +226,7 @@ struct private_cfg {
 #endif
 };
 
-static struct private_cfg private_cfg = {
+static struct private_cfg const private_cfg_defaults = {
 	.machine.keymap = ANY_AUTO,
 	.machine.cpu = CPU_MC6809,
 	.machine.tv_type = ANY_AUTO,
@@ -242,7 +251,9 @@ static struct private_cfg private_cfg = {
 	.debug.ratelimit = 1,
 };
 
-static struct ui_cfg xroar_ui_cfg = {
+static struct private_cfg private_cfg;
+
+static struct ui_cfg const xroar_ui_cfg_defaults = {
 	.vo_cfg = {
 		.gl_filter = UI_GL_FILTER_AUTO,
 #if __BYTE_ORDER == __BIG_ENDIAN
@@ -253,6 +264,8 @@ static struct ui_cfg xroar_ui_cfg = {
 	},
 };
 
+static struct ui_cfg xroar_ui_cfg;
+
 enum media_slot {
 	media_slot_none = 0,
 	media_slot_fd0,
@@ -275,6 +288,7 @@ static void set_cart(const char *name);
 static void add_load(const char *arg);
 static void add_run(const char *arg);
 static void set_gain(double gain);
+static void set_frameskip(const char *value);
 static void set_kbd_bind(const char *spec);
 static void set_joystick(const char *name);
 static void set_joystick_axis(const char *spec);
@@ -298,12 +312,28 @@ static struct xconfig_option const xroar_options[];
 
 struct xroar_state {
 	_Bool noratelimit_latch;
+	struct capture *capture;
+	_Bool config_ref;  // instance holds a reference to shared config
 };
 
-static struct xroar_state xroar_state = {
+static VAR_ATTR_THREAD_LOCAL struct xroar_state xroar_state = {
 	.noratelimit_latch = 0,
+	.capture = NULL,
+	.config_ref = 0,
 };
 
+// Configuration (machine, cart and joystick definitions, ROM lists, parsed
+// options) is shared by every instance in the process, and only freed when
+// the last instance shuts down.  Instances are created and destroyed one at a
+// time (see libxroar.h), so this needs no lock.
+
+static unsigned config_nrefs = 0;
+
+// Machine selected by the options, which each instance starts with
+static struct machine_config *config_machine_config = NULL;
+
+static void config_release(void);
+
 static struct cart_config *selected_cart_config;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -710,18 +740,17 @@ static struct {
 # define CONFPATH "."
 #endif
 
-/** Processes options from a builtin list, a configuration file, and the
- * command line.  Determines which modules to use (see ui.h, vo.h, ao.h) and
- * initialises them.  Starts an emulated machine.
- *
- * Attaches any media images requested to the emulated machine and schedules
- * any deferred commands (e.g. autorunning a program, or user-specified "-type"
- * option).
- *
- * Returns the UI interface to the caller (probably main()).
- */
+// Output files named "-" are written to stdout
 
-struct ui_interface *xroar_init(int argc, char **argv) {
+static _Bool is_stdout_filename(const char *filename) {
+	return filename && strcmp(filename, "-") == 0;
+}
+
+// Process options from a builtin list, a configuration file, and the command
+// line.  Only the first instance in a process does this: the result is shared
+// with any others started while it is held (see libxroar.h).
+
+static void config_init(int argc, char **argv) {
 	int argn = 1, ret;
 	char *conffile = NULL;
 	_Bool no_conffile = 0;
@@ -730,6 +759,16 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 	_Bool alloc_console = 0;
 #endif
 
+	// Start from defaults, in case this follows an earlier configuration
+	// that has since been released.
+	private_cfg = private_cfg_defaults;
+	xroar_cfg = xroar_cfg_defaults;
+	xroar_ui_cfg = xroar_ui_cfg_defaults;
+	autorun_media_slot = media_slot_none;
+	load_disk_to_drive = 0;
+	selected_cart_config = NULL;
+	cur_joy_config = NULL;
+
 	// Parse early options.  These affect how the rest of the config is
 	// processed.  Also, for Windows, the -C option allocates a console so
 	// that debug information can be seen, which we want to happen early.
@@ -781,7 +820,7 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 
 	if (!no_builtin) {
 		// Set a default ROM search path if required.
-		xroar.cfg.file.rompath = xstrdup(ROMPATH);
+		xroar_cfg.file.rompath = xstrdup(ROMPATH);
 		// Process builtin directives
 		for (unsigned i = 0; i < ARRAY_N_ELEMENTS(default_config); i++) {
 			xconfig_parse_line(xroar_options, default_config[i]);
@@ -897,33 +936,6 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-	// Always create a vdrive interface (XXX but why here?)
-	xroar.vdrive_interface = vdrive_interface_new();
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-	// Select a UI module.
-	struct ui_module *ui_module = (struct ui_module *)module_select_by_arg((struct module * const *)ui_module_list, private_cfg.ui_module);
-	if (ui_module == NULL) {
-		if (ui_module_list) {
-			ui_module = ui_module_list[0];
-		}
-		if (ui_module) {
-			LOG_WARN("UI module `%s' not found: trying '%s'\n", private_cfg.ui_module, ui_module->common.name);
-		} else {
-			LOG_ERROR("UI module `%s' not found\n", private_cfg.ui_module);
-			exit(EXIT_FAILURE);
-		}
-	}
-	// Override other module lists if UI has an entry.
-	if (ui_module->ao_module_list != NULL)
-		ao_module_list = ui_module->ao_module_list;
-	// Select audio module
-	struct module *ao_module = module_select_by_arg((struct module * const *)ao_module_list, private_cfg.ao_module);
-	ui_joystick_module_list = ui_module->joystick_module_list;
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
 	// Sanitise other command-line options.
 
 	if (private_cfg.vo.frameskip < 0)
@@ -932,11 +944,19 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 	private_cfg.tape.pad_auto = private_cfg.tape.pad_auto ? TAPE_PAD_AUTO : 0;
 	private_cfg.tape.fast = private_cfg.tape.fast ? TAPE_FAST : 0;
 	private_cfg.tape.rewrite = private_cfg.tape.rewrite ? TAPE_REWRITE : 0;
-	if (xroar.cfg.tape.rewrite_gap_ms <= 0 || xroar.cfg.tape.rewrite_gap_ms > 5000) {
-		xroar.cfg.tape.rewrite_gap_ms = 500;
+	if (xroar_cfg.tape.rewrite_gap_ms <= 0 || xroar_cfg.tape.rewrite_gap_ms > 5000) {
+		xroar_cfg.tape.rewrite_gap_ms = 500;
 	}
-	if (xroar.cfg.tape.rewrite_leader <= 0 || xroar.cfg.tape.rewrite_leader > 2048) {
-		xroar.cfg.tape.rewrite_leader = 256;
+	if (xroar_cfg.tape.rewrite_leader <= 0 || xroar_cfg.tape.rewrite_leader > 2048) {
+		xroar_cfg.tape.rewrite_leader = 256;
+	}
+
+	// Binary output to stdout mustn't be mixed with log messages, so if
+	// any output is "-", reserve stdout now, before anything is logged.
+	if (is_stdout_filename(private_cfg.vo.capture) ||
+	    is_stdout_filename(private_cfg.ao.capture) ||
+	    is_stdout_filename(xroar_cfg.ao.device)) {
+		fs_reserve_stdout();
 	}
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -985,6 +1005,62 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 		xroar.machine_config->default_cart = xstrdup(selected_cart_config->name);
 	}
 
+	// Record the machine selected, for other instances
+	config_machine_config = xroar.machine_config;
+}
+
+/** Processes options from a builtin list, a configuration file, and the
+ * command line.  Determines which modules to use (see ui.h, vo.h, ao.h) and
+ * initialises them.  Starts an emulated machine.
+ *
+ * Attaches any media images requested to the emulated machine and schedules
+ * any deferred commands (e.g. autorunning a program, or user-specified "-type"
+ * option).
+ *
+ * Returns the UI interface to the caller (probably main()).
+ */
+
+struct ui_interface *xroar_init(int argc, char **argv) {
+	// Configuration is shared by every instance in the process, so can
+	// only be given by the first.
+	if (config_nrefs > 0 && !xroar_state.config_ref && argc > 1) {
+		LOG_ERROR("Configuration already in use by another instance: options not accepted\n");
+		return NULL;
+	}
+	if (!xroar_state.config_ref) {
+		xroar_state.config_ref = 1;
+		if (config_nrefs++ == 0) {
+			config_init(argc, argv);
+		} else {
+			xroar.machine_config = config_machine_config;
+		}
+	}
+
+	// Always create a vdrive interface (XXX but why here?)
+	xroar.vdrive_interface = vdrive_interface_new();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	// Select a UI module.
+	struct ui_module *ui_module = (struct ui_module *)module_select_by_arg((struct module * const *)ui_module_list, private_cfg.ui_module);
+	if (ui_module == NULL) {
+		if (ui_module_list) {
+			ui_module = ui_module_list[0];
+		}
+		if (ui_module) {
+			LOG_WARN("UI module `%s' not found: trying '%s'\n", private_cfg.ui_module, ui_module->common.name);
+		} else {
+			LOG_ERROR("UI module `%s' not found\n", private_cfg.ui_module);
+			exit(EXIT_FAILURE);
+		}
+	}
+	// Override other module lists if UI has an entry.
+	if (ui_module->ao_module_list != NULL)
+		ao_module_list = ui_module->ao_module_list;
+	// Select audio module
+	struct module *ao_module = ao_module_select_by_arg((struct module * const *)ao_module_list, private_cfg.ao_module);
+	ui_joystick_module_list = ui_module->joystick_module_list;
+
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 	// Initialise everything
@@ -1062,15 +1138,23 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 
 	// Notify UI of starting options:
 	DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_fullscreen, xroar_ui_cfg.vo_cfg.fullscreen, NULL);
-	DELEGATE_SAFE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_layout, xroar.cfg.kbd.layout, NULL);
-	DELEGATE_SAFE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_lang, xroar.cfg.kbd.lang, NULL);
-	xroar_set_kbd_translate(1, xroar.cfg.kbd.translate);
+	DELEGATE_SAFE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_layout, xroar_cfg.kbd.layout, NULL);
+	DELEGATE_SAFE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_lang, xroar_cfg.kbd.lang, NULL);
+	xroar_set_kbd_translate(1, xroar_cfg.kbd.translate);
 
 	xroar.tape_interface = tape_interface_new(xroar.ui_interface);
 	if (private_cfg.tape.ao_rate > 0)
 		tape_set_ao_rate(xroar.tape_interface, private_cfg.tape.ao_rate);
 
 	vo_set_ntsc_scaling(xroar.vo_interface, 1, private_cfg.vo.ntsc_scaling);
+	vo_set_render_thread(xroar.vo_interface, private_cfg.vo.render_thread);
+	if (private_cfg.vo.capture || private_cfg.ao.capture) {
+		xroar_state.capture = capture_new(private_cfg.vo.capture, private_cfg.ao.capture);
+		if (xroar_state.capture) {
+			vo_set_capture(xroar.vo_interface, xroar_state.capture);
+			sound_set_capture(xroar.ao_interface->sound_interface, xroar_state.capture);
+		}
+	}
 	DELEGATE_SAFE_CALL(xroar.vo_interface->set_brightness, private_cfg.vo.brightness);
 	DELEGATE_SAFE_CALL(xroar.vo_interface->set_contrast, private_cfg.vo.contrast);
 	DELEGATE_SAFE_CALL(xroar.vo_interface->set_saturation, private_cfg.vo.saturation);
@@ -1157,12 +1241,10 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 		(void)xroar_set_timeout(private_cfg.debug.timeout);
 	}
 
-	// Type strings into machine
-	while (private_cfg.kbd.type_list) {
-		sds data = private_cfg.kbd.type_list->data;
-		ak_type_sds(xroar.auto_kbd, data);
-		private_cfg.kbd.type_list = slist_remove(private_cfg.kbd.type_list, data);
-		sdsfree(data);
+	// Type strings into machine.  The list is left in place, as it's
+	// part of the shared configuration.
+	for (struct slist *iter = private_cfg.kbd.type_list; iter; iter = iter->next) {
+		ak_type_sds(xroar.auto_kbd, iter->data);
 	}
 
 #ifdef HAVE_WASM
@@ -1175,11 +1257,12 @@ struct ui_interface *xroar_init(int argc, char **argv) {
 
 /** Generally set as an atexit() handler by main(), this function flushes any
  * output, shuts down the emulated machine and frees any other allocated
- * resources.
+ * resources.  Shared configuration is only freed when the last instance in
+ * the process shuts down.
  */
 
 void xroar_shutdown(void) {
-	static _Bool shutting_down = 0;
+	static VAR_ATTR_THREAD_LOCAL _Bool shutting_down = 0;
 	if (shutting_down)
 		return;
 	shutting_down = 1;
@@ -1192,15 +1275,47 @@ void xroar_shutdown(void) {
 		xroar.machine = NULL;
 	}
 	joystick_shutdown();
-	cart_config_remove_all();
-	machine_config_remove_all();
 	xroar.machine_config = NULL;
+	if (xroar_state.capture) {
+		vo_set_capture(xroar.vo_interface, NULL);
+		sound_set_capture(xroar.ao_interface->sound_interface, NULL);
+		capture_free(xroar_state.capture);
+		xroar_state.capture = NULL;
+	}
 	if (xroar.ao_interface) {
 		DELEGATE_SAFE_CALL(xroar.ao_interface->free);
+		xroar.ao_interface = NULL;
 	}
 	if (xroar.vo_interface) {
 		DELEGATE_SAFE_CALL(xroar.vo_interface->free);
+		xroar.vo_interface = NULL;
 	}
+	vdrive_interface_free(xroar.vdrive_interface);
+	xroar.vdrive_interface = NULL;
+	tape_interface_free(xroar.tape_interface);
+	xroar.tape_interface = NULL;
+	if (xroar.ui_interface) {
+		DELEGATE_SAFE_CALL(xroar.ui_interface->free);
+		xroar.ui_interface = NULL;
+	}
+	event_list_clear(&UI_EVENT_LIST);
+	event_list_clear(&MACHINE_EVENT_LIST);
+	event_pool_free();
+	if (xroar_state.config_ref) {
+		xroar_state.config_ref = 0;
+		if (--config_nrefs == 0) {
+			config_release();
+		}
+	}
+	shutting_down = 0;
+}
+
+// Free configuration shared between instances.
+
+static void config_release(void) {
+	joystick_config_remove_all();
+	cart_config_remove_all();
+	machine_config_remove_all();
 	romlist_shutdown();
 	crclist_shutdown();
 	for (unsigned i = 0; i < JOYSTICK_NUM_AXES; i++) {
@@ -1211,13 +1326,19 @@ void xroar_shutdown(void) {
 		if (private_cfg.joy.button[i])
 			free(private_cfg.joy.button[i]);
 	}
-	vdrive_interface_free(xroar.vdrive_interface);
-	tape_interface_free(xroar.tape_interface);
+	slist_free_full(private_cfg.file.binaries, (slist_free_func)free);
+	private_cfg.file.binaries = NULL;
+	if (private_cfg.file.snapshot) {
+		free(private_cfg.file.snapshot);
+		private_cfg.file.snapshot = NULL;
+	}
+	if (private_cfg.default_machine) {
+		free(private_cfg.default_machine);
+		private_cfg.default_machine = NULL;
+	}
+	config_machine_config = NULL;
 	hk_shutdown();
 	xconfig_shutdown(xroar_options);
-	if (xroar.ui_interface) {
-		DELEGATE_SAFE_CALL(xroar.ui_interface->free);
-	}
 #ifdef WINDOWS32
 	windows32_shutdown();
 #endif
@@ -1335,8 +1456,6 @@ static void do_load_binaries(void *sptr) {
 		_Bool autorun = (autorun_media_slot == media_slot_binary) && !iter->next;
 		xroar_load_file_by_type(filename, autorun);
 	}
-	slist_free_full(private_cfg.file.binaries, (slist_free_func)free);
-	private_cfg.file.binaries = NULL;
 }
 
 void xroar_load_disk(const char *filename, int drive, _Bool autorun) {
@@ -1535,10 +1654,10 @@ void xroar_insert_hd_file(int drive, const char *filename) {
 		return;
 	if (drive < 0 || drive > 1)
 		return;
-	if (xroar.cfg.file.hd[drive])
-		free(xroar.cfg.file.hd[drive]);
-	fprintf(stderr, "xroar.cfg.file.hd[%d] = '%s'\n", drive, filename);
-	xroar.cfg.file.hd[drive] = xstrdup(filename);
+	if (xroar_cfg.file.hd[drive])
+		free(xroar_cfg.file.hd[drive]);
+	fprintf(stderr, "xroar_cfg.file.hd[%d] = '%s'\n", drive, filename);
+	xroar_cfg.file.hd[drive] = xstrdup(filename);
 }
 
 void xroar_set_ccr(_Bool notify, int action) {
@@ -1642,21 +1761,21 @@ void xroar_set_picture(_Bool notify, int action) {
 }
 
 void xroar_set_ratelimit(int action) {
-	if (!xroar.machine->set_frameskip || !xroar.machine->set_ratelimit)
+	if (!xroar.machine->set_ratelimit)
 		return;
 	if (xroar_state.noratelimit_latch)
 		return;
 	if (action) {
-		xroar.machine->set_frameskip(xroar.machine, private_cfg.vo.frameskip);
+		vo_set_frameskip(xroar.vo_interface, private_cfg.vo.frameskip, private_cfg.vo.frameskip_auto);
 		xroar.machine->set_ratelimit(xroar.machine, 1);
 	} else {
-		xroar.machine->set_frameskip(xroar.machine, 10);
+		vo_set_frameskip(xroar.vo_interface, 10, 0);
 		xroar.machine->set_ratelimit(xroar.machine, 0);
 	}
 }
 
 void xroar_set_ratelimit_latch(_Bool notify, int action) {
-	if (!xroar.machine->set_frameskip || !xroar.machine->set_ratelimit)
+	if (!xroar.machine->set_ratelimit)
 		return;
 	_Bool state = !xroar_state.noratelimit_latch;
 	switch (action) {
@@ -1673,10 +1792,10 @@ void xroar_set_ratelimit_latch(_Bool notify, int action) {
 	}
 	xroar_state.noratelimit_latch = !state;
 	if (state) {
-		xroar.machine->set_frameskip(xroar.machine, private_cfg.vo.frameskip);
+		vo_set_frameskip(xroar.vo_interface, private_cfg.vo.frameskip, private_cfg.vo.frameskip_auto);
 		xroar.machine->set_ratelimit(xroar.machine, 1);
 	} else {
-		xroar.machine->set_frameskip(xroar.machine, 10);
+		vo_set_frameskip(xroar.vo_interface, 10, 0);
 		xroar.machine->set_ratelimit(xroar.machine, 0);
 	}
 	if (notify) {
@@ -1793,7 +1912,7 @@ void xroar_set_keyboard_type(_Bool notify, int action) {
 }
 
 void xroar_set_hkbd_layout(_Bool notify, int hk_layout) {
-	xroar.cfg.kbd.layout = hk_layout;
+	xroar_cfg.kbd.layout = hk_layout;
 	hk_update_keymap();
 	if (notify && xroar.ui_interface) {
 		DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_layout, hk_layout, NULL);
@@ -1801,7 +1920,7 @@ void xroar_set_hkbd_layout(_Bool notify, int hk_layout) {
 }
 
 void xroar_set_hkbd_lang(_Bool notify, int hk_lang) {
-	xroar.cfg.kbd.lang = hk_lang;
+	xroar_cfg.kbd.lang = hk_lang;
 	hk_update_keymap();
 	if (notify && xroar.ui_interface) {
 		DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_hkbd_lang, hk_lang, NULL);
@@ -1811,14 +1930,14 @@ void xroar_set_hkbd_lang(_Bool notify, int hk_lang) {
 void xroar_set_kbd_translate(_Bool notify, int kbd_translate) {
 	switch (kbd_translate) {
 		case XROAR_NEXT:
-			xroar.cfg.kbd.translate = !xroar.cfg.kbd.translate;
+			xroar_cfg.kbd.translate = !xroar_cfg.kbd.translate;
 			break;
 		default:
-			xroar.cfg.kbd.translate = kbd_translate;
+			xroar_cfg.kbd.translate = kbd_translate;
 			break;
 	}
 	if (notify) {
-		DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_kbd_translate, xroar.cfg.kbd.translate, NULL);
+		DELEGATE_CALL(xroar.ui_interface->update_state, ui_tag_kbd_translate, xroar_cfg.kbd.translate, NULL);
 	}
 }
 
@@ -2153,6 +2272,8 @@ void xroar_screenshot(void) {
 /* Helper functions used by configuration */
 
 static void set_default_machine(const char *name) {
+	if (private_cfg.default_machine)
+		free(private_cfg.default_machine);
 	private_cfg.default_machine = xstrdup(name);
 	// If no machine specified on command line, get default.
 	if (!xroar.machine_config && private_cfg.default_machine) {
@@ -2449,8 +2570,8 @@ static enum media_slot add_load_file(const char *filename) {
 	case FILETYPE_IMG:
 		// TODO: recognise media type and select cartridge accordingly
 		for (int i = 0; i < 2; i++) {
-			if (!xroar.cfg.file.hd[i]) {
-				xroar.cfg.file.hd[i] = xstrdup(filename);
+			if (!xroar_cfg.file.hd[i]) {
+				xroar_cfg.file.hd[i] = xstrdup(filename);
 				break;
 			}
 			if (i == 1) {
@@ -2495,6 +2616,16 @@ static void set_gain(double gain) {
 	private_cfg.ao.volume = -1;
 }
 
+static void set_frameskip(const char *value) {
+	if (value && 0 == c_strcasecmp(value, "auto")) {
+		private_cfg.vo.frameskip = 0;
+		private_cfg.vo.frameskip_auto = 1;
+		return;
+	}
+	private_cfg.vo.frameskip = value ? strtol(value, NULL, 0) : 0;
+	private_cfg.vo.frameskip_auto = 0;
+}
+
 static void cfg_mpi_load_cart(const char *arg) {
 	(void)arg;
 #ifdef WANT_CART_ARCH_DRAGON
@@ -2543,7 +2674,7 @@ static void set_kbd_bind(const char *spec) {
 			bind->hostkey = xstrdup(hkey);
 			bind->dk_key = dk_key;
 			bind->preempt = preempt;
-			xroar.cfg.kbd.bind_list = slist_append(xroar.cfg.kbd.bind_list, bind);
+			xroar_cfg.kbd.bind_list = slist_append(xroar_cfg.kbd.bind_list, bind);
 		}
 	}
 	free(spec_copy);
@@ -2709,9 +2840,9 @@ static struct xconfig_option const xroar_options[] = {
 	{ XC_CALL_STRING("mpi-load-cart", &cfg_mpi_load_cart) },
 
 	/* Becker port: */
-	{ XC_SET_BOOL("becker", &xroar.cfg.becker.prefer) },
-	{ XC_SET_STRING("becker-ip", &xroar.cfg.becker.ip) },
-	{ XC_SET_STRING("becker-port", &xroar.cfg.becker.port) },
+	{ XC_SET_BOOL("becker", &xroar_cfg.becker.prefer) },
+	{ XC_SET_STRING("becker-ip", &xroar_cfg.becker.ip) },
+	{ XC_SET_STRING("becker-port", &xroar_cfg.becker.port) },
 
 	/* Files: */
 	{ XC_CALL_STRING_NE("load", &add_load) },
@@ -2720,37 +2851,37 @@ static struct xconfig_option const xroar_options[] = {
 	{ XC_SET_STRING_NE("load-fd1", &private_cfg.file.fd[1]) },
 	{ XC_SET_STRING_NE("load-fd2", &private_cfg.file.fd[2]) },
 	{ XC_SET_STRING_NE("load-fd3", &private_cfg.file.fd[3]) },
-	{ XC_SET_STRING_NE("load-hd0", &xroar.cfg.file.hd[0]) },
-	{ XC_SET_STRING_NE("load-hd1", &xroar.cfg.file.hd[1]) },
+	{ XC_SET_STRING_NE("load-hd0", &xroar_cfg.file.hd[0]) },
+	{ XC_SET_STRING_NE("load-hd1", &xroar_cfg.file.hd[1]) },
 	{ XC_ALIAS_UARG("load-sd", "load-hd0"), .deprecated = 1 },
 	{ XC_SET_STRING_NE("load-tape", &private_cfg.file.tape) },
 	{ XC_SET_STRING_NE("load-text", &private_cfg.file.text) },
 
 	/* Cassettes: */
 	{ XC_SET_STRING_NE("tape-write", &private_cfg.file.tape_write) },
-	{ XC_SET_DOUBLE("tape-pan", &xroar.cfg.tape.pan) },
-	{ XC_SET_DOUBLE("tape-hysteresis", &xroar.cfg.tape.hysteresis) },
+	{ XC_SET_DOUBLE("tape-pan", &xroar_cfg.tape.pan) },
+	{ XC_SET_DOUBLE("tape-hysteresis", &xroar_cfg.tape.hysteresis) },
 	{ XC_SET_INT1("tape-fast", &private_cfg.tape.fast) },
 	{ XC_SET_INT1("tape-pad-auto", &private_cfg.tape.pad_auto) },
 	{ XC_SET_INT1("tape-rewrite", &private_cfg.tape.rewrite) },
-	{ XC_SET_INT("tape-rewrite-gap-ms", &xroar.cfg.tape.rewrite_gap_ms) },
-	{ XC_SET_INT("tape-rewrite-leader", &xroar.cfg.tape.rewrite_leader) },
+	{ XC_SET_INT("tape-rewrite-gap-ms", &xroar_cfg.tape.rewrite_gap_ms) },
+	{ XC_SET_INT("tape-rewrite-leader", &xroar_cfg.tape.rewrite_leader) },
 	{ XC_SET_INT("tape-ao-rate", &private_cfg.tape.ao_rate) },
 	/* Backwards-compatibility: */
 	{ XC_SET_INT1("tape-pad", &dummy_value.v_int), .deprecated = 1 },
 
 	/* Floppy disks: */
-	{ XC_SET_BOOL("disk-write-back", &xroar.cfg.disk.write_back) },
-	{ XC_SET_BOOL("disk-auto-os9", &xroar.cfg.disk.auto_os9) },
-	{ XC_SET_BOOL("disk-auto-sd", &xroar.cfg.disk.auto_sd) },
+	{ XC_SET_BOOL("disk-write-back", &xroar_cfg.disk.write_back) },
+	{ XC_SET_BOOL("disk-auto-os9", &xroar_cfg.disk.auto_os9) },
+	{ XC_SET_BOOL("disk-auto-sd", &xroar_cfg.disk.auto_sd) },
 
 	/* Firmware ROM images: */
-	{ XC_SET_STRING_NE("rompath", &xroar.cfg.file.rompath) },
+	{ XC_SET_STRING_NE("rompath", &xroar_cfg.file.rompath) },
 	{ XC_CALL_ASSIGN_NE("romlist", &romlist_assign) },
 	{ XC_CALL_NONE("romlist-print", &romlist_print) },
 	{ XC_CALL_ASSIGN("crclist", &crclist_assign) },
 	{ XC_CALL_NONE("crclist-print", &crclist_print) },
-	{ XC_SET_BOOL("force-crc-match", &xroar.cfg.force_crc_match) },
+	{ XC_SET_BOOL("force-crc-match", &xroar_cfg.force_crc_match) },
 
 	/* User interface: */
 	{ XC_SET_STRING("ui", &private_cfg.ui_module) },
@@ -2759,7 +2890,7 @@ static struct xconfig_option const xroar_options[] = {
 
 	/* Video: */
 	{ XC_SET_BOOL("fs", &xroar_ui_cfg.vo_cfg.fullscreen) },
-	{ XC_SET_INT("fskip", &private_cfg.vo.frameskip) },
+	{ XC_CALL_STRING("fskip", &set_frameskip) },
 	{ XC_SET_ENUM("ccr", &private_cfg.vo.ccr, vo_cmp_ccr_list) },
 	{ XC_SET_ENUM("gl-filter", &xroar_ui_cfg.vo_cfg.gl_filter, ui_gl_filter_list) },
 	{ XC_SET_ENUM("vo-pixel-fmt", &xroar_ui_cfg.vo_cfg.pixel_fmt, vo_pixel_fmt_list) },
@@ -2767,39 +2898,44 @@ static struct xconfig_option const xroar_options[] = {
 	{ XC_SET_STRING("g", &xroar_ui_cfg.vo_cfg.geometry) },
 	{ XC_SET_ENUM("vo-picture", &private_cfg.vo.picture, vo_viewport_list) },
 	{ XC_SET_BOOL("vo-scale-60hz", &private_cfg.vo.ntsc_scaling) },
+	{ XC_SET_BOOL("vo-render-thread", &private_cfg.vo.render_thread) },
 	{ XC_SET_BOOL("invert-text", &private_cfg.vo.vdg_inverted_text) },
 	{ XC_SET_INT("vo-brightness", &private_cfg.vo.brightness) },
 	{ XC_SET_INT("vo-contrast", &private_cfg.vo.contrast) },
 	{ XC_SET_INT("vo-colour", &private_cfg.vo.saturation) },
 	{ XC_SET_INT("vo-hue", &private_cfg.vo.hue) },
 	{ XC_SET_BOOL("vo-colour-killer", &xroar_ui_cfg.vo_cfg.colour_killer) },
+	{ XC_SET_INT("vo-hash-interval", &xroar_ui_cfg.vo_cfg.hash_interval) },
+	{ XC_SET_STRING("vo-hash-golden", &xroar_ui_cfg.vo_cfg.hash_golden) },
+	{ XC_SET_STRING("vo-capture", &private_cfg.vo.capture) },
 	/* Deliberately undocumented: */
 	{ XC_SET_STRING("vo", &xroar_ui_cfg.vo) },
 
 	/* Audio: */
 	{ XC_SET_STRING("ao", &private_cfg.ao_module) },
-	{ XC_SET_STRING("ao-device", &xroar.cfg.ao.device) },
-	{ XC_SET_ENUM("ao-format", &xroar.cfg.ao.format, ao_format_list) },
-	{ XC_SET_INT("ao-rate", &xroar.cfg.ao.rate) },
-	{ XC_SET_INT("ao-channels", &xroar.cfg.ao.channels) },
-	{ XC_SET_INT("ao-fragments", &xroar.cfg.ao.fragments) },
-	{ XC_SET_INT("ao-fragment-ms", &xroar.cfg.ao.fragment_ms) },
-	{ XC_SET_INT("ao-fragment-frames", &xroar.cfg.ao.fragment_nframes) },
-	{ XC_SET_INT("ao-buffer-ms", &xroar.cfg.ao.buffer_ms) },
-	{ XC_SET_INT("ao-buffer-frames", &xroar.cfg.ao.buffer_nframes) },
+	{ XC_SET_STRING("ao-device", &xroar_cfg.ao.device) },
+	{ XC_SET_ENUM("ao-format", &xroar_cfg.ao.format, ao_format_list) },
+	{ XC_SET_INT("ao-rate", &xroar_cfg.ao.rate) },
+	{ XC_SET_INT("ao-channels", &xroar_cfg.ao.channels) },
+	{ XC_SET_INT("ao-fragments", &xroar_cfg.ao.fragments) },
+	{ XC_SET_INT("ao-fragment-ms", &xroar_cfg.ao.fragment_ms) },
+	{ XC_SET_INT("ao-fragment-frames", &xroar_cfg.ao.fragment_nframes) },
+	{ XC_SET_INT("ao-buffer-ms", &xroar_cfg.ao.buffer_ms) },
+	{ XC_SET_INT("ao-buffer-frames", &xroar_cfg.ao.buffer_nframes) },
 	{ XC_CALL_DOUBLE("ao-gain", &set_gain) },
 	{ XC_SET_INT("ao-volume", &private_cfg.ao.volume) },
+	{ XC_SET_STRING("ao-capture", &private_cfg.ao.capture) },
 	/* Deliberately undocumented: */
 	{ XC_SET_INT("volume", &private_cfg.ao.volume) },
 	/* Backwards-compatibility: */
-	{ XC_SET_INT("ao-buffer-samples", &xroar.cfg.ao.buffer_nframes), .deprecated = 1 },
+	{ XC_SET_INT("ao-buffer-samples", &xroar_cfg.ao.buffer_nframes), .deprecated = 1 },
 	{ XC_SET_BOOL("fast-sound", &dummy_value.v_bool), .deprecated = 1 },
 
 	/* Keyboard: */
-	{ XC_SET_ENUM("kbd-layout", &xroar.cfg.kbd.layout, hkbd_layout_list) },
-	{ XC_SET_ENUM("kbd-lang", &xroar.cfg.kbd.lang, hkbd_lang_list) },
-	{ XC_SET_ENUM("keymap", &xroar.cfg.kbd.lang, hkbd_lang_list), .deprecated = 1 },
-	{ XC_SET_BOOL("kbd-translate", &xroar.cfg.kbd.translate) },
+	{ XC_SET_ENUM("kbd-layout", &xroar_cfg.kbd.layout, hkbd_layout_list) },
+	{ XC_SET_ENUM("kbd-lang", &xroar_cfg.kbd.lang, hkbd_lang_list) },
+	{ XC_SET_ENUM("keymap", &xroar_cfg.kbd.lang, hkbd_lang_list), .deprecated = 1 },
+	{ XC_SET_BOOL("kbd-translate", &xroar_cfg.kbd.translate) },
 	{ XC_CALL_STRING("kbd-bind", &set_kbd_bind) },
 
 	/* Joysticks: */
@@ -2817,9 +2953,10 @@ static struct xconfig_option const xroar_options[] = {
 
 	/* Emulator actions: */
 	{ XC_SET_BOOL("ratelimit", &private_cfg.debug.ratelimit) },
-	{ XC_SET_STRING("snap-motoroff", &xroar.cfg.debug.snap_motoroff) },
+	{ XC_SET_BOOL("idle-skip", &xroar_cfg.debug.idle_skip) },
+	{ XC_SET_STRING("snap-motoroff", &xroar_cfg.debug.snap_motoroff) },
 	{ XC_SET_STRING("timeout", &private_cfg.debug.timeout) },
-	{ XC_SET_STRING("timeout-motoroff", &xroar.cfg.debug.timeout_motoroff) },
+	{ XC_SET_STRING("timeout-motoroff", &xroar_cfg.debug.timeout_motoroff) },
 	{ XC_SET_STRING_LIST("type", &private_cfg.kbd.type_list) },
 
 	/* Debugging: */
@@ -2827,9 +2964,9 @@ static struct xconfig_option const xroar_options[] = {
 	{ XC_SET_INT("debug-file", &logging.debug_file) },
 	{ XC_SET_INT("debug-gdb", &logging.debug_gdb) },
 	{ XC_SET_INT("debug-ui", &logging.debug_ui) },
-	{ XC_SET_BOOL("gdb", &xroar.cfg.debug.gdb) },
-	{ XC_SET_STRING("gdb-ip", &xroar.cfg.debug.gdb_ip) },
-	{ XC_SET_STRING("gdb-port", &xroar.cfg.debug.gdb_port) },
+	{ XC_SET_BOOL("gdb", &xroar_cfg.debug.gdb) },
+	{ XC_SET_STRING("gdb-ip", &xroar_cfg.debug.gdb_ip) },
+	{ XC_SET_STRING("gdb-port", &xroar_cfg.debug.gdb_port) },
 	{ XC_SET_BOOL("trace", &logging.trace_cpu) },
 	{ XC_SET_BOOL("trace-timing", &logging.trace_cpu_timing) },
 
@@ -2980,19 +3117,23 @@ static void helptext(void) {
 
 "\n Video:\n"
 "  -fs                   start emulator full-screen if possible\n"
-"  -fskip FRAMES         frameskip (default: 0)\n"
+"  -fskip FRAMES         frameskip, or \"auto\" (default: 0)\n"
 "  -ccr RENDERER         cross-colour renderer (-ccr help for list)\n"
 "  -gl-filter FILTER     OpenGL texture filter (-gl-filter help for list)\n"
 "  -vo-pixel-fmt FMT     pixel format (-vo-pixel-fmt help for list)\n"
 "  -geometry WxH+X+Y     initial emulator geometry\n"
 "  -vo-picture P         initial picture area (-vo-picture help for list)\n"
 "  -no-vo-scale-60hz     disable vertical scaling for 60Hz video\n"
+"  -vo-render-thread     render video in a separate thread\n"
 "  -invert-text          start with text mode inverted\n"
 "  -vo-brightness N      set TV brightness (0-100) [50]\n"
 "  -vo-contrast N        set TV contrast (0-100) [50]\n"
 "  -vo-colour N          set TV colour saturation (0-100) [50]\n"
 "  -vo-hue N             set TV hue control (-179 to +180) [0]\n"
 "  -vo-colour-killer     enable colour killer (disabled by default)\n"
+"  -vo-hash-interval N   with -vo hash, hash every Nth frame [1]\n"
+"  -vo-hash-golden FILE  with -vo hash, compare hashes against FILE\n"
+"  -vo-capture FILE      write every frame to FILE (YUV4MPEG2)\n"
 
 "\n Audio:\n"
 "  -ao MODULE            audio module (-ao help for list)\n"
@@ -3007,6 +3148,7 @@ static void helptext(void) {
 "  -ao-buffer-frames N   set total audio buffer size in samples (if supported)\n"
 "  -ao-gain DB           audio gain in dB relative to 0 dBFS [-3.0]\n"
 "  -ao-volume VOLUME     older way to specify audio volume, linear (0-100)\n"
+"  -ao-capture FILE      write mixed audio to FILE (WAV)\n"
 
 "\n Debugging:\n"
 #ifdef WANT_GDB_TARGET
@@ -3015,6 +3157,7 @@ static void helptext(void) {
 "  -gdb-port PORT        port for GDB target to listen on [" GDB_PORT_DEFAULT "]\n"
 #endif
 "  -no-ratelimit         run cpu as fast as possible\n"
+"  -no-idle-skip         don't skip ahead while cpu waits for interrupt\n"
 #ifdef TRACE
 "  -trace                start with trace mode on\n"
 "  -trace-timing         print timings in trace mode\n"
@@ -3093,9 +3236,9 @@ static void config_print_all(FILE *f, _Bool all) {
 	fputs("# Cartridges\n\n", f);
 	cart_config_print_all(f, all);
 	fputs("# Becker port\n", f);
-	xroar_cfg_print_bool(f, all, "becker", xroar.cfg.becker.prefer, 0);
-	xroar_cfg_print_string(f, all, "becker-ip", xroar.cfg.becker.ip, BECKER_IP_DEFAULT);
-	xroar_cfg_print_string(f, all, "becker-port", xroar.cfg.becker.port, BECKER_PORT_DEFAULT);
+	xroar_cfg_print_bool(f, all, "becker", xroar_cfg.becker.prefer, 0);
+	xroar_cfg_print_string(f, all, "becker-ip", xroar_cfg.becker.ip, BECKER_IP_DEFAULT);
+	xroar_cfg_print_string(f, all, "becker-port", xroar_cfg.becker.port, BECKER_PORT_DEFAULT);
 	fputs("\n", f);
 
 	fputs("# Files\n", f);
@@ -3103,16 +3246,16 @@ static void config_print_all(FILE *f, _Bool all) {
 	xroar_cfg_print_string(f, all, "load-fd1", private_cfg.file.fd[1], NULL);
 	xroar_cfg_print_string(f, all, "load-fd2", private_cfg.file.fd[2], NULL);
 	xroar_cfg_print_string(f, all, "load-fd3", private_cfg.file.fd[3], NULL);
-	xroar_cfg_print_string(f, all, "load-hd0", xroar.cfg.file.hd[0], NULL);
-	xroar_cfg_print_string(f, all, "load-hd1", xroar.cfg.file.hd[1], NULL);
+	xroar_cfg_print_string(f, all, "load-hd0", xroar_cfg.file.hd[0], NULL);
+	xroar_cfg_print_string(f, all, "load-hd1", xroar_cfg.file.hd[1], NULL);
 	xroar_cfg_print_string(f, all, "load-tape", private_cfg.file.tape, NULL);
 	xroar_cfg_print_string(f, all, "tape-write", private_cfg.file.tape_write, NULL);
 	xroar_cfg_print_string(f, all, "load-text", private_cfg.file.text, NULL);
 	fputs("\n", f);
 
 	fputs("# Cassettes\n", f);
-	xroar_cfg_print_double(f, all, "tape-pan", xroar.cfg.tape.pan, 0.5);
-	xroar_cfg_print_double(f, all, "tape-hysteresis", xroar.cfg.tape.hysteresis, 1.0);
+	xroar_cfg_print_double(f, all, "tape-pan", xroar_cfg.tape.pan, 0.5);
+	xroar_cfg_print_double(f, all, "tape-hysteresis", xroar_cfg.tape.hysteresis, 1.0);
 
 	xroar_cfg_print_bool(f, all, "tape-fast", private_cfg.tape.fast, 1);
 	xroar_cfg_print_bool(f, all, "tape-pad-auto", private_cfg.tape.pad_auto, 1);
@@ -3121,16 +3264,16 @@ static void config_print_all(FILE *f, _Bool all) {
 	fputs("\n", f);
 
 	fputs("# Disks\n", f);
-	xroar_cfg_print_bool(f, all, "disk-write-back", xroar.cfg.disk.write_back, 1);
-	xroar_cfg_print_bool(f, all, "disk-auto-os9", xroar.cfg.disk.auto_os9, 1);
-	xroar_cfg_print_bool(f, all, "disk-auto-sd", xroar.cfg.disk.auto_sd, 1);
+	xroar_cfg_print_bool(f, all, "disk-write-back", xroar_cfg.disk.write_back, 1);
+	xroar_cfg_print_bool(f, all, "disk-auto-os9", xroar_cfg.disk.auto_os9, 1);
+	xroar_cfg_print_bool(f, all, "disk-auto-sd", xroar_cfg.disk.auto_sd, 1);
 	fputs("\n", f);
 
 	fputs("# Firmware ROM images\n", f);
-	xroar_cfg_print_string(f, all, "rompath", xroar.cfg.file.rompath, NULL);
+	xroar_cfg_print_string(f, all, "rompath", xroar_cfg.file.rompath, NULL);
 	romlist_print_all(f);
 	crclist_print_all(f);
-	xroar_cfg_print_bool(f, all, "force-crc-match", xroar.cfg.force_crc_match, 0);
+	xroar_cfg_print_bool(f, all, "force-crc-match", xroar_cfg.force_crc_match, 0);
 	fputs("\n", f);
 
 	fputs("# User interface\n", f);
@@ -3141,40 +3284,49 @@ static void config_print_all(FILE *f, _Bool all) {
 	fputs("# Video\n", f);
 	xroar_cfg_print_string(f, all, "vo", xroar_ui_cfg.vo, NULL);
 	xroar_cfg_print_bool(f, all, "fs", xroar_ui_cfg.vo_cfg.fullscreen, 0);
-	xroar_cfg_print_int_nz(f, all, "fskip", private_cfg.vo.frameskip);
+	if (private_cfg.vo.frameskip_auto) {
+		xroar_cfg_print_string(f, all, "fskip", "auto", NULL);
+	} else {
+		xroar_cfg_print_int_nz(f, all, "fskip", private_cfg.vo.frameskip);
+	}
 	xroar_cfg_print_enum(f, all, "ccr", private_cfg.vo.ccr, VO_CMP_CCR_5BIT, vo_cmp_ccr_list);
 	xroar_cfg_print_enum(f, all, "gl-filter", xroar_ui_cfg.vo_cfg.gl_filter, ANY_AUTO, ui_gl_filter_list);
 	xroar_cfg_print_enum(f, all, "vo-pixel-fmt", xroar_ui_cfg.vo_cfg.pixel_fmt, ANY_AUTO, vo_pixel_fmt_list);
 	xroar_cfg_print_string(f, all, "geometry", xroar_ui_cfg.vo_cfg.geometry, NULL);
 	xroar_cfg_print_enum(f, all, "vo-picture", private_cfg.vo.picture, 0, vo_viewport_list);
 	xroar_cfg_print_bool(f, all, "vo-scale-60hz", private_cfg.vo.ntsc_scaling, 1);
+	xroar_cfg_print_bool(f, all, "vo-render-thread", private_cfg.vo.render_thread, 0);
 	xroar_cfg_print_bool(f, all, "invert-text", private_cfg.vo.vdg_inverted_text, 0);
 	xroar_cfg_print_int(f, all, "vo-brightness", private_cfg.vo.brightness, 50);
 	xroar_cfg_print_int(f, all, "vo-contrast", private_cfg.vo.contrast, 50);
 	xroar_cfg_print_int(f, all, "vo-colour", private_cfg.vo.saturation, 50);
 	xroar_cfg_print_int(f, all, "vo-hue", private_cfg.vo.hue, 0);
 	xroar_cfg_print_bool(f, all, "vo-colour-killer", xroar_ui_cfg.vo_cfg.colour_killer, 0);
+	xroar_cfg_print_int_nz(f, all, "vo-hash-interval", xroar_ui_cfg.vo_cfg.hash_interval);
+	xroar_cfg_print_string(f, all, "vo-hash-golden", xroar_ui_cfg.vo_cfg.hash_golden, NULL);
+	xroar_cfg_print_string(f, all, "vo-capture", private_cfg.vo.capture, NULL);
 	fputs("\n", f);
 
 	fputs("# Audio\n", f);
 	xroar_cfg_print_string(f, all, "ao", private_cfg.ao_module, NULL);
-	xroar_cfg_print_string(f, all, "ao-device", xroar.cfg.ao.device, NULL);
-	xroar_cfg_print_enum(f, all, "ao-format", xroar.cfg.ao.format, SOUND_FMT_NULL, ao_format_list);
-	xroar_cfg_print_int_nz(f, all, "ao-rate", xroar.cfg.ao.rate);
-	xroar_cfg_print_int_nz(f, all, "ao-channels", xroar.cfg.ao.channels);
-	xroar_cfg_print_int_nz(f, all, "ao-fragments", xroar.cfg.ao.fragments);
-	xroar_cfg_print_int_nz(f, all, "ao-fragment-ms", xroar.cfg.ao.fragment_ms);
-	xroar_cfg_print_int_nz(f, all, "ao-fragment-frames", xroar.cfg.ao.fragment_nframes);
-	xroar_cfg_print_int_nz(f, all, "ao-buffer-ms", xroar.cfg.ao.buffer_ms);
-	xroar_cfg_print_int_nz(f, all, "ao-buffer-frames", xroar.cfg.ao.buffer_nframes);
+	xroar_cfg_print_string(f, all, "ao-device", xroar_cfg.ao.device, NULL);
+	xroar_cfg_print_enum(f, all, "ao-format", xroar_cfg.ao.format, SOUND_FMT_NULL, ao_format_list);
+	xroar_cfg_print_int_nz(f, all, "ao-rate", xroar_cfg.ao.rate);
+	xroar_cfg_print_int_nz(f, all, "ao-channels", xroar_cfg.ao.channels);
+	xroar_cfg_print_int_nz(f, all, "ao-fragments", xroar_cfg.ao.fragments);
+	xroar_cfg_print_int_nz(f, all, "ao-fragment-ms", xroar_cfg.ao.fragment_ms);
+	xroar_cfg_print_int_nz(f, all, "ao-fragment-frames", xroar_cfg.ao.fragment_nframes);
+	xroar_cfg_print_int_nz(f, all, "ao-buffer-ms", xroar_cfg.ao.buffer_ms);
+	xroar_cfg_print_int_nz(f, all, "ao-buffer-frames", xroar_cfg.ao.buffer_nframes);
 	xroar_cfg_print_double(f, all, "ao-gain", private_cfg.ao.gain, -3.0);
 	xroar_cfg_print_int(f, all, "ao-volume", private_cfg.ao.volume, -1);
+	xroar_cfg_print_string(f, all, "ao-capture", private_cfg.ao.capture, NULL);
 	fputs("\n", f);
 
 	fputs("# Keyboard\n", f);
-	xroar_cfg_print_enum(f, all, "kbd-layout", xroar.cfg.kbd.layout, hk_layout_auto, hkbd_layout_list);
-	xroar_cfg_print_enum(f, all, "kbd-lang", xroar.cfg.kbd.lang, hk_lang_auto, hkbd_lang_list);
-	xroar_cfg_print_bool(f, all, "kbd-translate", xroar.cfg.kbd.translate, 0);
+	xroar_cfg_print_enum(f, all, "kbd-layout", xroar_cfg.kbd.layout, hk_layout_auto, hkbd_layout_list);
+	xroar_cfg_print_enum(f, all, "kbd-lang", xroar_cfg.kbd.lang, hk_lang_auto, hkbd_lang_list);
+	xroar_cfg_print_bool(f, all, "kbd-translate", xroar_cfg.kbd.translate, 0);
 	for (struct slist *l = private_cfg.kbd.type_list; l; l = l->next) {
 		sds s = sdsx_quote(l->data);
 		fprintf(f, "type %s\n", s);
@@ -3195,10 +3347,11 @@ static void config_print_all(FILE *f, _Bool all) {
 	fputs("\n", f);
 
 	fputs("# Debugging\n", f);
-	xroar_cfg_print_bool(f, all, "gdb", xroar.cfg.debug.gdb, 0);
-	xroar_cfg_print_string(f, all, "gdb-ip", xroar.cfg.debug.gdb_ip, GDB_IP_DEFAULT);
-	xroar_cfg_print_string(f, all, "gdb-port", xroar.cfg.debug.gdb_port, GDB_PORT_DEFAULT);
+	xroar_cfg_print_bool(f, all, "gdb", xroar_cfg.debug.gdb, 0);
+	xroar_cfg_print_string(f, all, "gdb-ip", xroar_cfg.debug.gdb_ip, GDB_IP_DEFAULT);
+	xroar_cfg_print_string(f, all, "gdb-port", xroar_cfg.debug.gdb_port, GDB_PORT_DEFAULT);
 	xroar_cfg_print_bool(f, all, "ratelimit", private_cfg.debug.ratelimit, 1);
+	xroar_cfg_print_bool(f, all, "idle-skip", xroar_cfg.debug.idle_skip, 1);
 	xroar_cfg_print_bool(f, all, "trace", logging.trace_cpu, 0);
 	xroar_cfg_print_bool(f, all, "trace-timing", logging.trace_cpu_timing, 0);
 	xroar_cfg_print_flags(f, all, "debug-fdc", logging.debug_fdc);
@@ -3206,8 +3359,8 @@ static void config_print_all(FILE *f, _Bool all) {
 	xroar_cfg_print_flags(f, all, "debug-gdb", logging.debug_gdb);
 	xroar_cfg_print_flags(f, all, "debug-ui", logging.debug_ui);
 	xroar_cfg_print_string(f, all, "timeout", private_cfg.debug.timeout, NULL);
-	xroar_cfg_print_string(f, all, "timeout-motoroff", xroar.cfg.debug.timeout_motoroff, NULL);
-	xroar_cfg_print_string(f, all, "snap-motoroff", xroar.cfg.debug.snap_motoroff, NULL);
+	xroar_cfg_print_string(f, all, "timeout-motoroff", xroar_cfg.debug.timeout_motoroff, NULL);
+	xroar_cfg_print_string(f, all, "snap-motoroff", xroar_cfg.debug.snap_motoroff, NULL);
 	fputs("\n", f);
 }
 #endif
@@ -24,12 +24,12 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "events.h"
 #include "ui.h"
 #include "xconfig.h"
 
 struct ao_interface;
 struct cart;
-struct event;
 struct machine_config;
 struct slist;
 struct vdg_palette;
@@ -141,6 +141,7 @@ struct xroar_cfg {
 		char *gdb_port;
 		char *timeout_motoroff;
 		char *snap_motoroff;
+		_Bool idle_skip;
 	} debug;
 };
 
@@ -148,11 +149,11 @@ struct xroar_cfg {
 
 // Global emulator state
 
-struct xroar {
-	struct xroar_cfg cfg;
+extern struct xroar_cfg xroar_cfg;
 
-	struct event *ui_events;
-	struct event *machine_events;
+struct xroar {
+	struct event_list ui_events;
+	struct event_list machine_events;
 
 	struct ui_interface *ui_interface;
 	struct vo_interface *vo_interface;
@@ -168,7 +169,11 @@ struct xroar {
 	struct vdrive_interface *vdrive_interface;
 };
 
-extern struct xroar xroar;
+// Each thread has its own copy of this state, so separate threads may each
+// run an emulator instance.  Configuration, including the machine, cartridge
+// and ROM lists, is shared.
+
+extern VAR_ATTR_THREAD_LOCAL struct xroar xroar;
 
 #define UI_EVENT_LIST xroar.ui_events
 #define MACHINE_EVENT_LIST xroar.machine_events
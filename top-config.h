@@ -56,6 +56,17 @@
 #define FUNC_ATTR_PURE
 #endif
 
+// Storage class for emulator state.  Each thread gets its own copy, so that
+// independent emulator instances may run in separate threads of one process.
+
+#if __STDC_VERSION__ >= 201112L
+#define VAR_ATTR_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define VAR_ATTR_THREAD_LOCAL __thread
+#else
+#define VAR_ATTR_THREAD_LOCAL
+#endif
+
 #ifdef HAVE_VAR_ATTRIBUTE_PACKED
 #define VAR_ATTR_PACKED __attribute__ ((packed))
 #else